@@ -1,987 +1,8775 @@
-#include <iostream>
-#include <string>
-#include <vector>
-#include <map>
-#include <unordered_map>
-#include <algorithm>
-#include <ctime>
-#include <sstream>
-#include <iomanip>
-#include <memory>
-#include <cstdlib>
-#include <fstream>
-#include <cmath>
-#include <queue>
-#include <stack>
-#include <set>
-#include <thread>
-#include <chrono>
-#include <atomic>
-#include <random>
-
-using namespace std;
-
-// ==================== OOP CLASSES ====================
-
-// ================= Base Transaction Class =================
-class Transaction {
-protected:
-    string date;
-    double amount;
-    string category;
-    string description;
-public:
-    Transaction(string d, double a, string c, string desc)
-        : date(d), amount(a), category(c), description(desc) {}
-    virtual ~Transaction() {}
-
-    virtual string getType() const = 0; // Pure virtual
-    double getAmount() const { return amount; }
-    string getCategory() const { return category; }
-    string getDate() const { return date; }
-    string getDescription() const { return description; }
-
-    string getDisplayText() const {
-        stringstream ss;
-        ss << setw(12) << date << " | "
-           << setw(10) << fixed << setprecision(2) << amount << " | "
-           << setw(12) << category << " | "
-           << setw(10) << getType() << " | "
-           << description;
-        return ss.str();
-    }
-};
-
-// ================= Derived Income Class =================
-class Income : public Transaction {
-public:
-    Income(string d, double a, string c, string desc)
-        : Transaction(d, a, c, desc) {}
-    string getType() const override { return "Income"; }
-};
-
-// ================= Derived Expense Class =================
-class Expense : public Transaction {
-public:
-    Expense(string d, double a, string c, string desc)
-        : Transaction(d, a, c, desc) {}
-    string getType() const override { return "Expense"; }
-};
-
-// ================= User Class =================
-class User {
-    string username;
-    string password;
-    vector<Transaction*> transactions;
-public:
-    User(string u, string p) : username(u), password(p) {}
-    ~User() {
-        for (auto t : transactions) delete t;
-    }
-
-    string getUsername() const { return username; }
-    bool checkPassword(const string& p) const { return p == password; }
-
-    void addTransaction(Transaction* t) {
-        transactions.push_back(t);
-    }
-
-    vector<string> getTransactionStrings() const {
-        vector<string> result;
-        for (auto t : transactions) {
-            result.push_back(t->getDisplayText());
-        }
-        return result;
-    }
-
-    string getSummaryByMonth(const string& month) const {
-        double totalIncome = 0, totalExpense = 0;
-        for (auto t : transactions) {
-            if (t->getDate().substr(0, 7) == month) {
-                if (t->getType() == "Income") totalIncome += t->getAmount();
-                else totalExpense += t->getAmount();
-            }
-        }
-        stringstream ss;
-        ss << "Summary for " << month << ":\n";
-        ss << "  Total Income:  " << fixed << setprecision(2) << totalIncome << "\n";
-        ss << "  Total Expense: " << fixed << setprecision(2) << totalExpense << "\n";
-        ss << "  Savings:       " << fixed << setprecision(2) << (totalIncome - totalExpense);
-        return ss.str();
-    }
-
-    string getCategoryAnalytics(const string& month) const {
-        map<string, double> catExpense;
-        for (auto t : transactions) {
-            if (t->getType() == "Expense" && t->getDate().substr(0, 7) == month) {
-                string cat = toLowerCase(t->getCategory());
-                catExpense[cat] += t->getAmount();
-            }
-        }
-        stringstream ss;
-        ss << "Expense by Category for " << month << ":\n";
-        for (auto& p : catExpense) {
-            ss << "  " << setw(12) << p.first << ": " << fixed << setprecision(2) << p.second << "\n";
-        }
-        return ss.str();
-    }
-
-    string getBusinessRecommendations(const string& month) const {
-        map<string, double> catExpense;
-        double totalIncome = 0, totalExpense = 0;
-
-        for (auto t : transactions) {
-            if (t->getDate().substr(0, 7) == month) {
-                if (t->getType() == "Expense") {
-                    string cat = toLowerCase(t->getCategory());
-                    catExpense[cat] += t->getAmount();
-                    totalExpense += t->getAmount();
-                } else {
-                    totalIncome += t->getAmount();
-                }
-            }
-        }
-
-        stringstream ss;
-        ss << "=== AI-Led Business Recommender for " << month << " ===\n";
-        if (totalIncome == 0 && totalExpense == 0) {
-            ss << "No transactions found for this month.\n";
-            return ss.str();
-        }
-
-        double savings = totalIncome - totalExpense;
-        ss << "Your savings: " << fixed << setprecision(2) << savings << "\n";
-
-        // Simple AI-like rules
-        if (savings < 0) {
-            ss << "⚠️ You are overspending! Consider reducing non-essential costs.\n";
-        } else if (savings < totalIncome * 0.2) {
-            ss << "💡 Your savings are low. Try to set at least 20% of income aside.\n";
-        } else {
-            ss << "✅ Great! Your savings are healthy this month.\n";
-        }
-
-        for (auto& p : catExpense) {
-            if (p.second > totalExpense * 0.5) {
-                ss << "⚠️ High spending in category: " << p.first
-                   << ". Consider optimizing this expense.\n";
-            }
-        }
-        return ss.str();
-    }
-
-private:
-    string toLowerCase(string s) const {
-        transform(s.begin(), s.end(), s.begin(),
-                  [](unsigned char c){ return tolower(c); });
-        return s;
-    }
-};
-
-// ================= FinanceTracker Class =================
-class FinanceTracker {
-    vector<User*> users;
-    User* currentUser = nullptr;
-public:
-    ~FinanceTracker() {
-        for (auto u : users) delete u;
-    }
-
-    bool registerUser(const string& u, const string& p) {
-        if (findUser(u)) return false;
-        users.push_back(new User(u, p));
-        return true;
-    }
-
-    bool loginUser(const string& u, const string& p) {
-        User* user = findUser(u);
-        if (user && user->checkPassword(p)) {
-            currentUser = user;
-            return true;
-        }
-        return false;
-    }
-
-    void logoutUser() { currentUser = nullptr; }
-
-    User* getCurrentUser() const { return currentUser; }
-
-    void addTransaction(const string& date, double amount, const string& category,
-                       const string& desc, const string& type) {
-        if (!currentUser) return;
-
-        if (toLowerCase(type) == "income")
-            currentUser->addTransaction(new Income(date, amount, category, desc));
-        else
-            currentUser->addTransaction(new Expense(date, amount, category, desc));
-    }
-
-    User* findUser(const string& u) {
-        for (auto user : users)
-            if (user->getUsername() == u) return user;
-        return nullptr;
-    }
-
-    vector<string> getAllUsernames() const {
-        vector<string> usernames;
-        for (auto user : users) {
-            usernames.push_back(user->getUsername());
-        }
-        return usernames;
-    }
-
-private:
-    string toLowerCase(string s) {
-        transform(s.begin(), s.end(), s.begin(),
-                  [](unsigned char c){ return tolower(c); });
-        return s;
-    }
-};
-
-// ==================== HTML GUI GENERATOR ====================
-
-class HTMLGUIGenerator {
-private:
-    FinanceTracker& tracker;
-
-public:
-    HTMLGUIGenerator(FinanceTracker& t) : tracker(t) {}
-
-    void generateHTML() {
-        ofstream file("finance_tracker.html");
-
-        file << "<!DOCTYPE html>\n";
-        file << "<html lang=\"en\">\n";
-        file << "<head>\n";
-        file << "    <meta charset=\"UTF-8\">\n";
-        file << "    <meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">\n";
-        file << "    <title>🚀 AI-Powered Finance Tracker - OOP Demonstration</title>\n";
-        file << "    <link href=\"https://fonts.googleapis.com/css2?family=Orbitron:wght@400;500;700;900&family=Exo+2:wght@300;400;500;600;700&display=swap\" rel=\"stylesheet\">\n";
-        file << "    <script src=\"https://cdn.jsdelivr.net/npm/chart.js\"></script>\n";
-        file << "    <style>\n";
-        file << "        * { margin: 0; padding: 0; box-sizing: border-box; }\n";
-        file << "        :root {\n";
-        file << "            --primary: #00f2fe; --secondary: #4facfe; --accent: #00ff88;\n";
-        file << "            --danger: #ff2d75; --dark: #0a0a1a; --darker: #050510;\n";
-        file << "            --card-bg: rgba(16, 18, 27, 0.8); --glass: rgba(255, 255, 255, 0.05);\n";
-        file << "            --neon-glow: 0 0 20px var(--primary);\n";
-        file << "        }\n";
-        file << "        body {\n";
-        file << "            font-family: 'Exo 2', sans-serif;\n";
-        file << "            background: linear-gradient(135deg, var(--darker) 0%, var(--dark) 50%, #0f1b2b 100%);\n";
-        file << "            color: #ffffff; min-height: 100vh; overflow-x: hidden; position: relative;\n";
-        file << "        }\n";
-        file << "        .container { max-width: 1400px; margin: 0 auto; padding: 20px; }\n";
-        file << "        .header {\n";
-        file << "            text-align: center; padding: 40px 20px; background: var(--card-bg);\n";
-        file << "            backdrop-filter: blur(20px); border: 1px solid var(--glass);\n";
-        file << "            border-radius: 24px; margin-bottom: 40px; position: relative;\n";
-        file << "            overflow: hidden; box-shadow: 0 8px 32px rgba(0, 0, 0, 0.3);\n";
-        file << "        }\n";
-        file << "        .header h1 {\n";
-        file << "            font-family: 'Orbitron', monospace; font-size: 3em; font-weight: 900;\n";
-        file << "            margin-bottom: 10px; background: linear-gradient(135deg, var(--primary), var(--secondary), var(--accent));\n";
-        file << "            -webkit-background-clip: text; -webkit-text-fill-color: transparent;\n";
-        file << "            text-shadow: var(--neon-glow); letter-spacing: 2px;\n";
-        file << "        }\n";
-        file << "        .tabs { display: flex; gap: 15px; margin-bottom: 40px; flex-wrap: wrap; justify-content: center; }\n";
-        file << "        .tab {\n";
-        file << "            padding: 15px 25px; background: var(--card-bg); backdrop-filter: blur(10px);\n";
-        file << "            border: 1px solid var(--glass); border-radius: 15px; cursor: pointer;\n";
-        file << "            font-family: 'Orbitron', monospace; font-size: 14px; font-weight: 500;\n";
-        file << "            color: #fff; transition: all 0.3s cubic-bezier(0.4, 0, 0.2, 1);\n";
-        file << "            position: relative; overflow: hidden;\n";
-        file << "        }\n";
-        file << "        .tab:hover { transform: translateY(-5px) scale(1.05); border-color: var(--primary); box-shadow: var(--neon-glow); }\n";
-        file << "        .tab.active { background: linear-gradient(135deg, var(--primary), var(--secondary)); border-color: transparent; box-shadow: var(--neon-glow); transform: translateY(-2px); }\n";
-        file << "        .tab-content { display: none; animation: fadeIn 0.5s ease-out; }\n";
-        file << "        .tab-content.active { display: block; }\n";
-        file << "        @keyframes fadeIn { from { opacity: 0; transform: translateY(20px); } to { opacity: 1; transform: translateY(0); } }\n";
-        file << "        .stats-grid { display: grid; grid-template-columns: repeat(auto-fit, minmax(250px, 1fr)); gap: 20px; margin-bottom: 40px; }\n";
-        file << "        .stat-card {\n";
-        file << "            background: var(--card-bg); backdrop-filter: blur(20px); padding: 25px;\n";
-        file << "            border-radius: 20px; border: 1px solid var(--glass); position: relative;\n";
-        file << "            overflow: hidden; transition: all 0.3s cubic-bezier(0.4, 0, 0.2, 1);\n";
-        file << "            cursor: pointer;\n";
-        file << "        }\n";
-        file << "        .stat-card:hover { transform: translateY(-8px) scale(1.02); border-color: var(--primary); box-shadow: 0 15px 30px rgba(0, 242, 254, 0.2); }\n";
-        file << "        .stat-card h3 { font-size: 12px; opacity: 0.7; margin-bottom: 12px; font-weight: 400; text-transform: uppercase; letter-spacing: 1px; }\n";
-        file << "        .stat-card .value { font-size: 32px; font-weight: 700; font-family: 'Orbitron', monospace; background: linear-gradient(135deg, var(--primary), var(--accent)); -webkit-background-clip: text; -webkit-text-fill-color: transparent; }\n";
-        file << "        .card { background: var(--card-bg); backdrop-filter: blur(20px); padding: 30px; border-radius: 20px; border: 1px solid var(--glass); margin-bottom: 25px; position: relative; overflow: hidden; transition: all 0.3s ease; }\n";
-        file << "        .card:hover { border-color: var(--primary); box-shadow: 0 12px 25px rgba(0, 242, 254, 0.1); }\n";
-        file << "        .card h2 { margin-bottom: 25px; font-size: 24px; font-family: 'Orbitron', monospace; color: var(--primary); display: flex; align-items: center; gap: 12px; }\n";
-        file << "        .grid-2 { display: grid; grid-template-columns: 1fr 1fr; gap: 25px; }\n";
-        file << "        .form-group { margin-bottom: 20px; position: relative; }\n";
-        file << "        .form-group label { display: block; margin-bottom: 10px; font-weight: 600; color: var(--primary); font-family: 'Orbitron', monospace; }\n";
-        file << "        .form-group input, .form-group select {\n";
-        file << "            width: 100%; padding: 15px; border-radius: 12px; border: 2px solid var(--glass);\n";
-        file << "            background: rgba(255, 255, 255, 0.05); color: #fff; font-size: 14px;\n";
-        file << "            font-family: 'Exo 2', sans-serif; transition: all 0.3s ease;\n";
-        file << "        }\n";
-        file << "        .form-group input:focus, .form-group select:focus {\n";
-        file << "            outline: none; border-color: var(--primary); box-shadow: 0 0 15px rgba(0, 242, 254, 0.3);\n";
-        file << "            background: rgba(255, 255, 255, 0.08);\n";
-        file << "        }\n";
-        file << "        .btn {\n";
-        file << "            padding: 15px 30px; background: linear-gradient(135deg, var(--primary), var(--secondary));\n";
-        file << "            border: none; border-radius: 12px; color: #fff; font-size: 14px;\n";
-        file << "            font-weight: 600; font-family: 'Orbitron', monospace; cursor: pointer;\n";
-        file << "            transition: all 0.3s cubic-bezier(0.4, 0, 0.2, 1); position: relative;\n";
-        file << "            overflow: hidden; text-transform: uppercase; letter-spacing: 1px;\n";
-        file << "        }\n";
-        file << "        .btn:hover { transform: translateY(-3px) scale(1.05); box-shadow: 0 8px 20px rgba(0, 242, 254, 0.4); }\n";
-        file << "        .notification {\n";
-        file << "            position: fixed; top: 20px; right: 20px; padding: 20px 25px; border-radius: 12px;\n";
-        file << "            font-weight: 600; display: none; z-index: 10000; animation: slideInRight 0.5s cubic-bezier(0.4, 0, 0.2, 1);\n";
-        file << "            backdrop-filter: blur(20px); border: 1px solid var(--glass); font-family: 'Orbitron', monospace;\n";
-        file << "        }\n";
-        file << "        .notification.success { background: linear-gradient(135deg, var(--accent), #00cc6a); box-shadow: 0 8px 25px rgba(0, 255, 136, 0.3); }\n";
-        file << "        .notification.error { background: linear-gradient(135deg, var(--danger), #ff1a6c); box-shadow: 0 8px 25px rgba(255, 45, 117, 0.3); }\n";
-        file << "        .output-console { \n";
-        file << "            width: 100%; height: 400px; background: rgba(0, 0, 0, 0.3); \n";
-        file << "            border-radius: 15px; border: 1px solid var(--glass); \n";
-        file << "            padding: 20px; overflow-y: auto; font-family: 'Courier New', monospace;\n";
-        file << "            font-size: 14px; color: #00ff88; margin-top: 20px;\n";
-        file << "        }\n";
-        file << "        .user-card { background: linear-gradient(135deg, var(--card-bg), rgba(16, 18, 27, 0.6)); padding: 20px; border-radius: 15px; border: 1px solid var(--glass); position: relative; overflow: hidden; transition: all 0.3s cubic-bezier(0.4, 0, 0.2, 1); cursor: pointer; margin: 12px 0; }\n";
-        file << "        .user-card:hover { transform: translateY(-5px) scale(1.02); border-color: var(--primary); box-shadow: 0 12px 25px rgba(0, 242, 254, 0.2); }\n";
-        file << "        table { width: 100%; border-collapse: collapse; margin-top: 20px; }\n";
-        file << "        th, td { padding: 12px; text-align: left; border-bottom: 1px solid rgba(255, 255, 255, 0.1); }\n";
-        file << "        th { background: rgba(0, 242, 254, 0.1); font-weight: 600; font-family: 'Orbitron', monospace; color: var(--primary); }\n";
-        file << "        tr:hover { background: rgba(0, 242, 254, 0.05); }\n";
-        file << "        @media (max-width: 1200px) { .grid-2 { grid-template-columns: 1fr; } .header h1 { font-size: 2.5em; } }\n";
-        file << "    </style>\n";
-        file << "</head>\n";
-        file << "<body>\n";
-        file << "    <div class=\"container\">\n";
-        file << "        <div class=\"header\">\n";
-        file << "            <h1>🚀 AI-Powered Finance Tracker</h1>\n";
-        file << "            <p>Object-Oriented Programming Demonstration | Inheritance • Encapsulation • Polymorphism • Abstraction</p>\n";
-        file << "        </div>\n";
-
-        file << "        <div class=\"tabs\">\n";
-        file << "            <button class=\"tab active\" onclick=\"showTab('dashboard')\">📊 DASHBOARD</button>\n";
-        file << "            <button class=\"tab\" onclick=\"showTab('auth')\">🔐 AUTHENTICATION</button>\n";
-        file << "            <button class=\"tab\" onclick=\"showTab('transactions')\">💳 TRANSACTIONS</button>\n";
-        file << "            <button class=\"tab\" onclick=\"showTab('analytics')\">📈 AI ANALYTICS</button>\n";
-        file << "            <button class=\"tab\" onclick=\"showTab('oop')\">⚙️ OOP FEATURES</button>\n";
-        file << "        </div>\n";
-
-        file << "        <div id=\"notification\" class=\"notification\"></div>\n";
-
-        // Dashboard Tab
-        file << "        <div id=\"dashboard\" class=\"tab-content active\">\n";
-        file << "            <div class=\"stats-grid\">\n";
-        file << "                <div class=\"stat-card\">\n";
-        file << "                    <h3>OOP Principles</h3>\n";
-        file << "                    <div class=\"value\">4/4</div>\n";
-        file << "                </div>\n";
-        file << "                <div class=\"stat-card\">\n";
-        file << "                    <h3>Class Hierarchy</h3>\n";
-        file << "                    <div class=\"value\">3 Levels</div>\n";
-        file << "                </div>\n";
-        file << "                <div class=\"stat-card\">\n";
-        file << "                    <h3>AI Features</h3>\n";
-        file << "                    <div class=\"value\">Smart Analysis</div>\n";
-        file << "                </div>\n";
-        file << "                <div class=\"stat-card\">\n";
-        file << "                    <h3>Security</h3>\n";
-        file << "                    <div class=\"value\">Encrypted</div>\n";
-        file << "                </div>\n";
-        file << "            </div>\n";
-        file << "            \n";
-        file << "            <div class=\"grid-2\">\n";
-        file << "                <div class=\"card\">\n";
-        file << "                    <h2>🎯 OOP ARCHITECTURE OVERVIEW</h2>\n";
-        file << "                    <div style=\"padding: 20px; background: rgba(0, 242, 254, 0.1); border-radius: 12px;\">\n";
-        file << "                        <h3 style=\"color: var(--accent); margin-bottom: 15px;\">Class Hierarchy:</h3>\n";
-        file << "                        <ul style=\"list-style: none; line-height: 2;\">\n";
-        file << "                            <li>🏗️ <strong>Transaction</strong> (Base Abstract Class)</li>\n";
-        file << "                            <li>  ├── 💰 <strong>Income</strong> (Derived Class)</li>\n";
-        file << "                            <li>  └── 💸 <strong>Expense</strong> (Derived Class)</li>\n";
-        file << "                            <li>👤 <strong>User</strong> (Composition & Encapsulation)</li>\n";
-        file << "                            <li>🏢 <strong>FinanceTracker</strong> (Main Controller)</li>\n";
-        file << "                        </ul>\n";
-        file << "                    </div>\n";
-        file << "                </div>\n";
-        file << "                <div class=\"card\">\n";
-        file << "                    <h2>🚀 REAL-TIME OUTPUT</h2>\n";
-        file << "                    <div id=\"outputConsole\" class=\"output-console\">\n";
-        file << "🌌 WELCOME TO AI-POWERED FINANCE TRACKER\n";
-        file << "========================================\n";
-        file << "🚀 OOP Features Demonstrated:\n";
-        file << "  • Inheritance: Transaction → Income/Expense\n";
-        file << "  • Encapsulation: Private user data\n";
-        file << "  • Polymorphism: Virtual getType() method\n";
-        file << "  • Abstraction: Simple public interfaces\n";
-        file << "\n";
-        file << "💡 Register or Login to get started!\n";
-        file << "                    </div>\n";
-        file << "                </div>\n";
-        file << "            </div>\n";
-        file << "        </div>\n";
-
-        // Authentication Tab
-        file << "        <div id=\"auth\" class=\"tab-content\">\n";
-        file << "            <div class=\"grid-2\">\n";
-        file << "                <div class=\"card\">\n";
-        file << "                    <h2>🔐 USER AUTHENTICATION</h2>\n";
-        file << "                    <div class=\"form-group\">\n";
-        file << "                        <label>👤 USERNAME</label>\n";
-        file << "                        <input type=\"text\" id=\"username\" placeholder=\"Enter your username\">\n";
-        file << "                    </div>\n";
-        file << "                    <div class=\"form-group\">\n";
-        file << "                        <label>🔑 PASSWORD</label>\n";
-        file << "                        <input type=\"password\" id=\"password\" placeholder=\"Enter your password\">\n";
-        file << "                    </div>\n";
-        file << "                    <div style=\"display: flex; gap: 15px; margin-top: 25px;\">\n";
-        file << "                        <button class=\"btn\" onclick=\"login()\">🚀 LOGIN</button>\n";
-        file << "                        <button class=\"btn\" onclick=\"register()\">📝 REGISTER</button>\n";
-        file << "                    </div>\n";
-        file << "                </div>\n";
-        file << "                <div class=\"card\">\n";
-        file << "                    <h2>👥 REGISTERED USERS</h2>\n";
-        file << "                    <div id=\"userList\" style=\"max-height: 300px; overflow-y: auto;\">\n";
-        file << "                        <div class=\"user-card\">\n";
-        file << "                            <h3>No users registered yet</h3>\n";
-        file << "                            <p>Register new users to see them here</p>\n";
-        file << "                        </div>\n";
-        file << "                    </div>\n";
-        file << "                    <div id=\"currentUser\" style=\"margin-top: 20px; padding: 15px; background: rgba(0, 255, 136, 0.1); border-radius: 10px; display: none;\">\n";
-        file << "                        <strong>👤 Current User: <span id=\"currentUserName\"></span></strong>\n";
-        file << "                    </div>\n";
-        file << "                </div>\n";
-        file << "            </div>\n";
-        file << "        </div>\n";
-
-        // Transactions Tab
-        file << "        <div id=\"transactions\" class=\"tab-content\">\n";
-        file << "            <div class=\"grid-2\">\n";
-        file << "                <div class=\"card\">\n";
-        file << "                    <h2>💳 ADD TRANSACTION</h2>\n";
-        file << "                    <div class=\"form-group\">\n";
-        file << "                        <label>📅 DATE (YYYY-MM-DD)</label>\n";
-        file << "                        <input type=\"text\" id=\"date\" value=\"2024-01-15\" placeholder=\"2024-01-15\">\n";
-        file << "                    </div>\n";
-        file << "                    <div class=\"form-group\">\n";
-        file << "                        <label>💰 AMOUNT</label>\n";
-        file << "                        <input type=\"number\" id=\"amount\" value=\"25.50\" placeholder=\"Enter amount\">\n";
-        file << "                    </div>\n";
-        file << "                    <div class=\"form-group\">\n";
-        file << "                        <label>🏷️ CATEGORY</label>\n";
-        file << "                        <input type=\"text\" id=\"category\" value=\"Food\" placeholder=\"Enter category\">\n";
-        file << "                    </div>\n";
-        file << "                    <div class=\"form-group\">\n";
-        file << "                        <label>📝 DESCRIPTION</label>\n";
-        file << "                        <input type=\"text\" id=\"description\" value=\"Lunch\" placeholder=\"Enter description\">\n";
-        file << "                    </div>\n";
-        file << "                    <div class=\"form-group\">\n";
-        file << "                        <label>🔀 TYPE</label>\n";
-        file << "                        <select id=\"type\">\n";
-        file << "                            <option value=\"Expense\">Expense</option>\n";
-        file << "                            <option value=\"Income\">Income</option>\n";
-        file << "                        </select>\n";
-        file << "                    </div>\n";
-        file << "                    <button class=\"btn\" onclick=\"addTransaction()\">💾 ADD TRANSACTION</button>\n";
-        file << "                </div>\n";
-        file << "                <div class=\"card\">\n";
-        file << "                    <h2>📋 TRANSACTION HISTORY</h2>\n";
-        file << "                    <button class=\"btn\" style=\"margin-bottom: 20px;\" onclick=\"listTransactions()\">🔄 REFRESH LIST</button>\n";
-        file << "                    <div id=\"transactionList\" style=\"max-height: 400px; overflow-y: auto;\">\n";
-        file << "                        <p style=\"text-align: center; opacity: 0.7;\">No transactions yet. Add some transactions to see them here.</p>\n";
-        file << "                    </div>\n";
-        file << "                </div>\n";
-        file << "            </div>\n";
-        file << "        </div>\n";
-
-        // Analytics Tab
-        file << "        <div id=\"analytics\" class=\"tab-content\">\n";
-        file << "            <div class=\"card\">\n";
-        file << "                <h2>📊 AI-POWERED FINANCIAL ANALYTICS</h2>\n";
-        file << "                <div class=\"form-group\">\n";
-        file << "                    <label>📅 MONTH FOR ANALYSIS (YYYY-MM)</label>\n";
-        file << "                    <input type=\"text\" id=\"monthInput\" value=\"2024-01\" placeholder=\"2024-01\">\n";
-        file << "                </div>\n";
-        file << "                <div style=\"display: grid; grid-template-columns: 1fr 1fr 1fr; gap: 15px; margin-top: 20px;\">\n";
-        file << "                    <button class=\"btn\" onclick=\"monthlySummary()\">📈 MONTHLY SUMMARY</button>\n";
-        file << "                    <button class=\"btn\" onclick=\"categoryAnalytics()\">📊 CATEGORY ANALYTICS</button>\n";
-        file << "                    <button class=\"btn\" onclick=\"aiRecommendations()\">🤖 AI RECOMMENDATIONS</button>\n";
-        file << "                </div>\n";
-        file << "            </div>\n";
-        file << "            \n";
-        file << "            <div class=\"card\">\n";
-        file << "                <h2>🎯 ANALYSIS RESULTS</h2>\n";
-        file << "                <div id=\"analysisResults\" class=\"output-console\" style=\"height: 300px;\">\n";
-        file << "Select an analysis option to see results here...\n";
-        file << "                </div>\n";
-        file << "            </div>\n";
-        file << "        </div>\n";
-
-        // OOP Features Tab
-        file << "        <div id=\"oop\" class=\"tab-content\">\n";
-        file << "            <div class=\"card\">\n";
-        file << "                <h2>⚙️ OOP PRINCIPLES DEMONSTRATION</h2>\n";
-        file << "                <div class=\"grid-2\">\n";
-        file << "                    <div>\n";
-        file << "                        <h3 style=\"color: var(--accent); margin-bottom: 15px;\">🏗️ INHERITANCE</h3>\n";
-        file << "                        <div style=\"background: rgba(0, 242, 254, 0.1); padding: 15px; border-radius: 10px; margin-bottom: 20px;\">\n";
-        file << "                            <p><strong>Base Class:</strong> Transaction (Abstract)</p>\n";
-        file << "                            <p><strong>Derived Classes:</strong> Income, Expense</p>\n";
-        file << "                            <p><strong>Polymorphism:</strong> Virtual getType() method</p>\n";
-        file << "                        </div>\n";
-        file << "                        \n";
-        file << "                        <h3 style=\"color: var(--accent); margin-bottom: 15px;\">🔒 ENCAPSULATION</h3>\n";
-        file << "                        <div style=\"background: rgba(0, 242, 254, 0.1); padding: 15px; border-radius: 10px; margin-bottom: 20px;\">\n";
-        file << "                            <p><strong>Private Data:</strong> username, password, transactions</p>\n";
-        file << "                            <p><strong>Public Interface:</strong> getters and business methods</p>\n";
-        file << "                            <p><strong>Data Protection:</strong> Controlled access through methods</p>\n";
-        file << "                        </div>\n";
-        file << "                    </div>\n";
-        file << "                    \n";
-        file << "                    <div>\n";
-        file << "                        <h3 style=\"color: var(--accent); margin-bottom: 15px;\">🔄 POLYMORPHISM</h3>\n";
-        file << "                        <div style=\"background: rgba(0, 242, 254, 0.1); padding: 15px; border-radius: 10px; margin-bottom: 20px;\">\n";
-        file << "                            <p><strong>Virtual Function:</strong> getType()</p>\n";
-        file << "                            <p><strong>Runtime Binding:</strong> Different behavior for Income/Expense</p>\n";
-        file << "                            <p><strong>Unified Interface:</strong> Same method, different implementations</p>\n";
-        file << "                        </div>\n";
-        file << "                        \n";
-        file << "                        <h3 style=\"color: var(--accent); margin-bottom: 15px;\">🎯 ABSTRACTION</h3>\n";
-        file << "                        <div style=\"background: rgba(0, 242, 254, 0.1); padding: 15px; border-radius: 10px; margin-bottom: 20px;\">\n";
-        file << "                            <p><strong>Simple Interface:</strong> Easy-to-use public methods</p>\n";
-        file << "                            <p><strong>Complex Implementation:</strong> Hidden internal logic</p>\n";
-        file << "                            <p><strong>Focus on What:</strong> Not how it's implemented</p>\n";
-        file << "                        </div>\n";
-        file << "                    </div>\n";
-        file << "                </div>\n";
-        file << "            </div>\n";
-        file << "            \n";
-        file << "            <div class=\"card\">\n";
-        file << "                <h2>💻 CODE SNIPPETS</h2>\n";
-        file << "                <div class=\"output-console\" style=\"height: 250px; font-size: 12px;\">\n";
-        file << "// INHERITANCE EXAMPLE\n";
-        file << "class Transaction { // Base class\n";
-        file << "protected:\n";
-        file << "    string date, category, description;\n";
-        file << "    double amount;\n";
-        file << "public:\n";
-        file << "    virtual string getType() const = 0; // Pure virtual\n";
-        file << "};\n";
-        file << "\n";
-        file << "class Income : public Transaction { // Derived class\n";
-        file << "public:\n";
-        file << "    string getType() const override { \n";
-        file << "        return \"Income\"; // Polymorphism\n";
-        file << "    }\n";
-        file << "};\n";
-        file << "\n";
-        file << "// ENCAPSULATION EXAMPLE\n";
-        file << "class User {\n";
-        file << "private:\n";
-        file << "    string username, password; // Private data\n";
-        file << "    vector<Transaction*> transactions;\n";
-        file << "public:\n";
-        file << "    string getUsername() const { return username; } // Public interface\n";
-        file << "};\n";
-        file << "                </div>\n";
-        file << "            </div>\n";
-        file << "        </div>\n";
-
-        file << "    </div>\n";
-
-        // JavaScript
-        file << "    <script>\n";
-        file << "        let currentUser = null;\n";
-        file << "        let users = [];\n";
-        file << "        let transactions = [];\n";
-        file << "        \n";
-        file << "        function showNotification(message, type) {\n";
-        file << "            const notification = document.getElementById('notification');\n";
-        file << "            notification.textContent = message;\n";
-        file << "            notification.className = `notification ${type}`;\n";
-        file << "            notification.style.display = 'block';\n";
-        file << "            \n";
-        file << "            setTimeout(() => {\n";
-        file << "                notification.style.display = 'none';\n";
-        file << "            }, 4000);\n";
-        file << "        }\n";
-        file << "        \n";
-        file << "        function appendToOutput(text) {\n";
-        file << "            const output = document.getElementById('outputConsole');\n";
-        file << "            output.innerHTML += '\\n' + text;\n";
-        file << "            output.scrollTop = output.scrollHeight;\n";
-        file << "        }\n";
-        file << "        \n";
-        file << "        function clearOutput() {\n";
-        file << "            document.getElementById('outputConsole').innerHTML = '';\n";
-        file << "        }\n";
-        file << "        \n";
-        file << "        function login() {\n";
-        file << "            const username = document.getElementById('username').value;\n";
-        file << "            const password = document.getElementById('password').value;\n";
-        file << "            \n";
-        file << "            if (!username || !password) {\n";
-        file << "                showNotification('Please enter both username and password!', 'error');\n";
-        file << "                return;\n";
-        file << "            }\n";
-        file << "            \n";
-        file << "            const user = users.find(u => u.username === username && u.password === password);\n";
-        file << "            if (user) {\n";
-        file << "                currentUser = user;\n";
-        file << "                showNotification('✅ Login successful! Welcome ' + username + '!', 'success');\n";
-        file << "                updateUserDisplay();\n";
-        file << "                clearOutput();\n";
-        file << "                appendToOutput('✅ Login successful! Welcome ' + username + '!');\n";
-        file << "                appendToOutput('Ready to manage your finances...');\n";
-        file << "            } else {\n";
-        file << "                showNotification('❌ Login failed! Invalid credentials.', 'error');\n";
-        file << "            }\n";
-        file << "        }\n";
-        file << "        \n";
-        file << "        function register() {\n";
-        file << "            const username = document.getElementById('username').value;\n";
-        file << "            const password = document.getElementById('password').value;\n";
-        file << "            \n";
-        file << "            if (!username || !password) {\n";
-        file << "                showNotification('Please enter both username and password!', 'error');\n";
-        file << "                return;\n";
-        file << "            }\n";
-        file << "            \n";
-        file << "            if (users.find(u => u.username === username)) {\n";
-        file << "                showNotification('❌ Registration failed! Username already exists.', 'error');\n";
-        file << "                return;\n";
-        file << "            }\n";
-        file << "            \n";
-        file << "            users.push({ username, password, transactions: [] });\n";
-        file << "            showNotification('✅ Registration successful! You can now login.', 'success');\n";
-        file << "            updateUserList();\n";
-        file << "            appendToOutput('✅ New user registered: ' + username);\n";
-        file << "        }\n";
-        file << "        \n";
-        file << "        function updateUserList() {\n";
-        file << "            const userList = document.getElementById('userList');\n";
-        file << "            userList.innerHTML = '';\n";
-        file << "            \n";
-        file << "            if (users.length === 0) {\n";
-        file << "                userList.innerHTML = `\n";
-        file << "                    <div class=\"user-card\">\n";
-        file << "                        <h3>No users registered yet</h3>\n";
-        file << "                        <p>Register new users to see them here</p>\n";
-        file << "                    </div>\n";
-        file << "                `;\n";
-        file << "                return;\n";
-        file << "            }\n";
-        file << "            \n";
-        file << "            users.forEach(user => {\n";
-        file << "                const userCard = document.createElement('div');\n";
-        file << "                userCard.className = 'user-card';\n";
-        file << "                userCard.innerHTML = `\n";
-        file << "                    <h3>👤 ${user.username}</h3>\n";
-        file << "                    <p>Transactions: ${user.transactions.length}</p>\n";
-        file << "                `;\n";
-        file << "                userList.appendChild(userCard);\n";
-        file << "            });\n";
-        file << "        }\n";
-        file << "        \n";
-        file << "        function updateUserDisplay() {\n";
-        file << "            const currentUserDiv = document.getElementById('currentUser');\n";
-        file << "            const currentUserName = document.getElementById('currentUserName');\n";
-        file << "            \n";
-        file << "            if (currentUser) {\n";
-        file << "                currentUserName.textContent = currentUser.username;\n";
-        file << "                currentUserDiv.style.display = 'block';\n";
-        file << "            } else {\n";
-        file << "                currentUserDiv.style.display = 'none';\n";
-        file << "            }\n";
-        file << "        }\n";
-        file << "        \n";
-        file << "        function addTransaction() {\n";
-        file << "            if (!currentUser) {\n";
-        file << "                showNotification('❌ Please login first!', 'error');\n";
-        file << "                return;\n";
-        file << "            }\n";
-        file << "            \n";
-        file << "            const date = document.getElementById('date').value;\n";
-        file << "            const amount = parseFloat(document.getElementById('amount').value);\n";
-        file << "            const category = document.getElementById('category').value;\n";
-        file << "            const description = document.getElementById('description').value;\n";
-        file << "            const type = document.getElementById('type').value;\n";
-        file << "            \n";
-        file << "            if (!date || !amount || !category) {\n";
-        file << "                showNotification('❌ Please fill all required fields!', 'error');\n";
-        file << "                return;\n";
-        file << "            }\n";
-        file << "            \n";
-        file << "            const transaction = {\n";
-        file << "                id: Date.now(),\n";
-        file << "                date,\n";
-        file << "                amount,\n";
-        file << "                category,\n";
-        file << "                description,\n";
-        file << "                type\n";
-        file << "            };\n";
-        file << "            \n";
-        file << "            currentUser.transactions.push(transaction);\n";
-        file << "            showNotification('✅ Transaction added successfully!', 'success');\n";
-        file << "            appendToOutput(`✅ Added ${type}: ${amount} for ${category}`);\n";
-        file << "        }\n";
-        file << "        \n";
-        file << "        function listTransactions() {\n";
-        file << "            if (!currentUser) {\n";
-        file << "                showNotification('❌ Please login first!', 'error');\n";
-        file << "                return;\n";
-        file << "            }\n";
-        file << "            \n";
-        file << "            const transactionList = document.getElementById('transactionList');\n";
-        file << "            \n";
-        file << "            if (currentUser.transactions.length === 0) {\n";
-        file << "                transactionList.innerHTML = '<p style=\"text-align: center; opacity: 0.7;\">No transactions yet. Add some transactions to see them here.</p>';\n";
-        file << "                return;\n";
-        file << "            }\n";
-        file << "            \n";
-        file << "            let html = `\n";
-        file << "                <table>\n";
-        file << "                    <thead>\n";
-        file << "                        <tr>\n";
-        file << "                            <th>Date</th>\n";
-        file << "                            <th>Amount</th>\n";
-        file << "                            <th>Category</th>\n";
-        file << "                            <th>Type</th>\n";
-        file << "                            <th>Description</th>\n";
-        file << "                        </tr>\n";
-        file << "                    </thead>\n";
-        file << "                    <tbody>\n";
-        file << "            `;\n";
-        file << "            \n";
-        file << "            currentUser.transactions.forEach(txn => {\n";
-        file << "                html += `\n";
-        file << "                    <tr>\n";
-        file << "                        <td>${txn.date}</td>\n";
-        file << "                        <td>${txn.amount.toFixed(2)}</td>\n";
-        file << "                        <td>${txn.category}</td>\n";
-        file << "                        <td>${txn.type}</td>\n";
-        file << "                        <td>${txn.description}</td>\n";
-        file << "                    </tr>\n";
-        file << "                `;\n";
-        file << "            });\n";
-        file << "            \n";
-        file << "            html += `\n";
-        file << "                    </tbody>\n";
-        file << "                </table>\n";
-        file << "            `;\n";
-        file << "            \n";
-        file << "            transactionList.innerHTML = html;\n";
-        file << "            appendToOutput('📋 Listed all transactions');\n";
-        file << "        }\n";
-        file << "        \n";
-        file << "        function monthlySummary() {\n";
-        file << "            if (!currentUser) {\n";
-        file << "                showNotification('❌ Please login first!', 'error');\n";
-        file << "                return;\n";
-        file << "            }\n";
-        file << "            \n";
-        file << "            const month = document.getElementById('monthInput').value;\n";
-        file << "            if (!month) {\n";
-        file << "                showNotification('❌ Please enter a month (YYYY-MM)!', 'error');\n";
-        file << "                return;\n";
-        file << "            }\n";
-        file << "            \n";
-        file << "            const results = calculateMonthlySummary(currentUser, month);\n";
-        file << "            document.getElementById('analysisResults').innerHTML = results;\n";
-        file << "            appendToOutput('📈 Generated monthly summary for ' + month);\n";
-        file << "        }\n";
-        file << "        \n";
-        file << "        function categoryAnalytics() {\n";
-        file << "            if (!currentUser) {\n";
-        file << "                showNotification('❌ Please login first!', 'error');\n";
-        file << "                return;\n";
-        file << "            }\n";
-        file << "            \n";
-        file << "            const month = document.getElementById('monthInput').value;\n";
-        file << "            if (!month) {\n";
-        file << "                showNotification('❌ Please enter a month (YYYY-MM)!', 'error');\n";
-        file << "                return;\n";
-        file << "            }\n";
-        file << "            \n";
-        file << "            const results = calculateCategoryAnalytics(currentUser, month);\n";
-        file << "            document.getElementById('analysisResults').innerHTML = results;\n";
-        file << "            appendToOutput('📊 Generated category analytics for ' + month);\n";
-        file << "        }\n";
-        file << "        \n";
-        file << "        function aiRecommendations() {\n";
-        file << "            if (!currentUser) {\n";
-        file << "                showNotification('❌ Please login first!', 'error');\n";
-        file << "                return;\n";
-        file << "            }\n";
-        file << "            \n";
-        file << "            const month = document.getElementById('monthInput').value;\n";
-        file << "            if (!month) {\n";
-        file << "                showNotification('❌ Please enter a month (YYYY-MM)!', 'error');\n";
-        file << "                return;\n";
-        file << "            }\n";
-        file << "            \n";
-        file << "            const results = generateAIRecommendations(currentUser, month);\n";
-        file << "            document.getElementById('analysisResults').innerHTML = results;\n";
-        file << "            appendToOutput('🤖 Generated AI recommendations for ' + month);\n";
-        file << "        }\n";
-        file << "        \n";
-        file << "        function calculateMonthlySummary(user, month) {\n";
-        file << "            let totalIncome = 0;\n";
-        file << "            let totalExpense = 0;\n";
-        file << "            \n";
-        file << "            user.transactions.forEach(txn => {\n";
-        file << "                if (txn.date.startsWith(month)) {\n";
-        file << "                    if (txn.type === 'Income') {\n";
-        file << "                        totalIncome += txn.amount;\n";
-        file << "                    } else {\n";
-        file << "                        totalExpense += txn.amount;\n";
-        file << "                    }\n";
-        file << "                }\n";
-        file << "            });\n";
-        file << "            \n";
-        file << "            const savings = totalIncome - totalExpense;\n";
-        file << "            \n";
-        file << "            return `\n";
-        file << "Summary for ${month}:\n";
-        file << "  Total Income:  ${totalIncome.toFixed(2)}\n";
-        file << "  Total Expense: ${totalExpense.toFixed(2)}\n";
-        file << "  Savings:       ${savings.toFixed(2)}\n";
-        file << "  Savings Rate:  ${totalIncome > 0 ? ((savings / totalIncome) * 100).toFixed(1) : '0.0'}%\n";
-        file << "            `;\n";
-        file << "        }\n";
-        file << "        \n";
-        file << "        function calculateCategoryAnalytics(user, month) {\n";
-        file << "            const categories = {};\n";
-        file << "            \n";
-        file << "            user.transactions.forEach(txn => {\n";
-        file << "                if (txn.type === 'Expense' && txn.date.startsWith(month)) {\n";
-        file << "                    const category = txn.category.toLowerCase();\n";
-        file << "                    categories[category] = (categories[category] || 0) + txn.amount;\n";
-        file << "                }\n";
-        file << "            });\n";
-        file << "            \n";
-        file << "            let result = `Expense by Category for ${month}:\\n`;\n";
-        file << "            for (const [category, amount] of Object.entries(categories)) {\n";
-        file << "                result += `  ${category.padEnd(12)}: ${amount.toFixed(2)}\\n`;\n";
-        file << "            }\n";
-        file << "            \n";
-        file << "            return result;\n";
-        file << "        }\n";
-        file << "        \n";
-        file << "        function generateAIRecommendations(user, month) {\n";
-        file << "            const categories = {};\n";
-        file << "            let totalIncome = 0;\n";
-        file << "            let totalExpense = 0;\n";
-        file << "            \n";
-        file << "            user.transactions.forEach(txn => {\n";
-        file << "                if (txn.date.startsWith(month)) {\n";
-        file << "                    if (txn.type === 'Expense') {\n";
-        file << "                        const category = txn.category.toLowerCase();\n";
-        file << "                        categories[category] = (categories[category] || 0) + txn.amount;\n";
-        file << "                        totalExpense += txn.amount;\n";
-        file << "                    } else {\n";
-        file << "                        totalIncome += txn.amount;\n";
-        file << "                    }\n";
-        file << "                }\n";
-        file << "            });\n";
-        file << "            \n";
-        file << "            const savings = totalIncome - totalExpense;\n";
-        file << "            \n";
-        file << "            let result = `=== AI-Led Business Recommender for ${month} ===\\n`;\n";
-        file << "            result += `Your savings: ${savings.toFixed(2)}\\n\\n`;\n";
-        file << "            \n";
-        file << "            // AI-like recommendations\n";
-        file << "            if (savings < 0) {\n";
-        file << "                result += \"⚠️ You are overspending! Consider reducing non-essential costs.\\n\";\n";
-        file << "            } else if (savings < totalIncome * 0.2) {\n";
-        file << "                result += \"💡 Your savings are low. Try to set at least 20% of income aside.\\n\";\n";
-        file << "            } else {\n";
-        file << "                result += \"✅ Great! Your savings are healthy this month.\\n\";\n";
-        file << "            }\n";
-        file << "            \n";
-        file << "            for (const [category, amount] of Object.entries(categories)) {\n";
-        file << "                if (amount > totalExpense * 0.5) {\n";
-        file << "                    result += `⚠️ High spending in category: ${category}. Consider optimizing this expense.\\n`;\n";
-        file << "                }\n";
-        file << "            }\n";
-        file << "            \n";
-        file << "            return result;\n";
-        file << "        }\n";
-        file << "        \n";
-        file << "        function showTab(tabName) {\n";
-        file << "            document.querySelectorAll('.tab-content').forEach(tab => {\n";
-        file << "                tab.classList.remove('active');\n";
-        file << "            });\n";
-        file << "            \n";
-        file << "            document.querySelectorAll('.tab').forEach(tab => {\n";
-        file << "                tab.classList.remove('active');\n";
-        file << "            });\n";
-        file << "            \n";
-        file << "            document.getElementById(tabName).classList.add('active');\n";
-        file << "            event.target.classList.add('active');\n";
-        file << "        }\n";
-        file << "        \n";
-        file << "        // Initialize\n";
-        file << "        document.addEventListener('DOMContentLoaded', function() {\n";
-        file << "            updateUserList();\n";
-        file << "            updateUserDisplay();\n";
-        file << "        });\n";
-        file << "    </script>\n";
-        file << "</body>\n";
-        file << "</html>\n";
-
-        file.close();
-        cout << "✅ AI-POWERED FINANCE TRACKER GENERATED SUCCESSFULLY!" << endl;
-    }
-};
-
-// ==================== MAIN FUNCTION ====================
-
-int main() {
-    cout << "=============================================================\n";
-    cout << "    🚀 AI-Powered Finance Tracker - OOP Assignment  🚀\n";
-    cout << "=============================================================\n\n";
-
-    FinanceTracker tracker;
-    HTMLGUIGenerator guiGen(tracker);
-    guiGen.generateHTML();
-
-    cout << "\n🎯 OOP FEATURES DEMONSTRATED:\n";
-    cout << "   ✓ Inheritance: Transaction → Income/Expense\n";
-    cout << "   ✓ Encapsulation: Private user data with public interfaces\n";
-    cout << "   ✓ Polymorphism: Virtual getType() method\n";
-    cout << "   ✓ Abstraction: Simple public methods hiding complex logic\n\n";
-
-    cout << "🚀 ADVANCED FEATURES:\n";
-    cout << "   ✓ AI-Powered financial recommendations\n";
-    cout << "   ✓ Real-time analytics and insights\n";
-    cout << "   ✓ Interactive HTML5 interface\n";
-    cout << "   ✓ Secure user authentication\n";
-    cout << "   ✓ Category-based spending analysis\n\n";
-
-    cout << "🌐 LAUNCHING WEB INTERFACE...\n";
-
-    // Open the HTML file in default browser
-#ifdef _WIN32
-    system("start finance_tracker.html");
-#elif __APPLE__
-    system("open finance_tracker.html");
-#else
-    system("xdg-open finance_tracker.html");
-#endif
-
-    cout << "\n✨ FINANCE TRACKER READY!\n";
-    cout << "📁 Interface: finance_tracker.html\n";
-    cout << "\n💡 Assignment Features:\n";
-    cout << "   • Complete OOP implementation\n";
-    cout << "   • Inheritance hierarchy\n";
-    cout << "   • Polymorphic behavior\n";
-    cout << "   • Encapsulated data\n";
-    cout << "   • Abstract base class\n";
-    cout << "   • AI-based business logic\n\n";
-
-    cout << "Press Enter to exit...\n";
-    cin.get();
-
-    return 0;
-}
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <ctime>
+#include <sstream>
+#include <iomanip>
+#include <memory>
+#include <cstdlib>
+#include <fstream>
+#include <cmath>
+#include <queue>
+#include <stack>
+#include <set>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <random>
+#include <deque>
+#include <charconv>
+#include <string_view>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <cstring>
+#include <cerrno>
+#include <filesystem>
+#include <functional>
+#include <utility>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#define PFT_HTTP_SERVER 1
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/random.h>
+#include <sys/socket.h>
+#endif
+#if defined(__SANITIZE_THREAD__)
+#define PFT_TSAN 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define PFT_TSAN 1
+#endif
+#endif
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PFT_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// ================= Date Packing =================
+// Dates are packed as days since 1970-01-01 (proleptic Gregorian calendar).
+static const int32_t kInvalidDay = INT32_MIN;
+
+static int32_t daysFromCivil(int y, int m, int d) {
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const int yoe = y - era * 400;
+    const int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static void civilFromDays(int32_t z, int& y, int& m, int& d) {
+    z += 719468;
+    const int era = (z >= 0 ? z : z - 146096) / 146097;
+    const int doe = z - era * 146097;
+    const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = yoe + era * 400 + (m <= 2);
+}
+
+static bool parseDigits(const char* p, size_t len, int& out) {
+    out = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (p[i] < '0' || p[i] > '9') return false;
+        out = out * 10 + (p[i] - '0');
+    }
+    return true;
+}
+
+static int daysInMonth(int y, int m) {
+    static const int lengths[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = y % 4 == 0 && (y % 100 != 0 || y % 400 == 0);
+    return m == 2 && leap ? 29 : lengths[m - 1];
+}
+
+// "YYYY-MM-DD" -> packed day. Anything that is not exactly a real calendar
+// date (year 0001-9999) yields kInvalidDay.
+static int32_t packDate(const char* s, size_t n) {
+    int y, m, d;
+    if (n != 10 || s[4] != '-' || s[7] != '-') return kInvalidDay;
+    if (!parseDigits(s, 4, y) || !parseDigits(s + 5, 2, m) || !parseDigits(s + 8, 2, d))
+        return kInvalidDay;
+    if (y < 1 || m < 1 || m > 12 || d < 1 || d > daysInMonth(y, m)) return kInvalidDay;
+    return daysFromCivil(y, m, d);
+}
+
+static int32_t packDate(const string& s) { return packDate(s.data(), s.size()); }
+
+static string formatDate(int32_t day) {
+    if (day == kInvalidDay) return "invalid";
+    int y, m, d;
+    civilFromDays(day, y, m, d);
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%04d-%02d-%02d", y, m, d);
+    return buf;
+}
+
+// yyyymm key of a packed day, e.g. 202401.
+static int32_t monthKeyOfDay(int32_t day) {
+    if (day == kInvalidDay) return -1;
+    int y, m, d;
+    civilFromDays(day, y, m, d);
+    return y * 100 + m;
+}
+
+// "YYYY-MM" -> yyyymm key, or -1. Parsed once per query so that month
+// filtering is a plain integer comparison.
+static int32_t monthKeyOf(const string& month) {
+    int y, m;
+    if (month.size() != 7 || month[4] != '-') return -1;
+    if (!parseDigits(month.data(), 4, y) || !parseDigits(month.data() + 5, 2, m)) return -1;
+    if (y < 1 || m < 1 || m > 12) return -1;
+    return y * 100 + m;
+}
+
+// The yyyymm key `months` months after key (before, if negative).
+static int32_t addMonths(int32_t key, int months) {
+    int index = (key / 100) * 12 + key % 100 - 1 + months;
+    return (index / 12) * 100 + index % 12 + 1;
+}
+
+// Today's packed date (UTC).
+static int32_t todayDay() {
+    return (int32_t)(time(nullptr) / 86400);
+}
+
+// ================= Money =================
+// Exact fixed-point amount: a 64-bit count of minor units (1/100 of the
+// major unit) tagged with an ISO 4217 currency code. Addition is integer
+// addition, so totals are exact and identical in any reduction order.
+// Arithmetic and comparisons assume both sides share a currency.
+class Money {
+    int64_t minor;
+    uint32_t currency;
+public:
+    static constexpr uint32_t kUSD = ('U' << 16) | ('S' << 8) | 'D';
+
+    // "EUR" -> packed code, or 0 unless it is three ASCII letters.
+    static uint32_t currencyCode(const string& iso) {
+        if (iso.size() != 3) return 0;
+        uint32_t code = 0;
+        for (char c : iso) {
+            if (!isalpha((unsigned char)c)) return 0;
+            code = (code << 8) | (uint32_t)toupper((unsigned char)c);
+        }
+        return code;
+    }
+
+    Money() : minor(0), currency(kUSD) {}
+    explicit Money(int64_t minorUnits, uint32_t currencyCode = kUSD)
+        : minor(minorUnits), currency(currencyCode) {}
+
+    // Rounds a floating-point major amount (e.g. 12.345) to minor units.
+    static Money fromMajor(double major, uint32_t currencyCode = kUSD) {
+        return Money(llround(major * 100), currencyCode);
+    }
+
+    int64_t minorUnits() const { return minor; }
+    uint32_t currencyCode() const { return currency; }
+    double toMajor() const { return minor / 100.0; }
+    bool sameCurrency(const Money& o) const { return currency == o.currency; }
+
+    string currencyName() const {
+        char iso[4] = {(char)(currency >> 16), (char)(currency >> 8), (char)currency, 0};
+        return iso;
+    }
+
+    // "-1234.56", formatted with integer arithmetic only.
+    string toString() const {
+        char buf[32];
+        return string(buf, format(buf));
+    }
+
+    size_t format(char* out) const {
+        uint64_t v = minor < 0 ? 0 - (uint64_t)minor : (uint64_t)minor;
+        char* p = out;
+        if (minor < 0) *p++ = '-';
+        p = to_chars(p, p + 24, v / 100).ptr;
+        *p++ = '.';
+        *p++ = (char)('0' + v % 100 / 10);
+        *p++ = (char)('0' + v % 10);
+        return p - out;
+    }
+
+    Money operator+(const Money& o) const { return Money(minor + o.minor, currency); }
+    Money operator-(const Money& o) const { return Money(minor - o.minor, currency); }
+    Money operator-() const { return Money(-minor, currency); }
+    Money operator*(int64_t k) const { return Money(minor * k, currency); }
+    Money& operator+=(const Money& o) { minor += o.minor; return *this; }
+    Money& operator-=(const Money& o) { minor -= o.minor; return *this; }
+    bool operator==(const Money& o) const { return minor == o.minor && currency == o.currency; }
+    bool operator!=(const Money& o) const { return !(*this == o); }
+    bool operator<(const Money& o) const { return minor < o.minor; }
+    bool operator>(const Money& o) const { return minor > o.minor; }
+};
+
+// ==================== OOP CLASSES ====================
+
+// ================= Base Transaction Class =================
+class Transaction {
+protected:
+    int32_t day;          // packed date, validated on construction
+    Money amount;
+    string category;
+    string description;
+public:
+    Transaction(string d, double a, string c, string desc)
+        : day(packDate(d)), amount(Money::fromMajor(a)), category(c), description(desc) {}
+    Transaction(int32_t packedDay, Money a, string c, string desc)
+        : day(packedDay), amount(a), category(c), description(desc) {}
+    virtual ~Transaction() {}
+
+    virtual string getType() const = 0; // Pure virtual
+    Money getAmount() const { return amount; }
+    string getCategory() const { return category; }
+    string getDate() const { return formatDate(day); }
+    int32_t getDay() const { return day; }
+    bool hasValidDate() const { return day != kInvalidDay; }
+    string getDescription() const { return description; }
+
+    string getDisplayText() const {
+        stringstream ss;
+        ss << setw(12) << getDate() << " | "
+           << setw(10) << amount.toString() << " | "
+           << setw(12) << category << " | "
+           << setw(10) << getType() << " | "
+           << description;
+        return ss.str();
+    }
+};
+
+// ================= Derived Income Class =================
+class Income : public Transaction {
+public:
+    Income(string d, double a, string c, string desc)
+        : Transaction(d, a, c, desc) {}
+    Income(int32_t day, Money a, string c, string desc)
+        : Transaction(day, a, c, desc) {}
+    string getType() const override { return "Income"; }
+};
+
+// ================= Derived Expense Class =================
+class Expense : public Transaction {
+public:
+    Expense(string d, double a, string c, string desc)
+        : Transaction(d, a, c, desc) {}
+    Expense(int32_t day, Money a, string c, string desc)
+        : Transaction(day, a, c, desc) {}
+    string getType() const override { return "Expense"; }
+};
+
+// ================= Case Folding =================
+static void appendUtf8(string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += (char)cp;
+    } else if (cp < 0x800) {
+        out += (char)(0xC0 | (cp >> 6));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += (char)(0xE0 | (cp >> 12));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else {
+        out += (char)(0xF0 | (cp >> 18));
+        out += (char)(0x80 | ((cp >> 12) & 0x3F));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    }
+}
+
+// Simple case folding for the Latin, Greek and Cyrillic blocks.
+static uint32_t foldCodePoint(uint32_t cp) {
+    if (cp >= 'A' && cp <= 'Z') return cp + 32;
+    if (cp < 0xC0) return cp;
+    if (cp <= 0xDE && cp != 0xD7) return cp + 32;                          // Latin-1
+    if (cp >= 0x100 && cp <= 0x137 && cp != 0x130) return cp | 1;           // Latin Extended-A
+    if (cp >= 0x139 && cp <= 0x148) return (cp & 1) ? cp + 1 : cp;
+    if (cp >= 0x14A && cp <= 0x177) return cp | 1;
+    if (cp == 0x178) return 0xFF;
+    if (cp >= 0x179 && cp <= 0x17E) return (cp & 1) ? cp + 1 : cp;
+    if (cp >= 0x391 && cp <= 0x3AB && cp != 0x3A2) return cp + 32;          // Greek
+    if (cp == 0x386) return 0x3AC;
+    if (cp >= 0x388 && cp <= 0x38A) return cp + 37;
+    if (cp == 0x38C) return 0x3CC;
+    if (cp == 0x38E || cp == 0x38F) return cp + 63;
+    if (cp == 0x3C2) return 0x3C3;                                          // final sigma
+    if (cp >= 0x410 && cp <= 0x42F) return cp + 32;                         // Cyrillic
+    if (cp >= 0x400 && cp <= 0x40F) return cp + 80;
+    if (cp >= 0x460 && cp <= 0x481) return cp | 1;
+    return cp;
+}
+
+// Case-folds UTF-8 text. Malformed sequences are copied through byte by
+// byte, so folding never corrupts or drops input.
+static string foldCase(const string& s) {
+    string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size();) {
+        unsigned char c = s[i];
+        if (c < 0x80) {
+            out += (char)((c >= 'A' && c <= 'Z') ? c + 32 : c);
+            i++;
+            continue;
+        }
+        size_t len = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 0;
+        uint32_t cp = len == 4 ? (c & 0x07) : len == 3 ? (c & 0x0F) : (c & 0x1F);
+        bool valid = len != 0 && i + len <= s.size();
+        for (size_t k = 1; valid && k < len; k++) {
+            unsigned char cc = s[i + k];
+            if ((cc & 0xC0) != 0x80) valid = false;
+            cp = (cp << 6) | (cc & 0x3F);
+        }
+        if (!valid) {
+            out += (char)c;
+            i++;
+            continue;
+        }
+        if (cp == 0xDF) out += "ss";                                        // sharp s
+        else appendUtf8(out, foldCodePoint(cp));
+        i += len;
+    }
+    return out;
+}
+
+// ================= Category Dictionary =================
+// Process-wide interning of case-folded category names to dense IDs.
+// Names are stored in fixed-size chunks that never move, so lookups by ID
+// need no lock; only interning a new name takes the index exclusively.
+class CategoryDictionary {
+    static constexpr uint32_t kChunkBits = 12;
+    static constexpr uint32_t kChunkSize = 1u << kChunkBits;
+    static constexpr uint32_t kMaxChunks = 1024;
+public:
+    static constexpr uint32_t kCapacity = kMaxChunks * kChunkSize;
+    static constexpr uint32_t kNoId = UINT32_MAX;   // intern: the table is full
+private:
+
+    struct Entry {
+        string key;      // case-folded, used for grouping
+        string display;  // first spelling seen
+    };
+
+    atomic<Entry*> chunks[kMaxChunks];
+    atomic<uint32_t> count{0};
+    mutable shared_mutex indexLock;
+    unordered_map<string, uint32_t> index;
+
+    CategoryDictionary() {
+        for (auto& c : chunks) c.store(nullptr, memory_order_relaxed);
+    }
+public:
+    ~CategoryDictionary() {
+        for (auto& c : chunks) delete[] c.load(memory_order_relaxed);
+    }
+
+    static CategoryDictionary& instance() {
+        static CategoryDictionary dictionary;
+        return dictionary;
+    }
+
+    // kNoId, interning nothing, once kCapacity names are held.
+    uint32_t intern(const string& category) {
+        string key = foldCase(category);
+        {
+            shared_lock<shared_mutex> lock(indexLock);
+            auto it = index.find(key);
+            if (it != index.end()) return it->second;
+        }
+        unique_lock<shared_mutex> lock(indexLock);
+        auto it = index.find(key);
+        if (it != index.end()) return it->second;
+
+        uint32_t id = count.load(memory_order_relaxed);
+        if (id == kCapacity) return kNoId;
+        Entry* chunk = chunks[id >> kChunkBits].load(memory_order_relaxed);
+        if (!chunk) {
+            chunk = new Entry[kChunkSize];
+            chunks[id >> kChunkBits].store(chunk, memory_order_release);
+        }
+        chunk[id & (kChunkSize - 1)].key = key;
+        chunk[id & (kChunkSize - 1)].display = category;
+        index.emplace(move(key), id);
+        count.store(id + 1, memory_order_release);
+        return id;
+    }
+
+    // Case-folded name; this is what analytics group and print by.
+    const string& name(uint32_t id) const { return entry(id).key; }
+    const string& displayName(uint32_t id) const { return entry(id).display; }
+    uint32_t size() const { return count.load(memory_order_acquire); }
+
+    // IDs with a non-zero amount, ordered by name.
+    vector<uint32_t> sortedByName(const vector<int64_t>& amounts) const {
+        vector<uint32_t> ids;
+        for (uint32_t id = 0; id < amounts.size(); id++)
+            if (amounts[id] != 0) ids.push_back(id);
+        sort(ids.begin(), ids.end(),
+             [this](uint32_t a, uint32_t b) { return name(a) < name(b); });
+        return ids;
+    }
+
+private:
+    const Entry& entry(uint32_t id) const {
+        return chunks[id >> kChunkBits].load(memory_order_acquire)[id & (kChunkSize - 1)];
+    }
+};
+
+// ================= Chunked Columns =================
+// Append-only storage in chunks of doubling size (16, 16, 32, 64, ...
+// elements). Appending never moves existing elements: a growing ledger
+// has no vector-style reallocation copying every row while the user's
+// write lock is held, and dropping it frees O(log rows) blocks. The chunk
+// directory is a fixed array for the same reason, so a reader told of n
+// elements through a release/acquire pair (see Ledger) may read [0, n)
+// with the bounded accessors while one writer keeps appending.
+static inline unsigned floorLog2(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, v);
+    return (unsigned)index;
+#else
+    return 63 - (unsigned)__builtin_clzll(v);
+#endif
+}
+
+template <class T>
+class ChunkedColumn {
+    static constexpr unsigned kFirstShift = 4;
+    static constexpr size_t kMaxChunks = 44;    // 16 << 44 elements
+    unique_ptr<T[]> chunks[kMaxChunks];
+    size_t allocated = 0;
+    size_t count = 0;
+
+    static unsigned chunkOf(size_t i) { return floorLog2((i >> kFirstShift) + 1); }
+    static size_t chunkBegin(size_t k) { return ((size_t(1) << k) - 1) << kFirstShift; }
+    static size_t chunkCapacity(size_t k) { return size_t(1) << (k + kFirstShift); }
+public:
+    ChunkedColumn() {}
+    ChunkedColumn(ChunkedColumn&& o) noexcept { *this = move(o); }
+    ChunkedColumn& operator=(ChunkedColumn&& o) noexcept {
+        if (this == &o) return *this;
+        for (size_t k = 0; k < kMaxChunks; k++) chunks[k] = move(o.chunks[k]);
+        allocated = exchange(o.allocated, 0);
+        count = exchange(o.count, 0);
+        return *this;
+    }
+    ChunkedColumn(const ChunkedColumn& o) { *this = o; }
+    ChunkedColumn& operator=(const ChunkedColumn& o) {
+        if (this == &o) return *this;
+        resize(o.count);
+        for (size_t k = 0; k < allocated; k++)
+            copy(o.chunkData(k), o.chunkData(k) + chunkSize(k), chunks[k].get());
+        return *this;
+    }
+
+    size_t size() const { return count; }
+
+    void push_back(const T& v) {
+        if (count == chunkBegin(allocated)) grow();
+        size_t k = chunkOf(count);
+        chunks[k][count - chunkBegin(k)] = v;
+        count++;
+    }
+
+    // Grows (contents of new elements unspecified) or shrinks to n elements.
+    void resize(size_t n) {
+        while (chunkBegin(allocated) < n) grow();
+        while (allocated && chunkBegin(allocated - 1) >= n) chunks[--allocated].reset();
+        count = n;
+    }
+
+    T& operator[](size_t i) {
+        size_t k = chunkOf(i);
+        return chunks[k][i - chunkBegin(k)];
+    }
+    const T& operator[](size_t i) const {
+        size_t k = chunkOf(i);
+        return chunks[k][i - chunkBegin(k)];
+    }
+    T& back() { return (*this)[count - 1]; }
+
+    // Chunk-at-a-time access for bulk reads and writes.
+    size_t chunkCount() const { return allocated; }
+    size_t chunkSize(size_t k) const { return min(chunkCapacity(k), count - chunkBegin(k)); }
+    const T* chunkData(size_t k) const { return chunks[k].get(); }
+    T* chunkData(size_t k) { return chunks[k].get(); }
+
+    // The same over the first n elements only, for readers racing push_back.
+    static size_t chunkCount(size_t n) { return n ? chunkOf(n - 1) + 1 : 0; }
+    static size_t chunkSize(size_t k, size_t n) { return min(chunkCapacity(k), n - chunkBegin(k)); }
+
+private:
+    void grow() {
+        chunks[allocated].reset(new T[chunkCapacity(allocated)]);
+        allocated++;
+    }
+};
+
+// Description bytes for a ledger, addressed by logical offsets into their
+// concatenation. Each description lies wholly inside one chunk, so a view
+// is a single pointer; chunk capacity doubles like ChunkedColumn, and the
+// chunk directory is fixed the same way: a chunk is published (count,
+// release) only once built, so view() may race append().
+class DescriptionArena {
+    struct Chunk {
+        unique_ptr<char[]> data;
+        size_t used;
+        size_t capacity;
+        uint64_t base;          // logical offset of data[0]
+    };
+    static constexpr size_t kMaxChunks = 48;
+    Chunk chunks[kMaxChunks];
+    atomic<size_t> count{0};
+    uint64_t total = 0;
+public:
+    DescriptionArena() {}
+    DescriptionArena(DescriptionArena&& o) noexcept { *this = move(o); }
+    DescriptionArena& operator=(DescriptionArena&& o) noexcept {
+        if (this == &o) return *this;
+        for (size_t k = 0; k < kMaxChunks; k++) chunks[k] = move(o.chunks[k]);
+        count.store(o.count.exchange(0));
+        total = exchange(o.total, 0);
+        return *this;
+    }
+    DescriptionArena(const DescriptionArena& o) { *this = o; }
+    DescriptionArena& operator=(const DescriptionArena& o) {
+        if (this == &o) return *this;
+        for (Chunk& c : chunks) c = Chunk();
+        count.store(0);
+        total = 0;
+        if (o.total) {
+            char* p = reserve(o.total);     // one chunk holding the concatenation
+            o.forEachChunk([&](const char* data, size_t n) {
+                memcpy(p, data, n);
+                p += n;
+            });
+        }
+        return *this;
+    }
+
+    uint64_t size() const { return total; }
+
+    // Appends n bytes, returning where to write them (contiguous).
+    char* reserve(size_t n) {
+        size_t k = count.load(memory_order_relaxed);
+        if (k == 0 || chunks[k - 1].capacity - chunks[k - 1].used < n) {
+            size_t capacity = max<size_t>(n, k == 0 ? 1024 : chunks[k - 1].capacity * 2);
+            chunks[k] = Chunk{unique_ptr<char[]>(new char[capacity]), 0, capacity, total};
+            count.store(++k, memory_order_release);
+        }
+        Chunk& c = chunks[k - 1];
+        char* p = c.data.get() + c.used;
+        c.used += n;
+        total += n;
+        return p;
+    }
+
+    void append(const char* p, size_t n) {
+        if (n) memcpy(reserve(n), p, n);
+    }
+
+    string_view view(uint64_t begin, uint64_t end) const {
+        if (begin == end) return string_view();
+        size_t k = count.load(memory_order_acquire) - 1;
+        while (chunks[k].base > begin) k--;     // few chunks; the last is most likely
+        return string_view(chunks[k].data.get() + (begin - chunks[k].base), end - begin);
+    }
+
+    // Not safe against a concurrent append.
+    template <class F> void forEachChunk(F f) const {
+        for (size_t k = 0, n = count.load(); k < n; k++) f(chunks[k].data.get(), chunks[k].used);
+    }
+
+    // Bytes [0, end) a chunk at a time. Safe against a concurrent append
+    // when end was published to the caller (see Ledger).
+    template <class F> void forEachChunk(uint64_t end, F f) const {
+        size_t n = count.load(memory_order_acquire);
+        for (size_t k = 0; k < n && chunks[k].base < end; k++) {
+            uint64_t stop = k + 1 < n ? min(chunks[k + 1].base, end) : end;
+            f(chunks[k].data.get(), (size_t)(stop - chunks[k].base));
+        }
+    }
+};
+
+// ================= Columnar Ledger =================
+// Structure-of-arrays storage for one user's transactions. Rows are never
+// heap-allocated individually.
+//
+// An append-only log for one writer at a time: a row's columns are
+// written first, then the row count is published (release). Readers that
+// load size() (acquire) may read rows below it through the row accessors
+// and forEachRow without any lock while appends continue. Income bits
+// share a word with later rows, so they are stored and loaded atomically.
+class Ledger {
+    ChunkedColumn<int32_t> days;           // packed dates
+    ChunkedColumn<int32_t> monthKeys;      // yyyymm of each row, precomputed
+    ChunkedColumn<int64_t> cents;          // fixed-point amounts (1/100 units)
+    ChunkedColumn<uint32_t> categoryIds;   // interned category IDs
+    ChunkedColumn<uint64_t> incomeBits;    // bit i set => row i is Income
+    ChunkedColumn<uint64_t> descEnds;      // logical end offset of row i's description
+    DescriptionArena descArena;
+    atomic<size_t> rows{0};                // published row count
+
+    friend class Storage;
+public:
+    Ledger() {}
+    Ledger(const Ledger& o) { *this = o; }
+    Ledger(Ledger&& o) noexcept { *this = move(o); }
+
+    // Copying requires that o has no concurrent writer.
+    Ledger& operator=(const Ledger& o) {
+        days = o.days;
+        monthKeys = o.monthKeys;
+        cents = o.cents;
+        categoryIds = o.categoryIds;
+        incomeBits = o.incomeBits;
+        descEnds = o.descEnds;
+        descArena = o.descArena;
+        rows.store(o.size(), memory_order_release);
+        return *this;
+    }
+
+    Ledger& operator=(Ledger&& o) noexcept {
+        days = move(o.days);
+        monthKeys = move(o.monthKeys);
+        cents = move(o.cents);
+        categoryIds = move(o.categoryIds);
+        incomeBits = move(o.incomeBits);
+        descEnds = move(o.descEnds);
+        descArena = move(o.descArena);
+        rows.store(o.rows.exchange(0), memory_order_release);
+        return *this;
+    }
+
+    size_t size() const { return rows.load(memory_order_acquire); }
+
+    void append(int32_t day, int64_t amountCents, uint32_t category,
+                const string& desc, bool income) {
+        append(day, amountCents, category, desc.data(), desc.size(), income);
+    }
+
+    void append(int32_t day, int64_t amountCents, uint32_t category,
+                const char* desc, size_t descLen, bool income) {
+        size_t row = days.size();
+        if ((row & 63) == 0) incomeBits.push_back(0);
+        if (income) {
+            uint64_t& word = incomeBits[row >> 6];
+            __atomic_store_n(&word, word | uint64_t(1) << (row & 63), __ATOMIC_RELAXED);
+        }
+        days.push_back(day);
+        monthKeys.push_back(monthKeyOfDay(day));
+        cents.push_back(amountCents);
+        categoryIds.push_back(category);
+        descArena.append(desc, descLen);
+        descEnds.push_back(descArena.size());
+        rows.store(row + 1, memory_order_release);
+    }
+
+    int32_t dayAt(size_t i) const { return days[i]; }
+    int32_t monthKeyAt(size_t i) const { return monthKeys[i]; }
+    int64_t centsAt(size_t i) const { return cents[i]; }
+    uint32_t categoryAt(size_t i) const { return categoryIds[i]; }
+    bool isIncome(size_t i) const { return (incomeWord(i >> 6) >> (i & 63)) & 1; }
+
+    string descriptionAt(size_t i) const { return string(descriptionView(i)); }
+
+    string_view descriptionView(size_t i) const {
+        return descArena.view(i == 0 ? 0 : descEnds[i - 1], descEnds[i]);
+    }
+
+    // Description bytes of rows [0, count).
+    uint64_t descriptionEnd(size_t count) const { return count ? descEnds[count - 1] : 0; }
+
+    // Income bits of rows [64w, 64w + 64); bits past size() may change.
+    uint64_t incomeWord(size_t w) const { return __atomic_load_n(&incomeBits[w], __ATOMIC_RELAXED); }
+
+    // Visits every published row in order as f(row, day, monthKey, cents,
+    // category, income), walking the columns a chunk at a time instead of
+    // locating each row's chunk.
+    template <class F> void forEachRow(F f) const { forEachRow(size(), f); }
+
+    // The same over rows [0, count); count must not exceed size().
+    template <class F> void forEachRow(size_t count, F f) const {
+        size_t row = 0;
+        uint64_t bits = 0;
+        for (size_t k = 0, chunks = ChunkedColumn<int32_t>::chunkCount(count); k < chunks; k++) {
+            const int32_t* d = days.chunkData(k);
+            const int32_t* m = monthKeys.chunkData(k);
+            const int64_t* c = cents.chunkData(k);
+            const uint32_t* id = categoryIds.chunkData(k);
+            for (size_t i = 0, n = ChunkedColumn<int32_t>::chunkSize(k, count); i < n; i++, row++) {
+                if ((row & 63) == 0) bits = incomeWord(row >> 6);
+                f(row, d[i], m[i], c[i], id[i], ((bits >> (row & 63)) & 1) != 0);
+            }
+        }
+    }
+
+    const ChunkedColumn<int32_t>& dayColumn() const { return days; }
+    const ChunkedColumn<int64_t>& centsColumn() const { return cents; }
+    const ChunkedColumn<uint32_t>& categoryColumn() const { return categoryIds; }
+    const ChunkedColumn<uint64_t>& incomeColumn() const { return incomeBits; }
+    const ChunkedColumn<uint64_t>& descEndColumn() const { return descEnds; }
+    const DescriptionArena& descriptionArena() const { return descArena; }
+
+private:
+    // Storage fills the other columns chunk by chunk, then calls this.
+    void finishLoad() {
+        monthKeys.resize(days.size());
+        for (size_t k = 0; k < days.chunkCount(); k++) {
+            const int32_t* d = days.chunkData(k);
+            int32_t* m = monthKeys.chunkData(k);
+            for (size_t i = 0; i < days.chunkSize(k); i++) m[i] = monthKeyOfDay(d[i]);
+        }
+        rows.store(days.size(), memory_order_release);
+    }
+};
+
+// Parsed rows awaiting a bulk append to one user's ledger.
+struct ImportBatch {
+    vector<int32_t> days;
+    vector<int64_t> cents;
+    vector<uint32_t> categories;
+    vector<uint8_t> income;
+    vector<uint64_t> descEnds;
+    string descArena;
+
+    size_t size() const { return days.size(); }
+
+    void add(int32_t day, int64_t amountCents, uint32_t category, bool isIncome,
+             const char* desc, size_t descLen) {
+        days.push_back(day);
+        cents.push_back(amountCents);
+        categories.push_back(category);
+        income.push_back(isIncome);
+        descArena.append(desc, descLen);
+        descEnds.push_back(descArena.size());
+    }
+
+    const char* descriptionData(size_t i, size_t& len) const {
+        uint64_t begin = i == 0 ? 0 : descEnds[i - 1];
+        len = descEnds[i] - begin;
+        return descArena.data() + begin;
+    }
+};
+
+// ================= Month Rollup Index =================
+// Per-month totals split by category ID and type, and by day of the month,
+// maintained incrementally as rows are added (sign = +1) or removed
+// (sign = -1). Months are grouped into years, each with its own totals.
+// Copies share the year directory, the years and the months; whichever
+// copy changes a month first clones the directory (one pointer per year),
+// that year and that month, so a copy is an O(1) snapshot that later
+// changes never reach.
+struct DayTotals {
+    int64_t income = 0;
+    int64_t expense = 0;
+};
+
+struct CategoryCell {
+    uint32_t category;
+    int64_t cents;
+};
+
+// A month's per-category cells are sparse, ascending by category ID and
+// non-zero: a row costs the same whatever ID the process-wide dictionary
+// gave its category.
+struct MonthTotals {
+    int64_t income = 0;
+    int64_t expense = 0;
+    uint32_t rows = 0;
+    vector<CategoryCell> incomeByCategory;
+    vector<CategoryCell> expenseByCategory;
+    DayTotals byDay[31];
+};
+
+// Adds sparse cells into a vector indexed by category ID, growing it only
+// as far as the largest ID present.
+static void addCells(const vector<CategoryCell>& cells, vector<int64_t>& byCategory) {
+    if (cells.empty()) return;
+    if (byCategory.size() <= cells.back().category) byCategory.resize(cells.back().category + 1, 0);
+    for (const CategoryCell& cell : cells) byCategory[cell.category] += cell.cents;
+}
+
+// True if `node` is the only holder left. Every other holder gave its
+// reference up with an acq_rel decrement, which the fence pairs with, so
+// their reads are done before the caller writes. ThreadSanitizer does not
+// model the fence, so under it nothing counts as sole-owned and every
+// write copies.
+template <class T> bool soleOwner(const shared_ptr<T>& node) {
+#ifdef PFT_TSAN
+    (void)node;
+    return false;
+#endif
+    if (node.use_count() != 1) return false;
+    atomic_thread_fence(memory_order_acquire);
+    return true;
+}
+
+// A copy-on-write node kept for reuse: unshare() parks the node it just
+// replaced here and, once nothing else holds it (the read view that shared
+// it has been dropped), assigns the next copy into it instead of
+// allocating. Copies of the owner start without one.
+template <class T> struct SpareNode {
+    shared_ptr<T> node;
+    SpareNode() = default;
+    SpareNode(const SpareNode&) {}
+    SpareNode& operator=(const SpareNode&) { return *this; }
+};
+
+template <class T> void unshare(shared_ptr<T>& node, SpareNode<T>& spare) {
+    if (soleOwner(node)) return;
+    if (soleOwner(spare.node)) {
+        *spare.node = *node;
+    } else {
+        spare.node = make_shared<T>(*node);
+    }
+    swap(node, spare.node);
+}
+
+class MonthRollup {
+    struct Year {
+        shared_ptr<MonthTotals> months[12];     // null where the month has no rows
+        DayTotals totals;
+        uint32_t monthsWithRows = 0;
+    };
+    using Directory = vector<pair<int32_t, shared_ptr<Year>>>;     // by year, ascending
+    shared_ptr<Directory> years = make_shared<Directory>();
+    size_t count = 0;
+    SpareNode<Directory> spareDirectory;
+    SpareNode<Year> spareYear;
+    SpareNode<MonthTotals> spareMonth;
+public:
+    void add(int32_t day, uint32_t category, bool income, int64_t cents) {
+        apply(day, category, income, cents, +1);
+    }
+
+    void remove(int32_t day, uint32_t category, bool income, int64_t cents) {
+        apply(day, category, income, cents, -1);
+    }
+
+    const MonthTotals* find(int32_t monthKey) const {
+        auto it = yearAt(monthKey / 100);
+        if (it == years->end() || it->first != monthKey / 100) return nullptr;
+        int m = monthKey % 100;
+        return m >= 1 && m <= 12 ? it->second->months[m - 1].get() : nullptr;
+    }
+
+    size_t monthCount() const { return count; }
+    void clear() { *this = MonthRollup(); }
+
+    // Oldest month first.
+    template <class F> void forEach(F f) const {
+        for (auto& year : *years) {
+            for (int m = 0; m < 12; m++) {
+                if (year.second->months[m]) f(year.first * 100 + m + 1, *year.second->months[m]);
+            }
+        }
+    }
+
+    // Totals of rows dated within [fromDay, toDay]: whole years between the
+    // ends from their totals, whole months from theirs, and the days of the
+    // first and last month one by one.
+    DayTotals sumRange(int32_t fromDay, int32_t toDay) const {
+        DayTotals result;
+        if (fromDay > toDay) return result;
+        int y0, m0, d0, y1, m1, d1;
+        civilFromDays(fromDay, y0, m0, d0);
+        civilFromDays(toDay, y1, m1, d1);
+        int32_t firstKey = y0 * 100 + m0, lastKey = y1 * 100 + m1;
+        for (auto it = yearAt(y0); it != years->end() && it->first <= y1; ++it) {
+            const Year& year = *it->second;
+            if (it->first > y0 && it->first < y1) {
+                result.income += year.totals.income;
+                result.expense += year.totals.expense;
+                continue;
+            }
+            for (int m = 1; m <= 12; m++) {
+                const MonthTotals* month = year.months[m - 1].get();
+                int32_t key = it->first * 100 + m;
+                if (!month || key < firstKey || key > lastKey) continue;
+                int from = key == firstKey ? d0 : 1, to = key == lastKey ? d1 : 31;
+                if (from == 1 && to == 31) {
+                    result.income += month->income;
+                    result.expense += month->expense;
+                    continue;
+                }
+                for (int d = from; d <= to; d++) {
+                    result.income += month->byDay[d - 1].income;
+                    result.expense += month->byDay[d - 1].expense;
+                }
+            }
+        }
+        return result;
+    }
+
+    // Lists every (month, category, type) cell where the two rollups differ.
+    static vector<string> diff(const MonthRollup& expected, const MonthRollup& actual) {
+        vector<string> problems;
+        set<int32_t> keys;
+        expected.forEach([&](int32_t key, const MonthTotals&) { keys.insert(key); });
+        actual.forEach([&](int32_t key, const MonthTotals&) { keys.insert(key); });
+
+        static const MonthTotals empty;
+        for (int32_t key : keys) {
+            const MonthTotals* e = expected.find(key);
+            const MonthTotals* a = actual.find(key);
+            if (!e) e = &empty;
+            if (!a) a = &empty;
+            if (e->income != a->income || e->expense != a->expense || e->rows != a->rows) {
+                stringstream ss;
+                ss << key << ": totals " << e->income << "/" << e->expense << "/" << e->rows
+                   << " vs " << a->income << "/" << a->expense << "/" << a->rows;
+                problems.push_back(ss.str());
+            }
+            diffCells(key, "income", e->incomeByCategory, a->incomeByCategory, problems);
+            diffCells(key, "expense", e->expenseByCategory, a->expenseByCategory, problems);
+            for (int d = 0; d < 31; d++) {
+                if (e->byDay[d].income != a->byDay[d].income || e->byDay[d].expense != a->byDay[d].expense) {
+                    stringstream ss;
+                    ss << key << ": day " << d + 1 << " " << e->byDay[d].income << "/" << e->byDay[d].expense
+                       << " vs " << a->byDay[d].income << "/" << a->byDay[d].expense;
+                    problems.push_back(ss.str());
+                }
+            }
+        }
+        return problems;
+    }
+
+private:
+    Directory::const_iterator yearAt(int32_t year) const {
+        return lower_bound(years->begin(), years->end(), year,
+                           [](const pair<int32_t, shared_ptr<Year>>& y, int32_t k) { return y.first < k; });
+    }
+
+    void apply(int32_t day, uint32_t category, bool income, int64_t cents, int sign) {
+        if (day == kInvalidDay) return;
+        int y, mon, d;
+        civilFromDays(day, y, mon, d);
+        if (y < 0) return;
+        unshare(years, spareDirectory);
+        size_t at = yearAt(y) - years->begin();
+        if (at == years->size() || (*years)[at].first != y)
+            years->insert(years->begin() + at, make_pair((int32_t)y, make_shared<Year>()));
+        shared_ptr<Year>& yearSlot = (*years)[at].second;
+        unshare(yearSlot, spareYear);
+        Year& year = *yearSlot;
+        shared_ptr<MonthTotals>& slot = year.months[mon - 1];
+        if (!slot) {
+            slot = make_shared<MonthTotals>();
+            year.monthsWithRows++;
+            count++;
+        } else {
+            unshare(slot, spareMonth);
+        }
+        MonthTotals& m = *slot;
+        vector<CategoryCell>& cells = income ? m.incomeByCategory : m.expenseByCategory;
+        auto cell = lower_bound(cells.begin(), cells.end(), category,
+                                [](const CategoryCell& c, uint32_t id) { return c.category < id; });
+        if (cell == cells.end() || cell->category != category)
+            cell = cells.insert(cell, CategoryCell{category, 0});
+        cell->cents += sign * cents;
+        if (cell->cents == 0) cells.erase(cell);
+        (income ? m.income : m.expense) += sign * cents;
+        (income ? m.byDay[d - 1].income : m.byDay[d - 1].expense) += sign * cents;
+        (income ? year.totals.income : year.totals.expense) += sign * cents;
+        m.rows += sign;
+        if (m.rows == 0) {
+            slot.reset();
+            count--;
+            if (--year.monthsWithRows == 0) years->erase(years->begin() + at);
+        }
+    }
+
+    static void diffCells(int32_t key, const char* type, const vector<CategoryCell>& e,
+                          const vector<CategoryCell>& a, vector<string>& problems) {
+        size_t i = 0, j = 0;
+        while (i < e.size() || j < a.size()) {
+            uint32_t id = min(i < e.size() ? e[i].category : UINT32_MAX,
+                              j < a.size() ? a[j].category : UINT32_MAX);
+            int64_t ev = i < e.size() && e[i].category == id ? e[i++].cents : 0;
+            int64_t av = j < a.size() && a[j].category == id ? a[j++].cents : 0;
+            if (ev != av) {
+                stringstream ss;
+                ss << key << ": " << type << " category " << id << " " << ev << " vs " << av;
+                problems.push_back(ss.str());
+            }
+        }
+    }
+};
+
+// ================= Row Tombstones =================
+// Deleted row numbers as a two-level copy-on-write bitmap: a shared
+// directory of 4096-row blocks, null where no row in the block is deleted.
+// Copying is O(1); the first change after a copy clones the directory (one
+// pointer per block) and the one block it touches.
+class RowSet {
+    static constexpr size_t kBlockRows = 4096;
+    struct Block {
+        uint64_t words[kBlockRows / 64] = {};
+    };
+    using Directory = vector<shared_ptr<Block>>;
+    shared_ptr<Directory> blocks = make_shared<Directory>();
+    size_t count = 0;
+public:
+    bool contains(size_t row) const {
+        size_t b = row / kBlockRows;
+        if (b >= blocks->size() || !(*blocks)[b]) return false;
+        size_t bit = row % kBlockRows;
+        return ((*blocks)[b]->words[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    void clear() { *this = RowSet(); }
+
+    // Each returns false, changing nothing, if row was already in (out of) the set.
+    bool insert(size_t row) { return assign(row, true); }
+    bool erase(size_t row) { return assign(row, false); }
+
+    // Ascending row numbers.
+    template <class F> void forEach(F f) const {
+        for (size_t b = 0; b < blocks->size(); b++) {
+            if (!(*blocks)[b]) continue;
+            for (size_t w = 0; w < kBlockRows / 64; w++) {
+                for (uint64_t bits = (*blocks)[b]->words[w]; bits; bits &= bits - 1)
+                    f(b * kBlockRows + w * 64 + __builtin_ctzll(bits));
+            }
+        }
+    }
+
+    // Ascending rows in exactly one of the two sets. Blocks the two still
+    // share are skipped unread, so comparing a set with a copy costs one
+    // pointer per block plus the blocks changed since.
+    template <class F> void forEachDifference(const RowSet& other, F f) const {
+        if (blocks == other.blocks) return;
+        size_t n = max(blocks->size(), other.blocks->size());
+        for (size_t b = 0; b < n; b++) {
+            const Block* x = b < blocks->size() ? (*blocks)[b].get() : nullptr;
+            const Block* y = b < other.blocks->size() ? (*other.blocks)[b].get() : nullptr;
+            if (x == y) continue;
+            for (size_t w = 0; w < kBlockRows / 64; w++) {
+                uint64_t bits = (x ? x->words[w] : 0) ^ (y ? y->words[w] : 0);
+                for (; bits; bits &= bits - 1) f(b * kBlockRows + w * 64 + __builtin_ctzll(bits));
+            }
+        }
+    }
+
+private:
+    bool assign(size_t row, bool on) {
+        if (contains(row) == on) return false;
+        size_t b = row / kBlockRows, bit = row % kBlockRows;
+        if (blocks.use_count() > 1) blocks = make_shared<Directory>(*blocks);
+        if (blocks->size() <= b) blocks->resize(b + 1);
+        shared_ptr<Block>& block = (*blocks)[b];
+        if (!block) block = make_shared<Block>();
+        else if (block.use_count() > 1) block = make_shared<Block>(*block);
+        block->words[bit >> 6] ^= uint64_t(1) << (bit & 63);
+        on ? count++ : count--;
+        return true;
+    }
+};
+
+// ================= Aggregation Kernels =================
+// Month reductions over the columnar layout: income and expense sums split
+// by the income bitmap, optionally filtered to one month key, with an
+// optional per-category expense histogram. The AVX2 and AVX-512 variants
+// are chosen at runtime; all variants must agree exactly with the scalar
+// one (see --selfcheck).
+struct RowColumns {
+    const int32_t* monthKeys;    // may be null when no month filter is used
+    const int64_t* cents;
+    const uint32_t* categories;
+    const uint64_t* incomeBits;
+};
+
+struct MonthSums {
+    int64_t income = 0;
+    int64_t expense = 0;
+};
+
+// Sums rows [begin, end). monthKey < 0 means every row in the range counts.
+// expenseByCategory, if non-null, must have a cell for every category ID.
+using SumKernel = void (*)(const RowColumns& cols, size_t begin, size_t end, int32_t monthKey,
+                           MonthSums& sums, int64_t* expenseByCategory);
+
+static inline void sumRowScalar(const RowColumns& cols, size_t i, int32_t monthKey,
+                                MonthSums& sums, int64_t* expenseByCategory) {
+    if (monthKey >= 0 && cols.monthKeys[i] != monthKey) return;
+    if ((cols.incomeBits[i >> 6] >> (i & 63)) & 1) {
+        sums.income += cols.cents[i];
+    } else {
+        sums.expense += cols.cents[i];
+        if (expenseByCategory) expenseByCategory[cols.categories[i]] += cols.cents[i];
+    }
+}
+
+static void sumRowsScalar(const RowColumns& cols, size_t begin, size_t end, int32_t monthKey,
+                          MonthSums& sums, int64_t* expenseByCategory) {
+    for (size_t i = begin; i < end; i++) sumRowScalar(cols, i, monthKey, sums, expenseByCategory);
+}
+
+#if defined(PFT_X86_KERNELS)
+// Histogram pass over one 64-row word: only the expense rows selected by
+// `mask` are touched.
+static inline void addExpenseCells(const RowColumns& cols, size_t base, uint64_t mask,
+                                   int64_t* expenseByCategory) {
+    while (mask) {
+        size_t i = base + __builtin_ctzll(mask);
+        expenseByCategory[cols.categories[i]] += cols.cents[i];
+        mask &= mask - 1;
+    }
+}
+
+// Lane masks for 4 x int64: entry b has lane k set iff bit k of b is set.
+alignas(32) static const int64_t kLaneMask4[16][4] = {
+    {0, 0, 0, 0},   {-1, 0, 0, 0},   {0, -1, 0, 0},   {-1, -1, 0, 0},
+    {0, 0, -1, 0},  {-1, 0, -1, 0},  {0, -1, -1, 0},  {-1, -1, -1, 0},
+    {0, 0, 0, -1},  {-1, 0, 0, -1},  {0, -1, 0, -1},  {-1, -1, 0, -1},
+    {0, 0, -1, -1}, {-1, 0, -1, -1}, {0, -1, -1, -1}, {-1, -1, -1, -1},
+};
+
+__attribute__((target("avx2")))
+static void sumRowsAvx2(const RowColumns& cols, size_t begin, size_t end, int32_t monthKey,
+                        MonthSums& sums, int64_t* expenseByCategory) {
+    // Scalar head and tail; the body runs over whole 64-row bitmap words.
+    size_t first = min(end, (begin + 63) & ~size_t(63));
+    size_t last = max(first, end & ~size_t(63));
+    sumRowsScalar(cols, begin, first, monthKey, sums, expenseByCategory);
+
+    __m256i income = _mm256_setzero_si256(), expense = _mm256_setzero_si256();
+    const __m256i key = _mm256_set1_epi32(monthKey);
+    for (size_t base = first; base < last; base += 64) {
+        uint64_t match = ~uint64_t(0);
+        if (monthKey >= 0) {
+            match = 0;
+            for (int k = 0; k < 64; k += 8) {
+                __m256i keys = _mm256_loadu_si256((const __m256i*)(cols.monthKeys + base + k));
+                uint32_t bits = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(keys, key)));
+                match |= uint64_t(bits) << k;
+            }
+            if (!match) continue;
+        }
+        uint64_t inMask = cols.incomeBits[base >> 6] & match;
+        uint64_t exMask = ~cols.incomeBits[base >> 6] & match;
+        for (int k = 0; k < 64; k += 4) {
+            __m256i c = _mm256_loadu_si256((const __m256i*)(cols.cents + base + k));
+            __m256i in = _mm256_load_si256((const __m256i*)kLaneMask4[(inMask >> k) & 15]);
+            __m256i ex = _mm256_load_si256((const __m256i*)kLaneMask4[(exMask >> k) & 15]);
+            income = _mm256_add_epi64(income, _mm256_and_si256(c, in));
+            expense = _mm256_add_epi64(expense, _mm256_and_si256(c, ex));
+        }
+        if (expenseByCategory) addExpenseCells(cols, base, exMask, expenseByCategory);
+    }
+
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256((__m256i*)lanes, income);
+    sums.income += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm256_store_si256((__m256i*)lanes, expense);
+    sums.expense += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    sumRowsScalar(cols, last, end, monthKey, sums, expenseByCategory);
+}
+
+__attribute__((target("avx512f")))
+static void sumRowsAvx512(const RowColumns& cols, size_t begin, size_t end, int32_t monthKey,
+                          MonthSums& sums, int64_t* expenseByCategory) {
+    size_t first = min(end, (begin + 63) & ~size_t(63));
+    size_t last = max(first, end & ~size_t(63));
+    sumRowsScalar(cols, begin, first, monthKey, sums, expenseByCategory);
+
+    __m512i income = _mm512_setzero_si512(), expense = _mm512_setzero_si512();
+    const __m512i key = _mm512_set1_epi32(monthKey);
+    for (size_t base = first; base < last; base += 64) {
+        uint64_t match = ~uint64_t(0);
+        if (monthKey >= 0) {
+            match = 0;
+            for (int k = 0; k < 64; k += 16) {
+                __m512i keys = _mm512_loadu_si512(cols.monthKeys + base + k);
+                match |= uint64_t(_mm512_cmpeq_epi32_mask(keys, key)) << k;
+            }
+            if (!match) continue;
+        }
+        uint64_t inMask = cols.incomeBits[base >> 6] & match;
+        uint64_t exMask = ~cols.incomeBits[base >> 6] & match;
+        for (int k = 0; k < 64; k += 8) {
+            __m512i c = _mm512_loadu_si512(cols.cents + base + k);
+            income = _mm512_mask_add_epi64(income, (__mmask8)(inMask >> k), income, c);
+            expense = _mm512_mask_add_epi64(expense, (__mmask8)(exMask >> k), expense, c);
+        }
+        if (expenseByCategory) addExpenseCells(cols, base, exMask, expenseByCategory);
+    }
+
+    alignas(64) int64_t lanes[2][8];
+    _mm512_store_si512(lanes[0], income);
+    _mm512_store_si512(lanes[1], expense);
+    for (int k = 0; k < 8; k++) {
+        sums.income += lanes[0][k];
+        sums.expense += lanes[1][k];
+    }
+    sumRowsScalar(cols, last, end, monthKey, sums, expenseByCategory);
+}
+#endif
+
+// Every kernel this CPU can run, best first; the scalar one is always last.
+static const vector<pair<const char*, SumKernel>>& availableSumKernels() {
+    static const vector<pair<const char*, SumKernel>> kernels = [] {
+        vector<pair<const char*, SumKernel>> k;
+#if defined(PFT_X86_KERNELS)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) k.push_back({"avx512", sumRowsAvx512});
+        if (__builtin_cpu_supports("avx2")) k.push_back({"avx2", sumRowsAvx2});
+#endif
+        k.push_back({"scalar", sumRowsScalar});
+        return k;
+    }();
+    return kernels;
+}
+
+static void sumRows(const RowColumns& cols, size_t begin, size_t end, int32_t monthKey,
+                    MonthSums& sums, int64_t* expenseByCategory) {
+    static const SumKernel best = availableSumKernels().front().second;
+    best(cols, begin, end, monthKey, sums, expenseByCategory);
+}
+
+// ================= Sealed Ledger Files =================
+// Flushes stdio buffers and forces the file to stable storage.
+static bool syncFile(FILE* f) {
+    if (fflush(f) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+// Read-only mapping of a whole file. Falls back to reading the file into
+// memory where mmap is unavailable.
+class MappedFile {
+    const char* bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    vector<char> copy;
+#endif
+public:
+    MappedFile() {}
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() {
+#ifndef _WIN32
+        if (bytes && length) munmap((void*)bytes, length);
+#endif
+    }
+
+    // An empty file opens as zero bytes.
+    bool open(const string& path) {
+#ifdef _WIN32
+        FILE* f = fopen(path.c_str(), "rb");
+        if (!f) return false;
+        char chunk[1 << 16];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof chunk, f)) > 0) copy.insert(copy.end(), chunk, chunk + n);
+        fclose(f);
+        bytes = copy.empty() ? "" : copy.data();
+        length = copy.size();
+        return true;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        bool ok = fstat(fd, &st) == 0;
+        if (ok && st.st_size == 0) {
+            bytes = "";                         // mmap rejects a zero length
+        } else if (ok) {
+            void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            ok = p != MAP_FAILED;
+            if (ok) {
+                bytes = (const char*)p;
+                length = (size_t)st.st_size;
+            }
+        }
+        ::close(fd);
+        return ok;
+#endif
+    }
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+};
+
+// Immutable ledger segment for closed months: fixed-width columns plus a
+// string heap, rows sorted by date with a per-month row index and per-day
+// prefix sums. Queries run directly over the mapping; rows are never
+// deserialized, and open() reads only the header and the indexes.
+class SealedLedger {
+    static constexpr uint64_t kMagic = 0x32444C5354465050ull;   // "PPFTSLD2"
+
+    struct Header {
+        uint64_t magic;
+        uint64_t rows;
+        uint32_t categoryCount;
+        uint32_t monthCount;
+        uint64_t monthsOffset;
+        uint64_t daysOffset;
+        uint64_t centsOffset;
+        uint64_t categoriesOffset;
+        uint64_t incomeOffset;
+        uint64_t nameEndsOffset;
+        uint64_t descEndsOffset;
+        uint64_t heapOffset;
+        uint64_t heapSize;
+        uint64_t dayCount;
+        uint64_t dayKeysOffset;
+        uint64_t dayPrefixOffset;   // dayCount + 1 entries
+    };
+
+    struct MonthEntry {
+        int32_t monthKey;
+        uint32_t firstRow;
+        uint32_t rowCount;
+        uint32_t reserved;
+    };
+
+    MappedFile file;
+    string filePath;
+    const Header* header = nullptr;
+    const MonthEntry* months = nullptr;
+    const int32_t* days = nullptr;
+    const int64_t* cents = nullptr;
+    const uint32_t* categories = nullptr;
+    const uint64_t* incomeBits = nullptr;
+    const uint64_t* nameEnds = nullptr;
+    const uint64_t* descEnds = nullptr;
+    const char* heap = nullptr;
+    const int32_t* dayKeys = nullptr;       // distinct days, ascending
+    const DayTotals* dayPrefix = nullptr;   // totals of the days before dayKeys[i]
+    vector<uint32_t> remap;          // file-local -> dictionary category IDs
+public:
+    // Writes the given ledger rows (already in date order) to path. The
+    // file is written and synced beside path and renamed over it, so a
+    // mapping of an earlier file at path keeps its own bytes; on failure
+    // nothing is left behind.
+    static bool write(const string& path, const Ledger& ledger, const vector<uint32_t>& rows) {
+        const CategoryDictionary& dict = CategoryDictionary::instance();
+        unordered_map<uint32_t, uint32_t> local;
+        vector<uint32_t> globalIds;
+        vector<MonthEntry> monthIndex;
+        vector<int32_t> d(rows.size());
+        vector<int64_t> c(rows.size());
+        vector<uint32_t> cat(rows.size());
+        vector<uint64_t> bits((rows.size() + 63) / 64, 0);
+        vector<int32_t> dayKeyList;
+        vector<DayTotals> prefix(1);
+        for (size_t i = 0; i < rows.size(); i++) {
+            uint32_t r = rows[i];
+            d[i] = ledger.dayAt(r);
+            c[i] = ledger.centsAt(r);
+            auto it = local.emplace(ledger.categoryAt(r), (uint32_t)globalIds.size()).first;
+            if (it->second == globalIds.size()) globalIds.push_back(it->first);
+            cat[i] = it->second;
+            if (ledger.isIncome(r)) bits[i >> 6] |= uint64_t(1) << (i & 63);
+            if (dayKeyList.empty() || dayKeyList.back() != d[i]) {
+                dayKeyList.push_back(d[i]);
+                prefix.push_back(prefix.back());
+            }
+            (ledger.isIncome(r) ? prefix.back().income : prefix.back().expense) += c[i];
+
+            int32_t key = ledger.monthKeyAt(r);
+            if (monthIndex.empty() || monthIndex.back().monthKey != key)
+                monthIndex.push_back(MonthEntry{key, (uint32_t)i, 0, 0});
+            monthIndex.back().rowCount++;
+        }
+
+        string heapBytes;
+        vector<uint64_t> nameEndList, descEndList;
+        for (uint32_t id : globalIds) {
+            heapBytes += dict.displayName(id);
+            nameEndList.push_back(heapBytes.size());
+        }
+        for (uint32_t r : rows) {
+            heapBytes += ledger.descriptionAt(r);
+            descEndList.push_back(heapBytes.size());
+        }
+
+        Header h{};
+        h.magic = kMagic;
+        h.rows = rows.size();
+        h.categoryCount = (uint32_t)globalIds.size();
+        h.monthCount = (uint32_t)monthIndex.size();
+        uint64_t offset = sizeof(Header);
+        auto place = [&](uint64_t& field, size_t bytes) {
+            field = offset;
+            offset = (offset + bytes + 7) & ~uint64_t(7);
+        };
+        place(h.monthsOffset, monthIndex.size() * sizeof(MonthEntry));
+        place(h.daysOffset, d.size() * 4);
+        place(h.centsOffset, c.size() * 8);
+        place(h.categoriesOffset, cat.size() * 4);
+        place(h.incomeOffset, bits.size() * 8);
+        place(h.nameEndsOffset, nameEndList.size() * 8);
+        place(h.descEndsOffset, descEndList.size() * 8);
+        place(h.heapOffset, heapBytes.size());
+        h.heapSize = heapBytes.size();
+        h.dayCount = dayKeyList.size();
+        place(h.dayKeysOffset, dayKeyList.size() * 4);
+        place(h.dayPrefixOffset, prefix.size() * sizeof(DayTotals));
+
+        string tmp = path + ".tmp";
+        FILE* f = fopen(tmp.c_str(), "wb");
+        if (!f) return false;
+        bool ok = true;
+        uint64_t written = 0;
+        auto put = [&](uint64_t at, const void* p, size_t n) {
+            static const char zeros[8] = {0};
+            if (at > written) ok = ok && fwrite(zeros, 1, at - written, f) == at - written;
+            if (n) ok = ok && fwrite(p, 1, n, f) == n;
+            written = at + n;
+        };
+        put(0, &h, sizeof h);
+        put(h.monthsOffset, monthIndex.data(), monthIndex.size() * sizeof(MonthEntry));
+        put(h.daysOffset, d.data(), d.size() * 4);
+        put(h.centsOffset, c.data(), c.size() * 8);
+        put(h.categoriesOffset, cat.data(), cat.size() * 4);
+        put(h.incomeOffset, bits.data(), bits.size() * 8);
+        put(h.nameEndsOffset, nameEndList.data(), nameEndList.size() * 8);
+        put(h.descEndsOffset, descEndList.data(), descEndList.size() * 8);
+        put(h.heapOffset, heapBytes.data(), heapBytes.size());
+        put(h.dayKeysOffset, dayKeyList.data(), dayKeyList.size() * 4);
+        put(h.dayPrefixOffset, prefix.data(), prefix.size() * sizeof(DayTotals));
+        ok = syncFile(f) && ok;
+        ok = fclose(f) == 0 && ok;
+        error_code ec;
+        if (ok) filesystem::rename(tmp, path, ec);
+        if (!ok || ec) filesystem::remove(tmp, ec);
+        return ok && !ec;
+    }
+
+    // Checks the header, that every column and index lies inside the file,
+    // the category names and the month index; the rows themselves are
+    // trusted (see verify), so opening touches no row pages.
+    bool open(const string& path) {
+        if (!file.open(path) || file.size() < sizeof(Header)) return false;
+        filePath = path;
+        const char* base = file.data();
+        header = (const Header*)base;
+        const Header& h = *header;
+        if (h.magic != kMagic || h.rows > file.size() || h.dayCount > h.rows) return false;
+
+        auto fits = [&](uint64_t offset, uint64_t bytes) {
+            return offset % 8 == 0 && offset <= file.size() && bytes <= file.size() - offset;
+        };
+        if (!fits(h.monthsOffset, h.monthCount * sizeof(MonthEntry)) ||
+            !fits(h.daysOffset, h.rows * 4) || !fits(h.centsOffset, h.rows * 8) ||
+            !fits(h.categoriesOffset, h.rows * 4) || !fits(h.incomeOffset, (h.rows + 63) / 64 * 8) ||
+            !fits(h.nameEndsOffset, h.categoryCount * 8) || !fits(h.descEndsOffset, h.rows * 8) ||
+            !fits(h.heapOffset, h.heapSize) || !fits(h.dayKeysOffset, h.dayCount * 4) ||
+            !fits(h.dayPrefixOffset, (h.dayCount + 1) * sizeof(DayTotals)))
+            return false;
+
+        months = (const MonthEntry*)(base + h.monthsOffset);
+        days = (const int32_t*)(base + h.daysOffset);
+        cents = (const int64_t*)(base + h.centsOffset);
+        categories = (const uint32_t*)(base + h.categoriesOffset);
+        incomeBits = (const uint64_t*)(base + h.incomeOffset);
+        nameEnds = (const uint64_t*)(base + h.nameEndsOffset);
+        descEnds = (const uint64_t*)(base + h.descEndsOffset);
+        heap = base + h.heapOffset;
+        dayKeys = (const int32_t*)(base + h.dayKeysOffset);
+        dayPrefix = (const DayTotals*)(base + h.dayPrefixOffset);
+
+        uint64_t prev = 0;
+        for (uint32_t i = 0; i < h.categoryCount; i++) {
+            if (nameEnds[i] < prev || nameEnds[i] > h.heapSize) return false;
+            remap.push_back(CategoryDictionary::instance().intern(
+                string(heap + prev, nameEnds[i] - prev)));
+            if (remap.back() == CategoryDictionary::kNoId) return false;
+            prev = nameEnds[i];
+        }
+        uint64_t next = 0;
+        for (uint32_t m = 0; m < h.monthCount; m++) {
+            if (months[m].firstRow != next || (m > 0 && months[m].monthKey <= months[m - 1].monthKey))
+                return false;
+            next += months[m].rowCount;
+        }
+        return next == h.rows;
+    }
+
+    // Everything open() trusts: category indexes, description bounds, date
+    // order, the month index and the day prefix sums against the rows. A
+    // full scan, O(rows).
+    bool verify() const {
+        const Header& h = *header;
+        uint64_t prev = h.categoryCount ? nameEnds[h.categoryCount - 1] : 0;
+        size_t m = 0, day = 0;
+        DayTotals running;
+        for (uint64_t i = 0; i < h.rows; i++) {
+            if (categories[i] >= h.categoryCount || descEnds[i] < prev || descEnds[i] > h.heapSize)
+                return false;
+            if (i > 0 && days[i] < days[i - 1]) return false;   // rows are in date order
+            prev = descEnds[i];
+            while (m < h.monthCount && i >= (uint64_t)months[m].firstRow + months[m].rowCount) m++;
+            if (m == h.monthCount || months[m].monthKey != monthKeyOfDay(days[i])) return false;
+            if (i == 0 || days[i] != days[i - 1]) {
+                if (day == h.dayCount || dayKeys[day] != days[i]) return false;
+                if (dayPrefix[day].income != running.income || dayPrefix[day].expense != running.expense)
+                    return false;
+                day++;
+            }
+            (isIncome(i) ? running.income : running.expense) += cents[i];
+        }
+        return day == h.dayCount && dayPrefix[day].income == running.income &&
+               dayPrefix[day].expense == running.expense;
+    }
+
+    // Totals of rows dated within [fromDay, toDay]: two binary searches
+    // over the mapped day prefix sums.
+    DayTotals sumRange(int32_t fromDay, int32_t toDay) const {
+        DayTotals result;
+        if (fromDay > toDay) return result;
+        const int32_t* end = dayKeys + header->dayCount;
+        size_t lo = lower_bound(dayKeys, end, fromDay) - dayKeys;
+        size_t hi = upper_bound(dayKeys, end, toDay) - dayKeys;
+        result.income = dayPrefix[hi].income - dayPrefix[lo].income;
+        result.expense = dayPrefix[hi].expense - dayPrefix[lo].expense;
+        return result;
+    }
+
+    const string& path() const { return filePath; }
+    size_t size() const { return header->rows; }
+
+    size_t monthCount() const { return header->monthCount; }
+    int32_t monthKeyAt(size_t m) const { return months[m].monthKey; }
+    uint32_t monthRowCount(size_t m) const { return months[m].rowCount; }
+
+    int32_t dayAt(size_t i) const { return days[i]; }
+    int64_t centsAt(size_t i) const { return cents[i]; }
+    uint32_t categoryAt(size_t i) const { return remap[categories[i]]; }
+    bool isIncome(size_t i) const { return (incomeBits[i >> 6] >> (i & 63)) & 1; }
+
+    string descriptionAt(size_t i) const { return string(descriptionView(i)); }
+
+    string_view descriptionView(size_t i) const {
+        uint64_t begin = i == 0 ? (header->categoryCount ? nameEnds[header->categoryCount - 1] : 0)
+                                : descEnds[i - 1];
+        return string_view(heap + begin, descEnds[i] - begin);
+    }
+
+    // Adds the month's totals to income/expense (and per-category expense)
+    // by scanning only that month's row range of the mapped columns.
+    void addMonth(int32_t monthKey, int64_t& income, int64_t& expense,
+                  vector<int64_t>* byCategory) const {
+        const MonthEntry* end = months + header->monthCount;
+        const MonthEntry* m = lower_bound(months, end, monthKey,
+            [](const MonthEntry& e, int32_t key) { return e.monthKey < key; });
+        if (m == end || m->monthKey != monthKey) return;
+
+        // Histogram in file-local category IDs, then remap the touched cells.
+        RowColumns cols{nullptr, cents, categories, incomeBits};
+        MonthSums sums;
+        vector<int64_t> local(byCategory ? header->categoryCount : 0, 0);
+        sumRows(cols, m->firstRow, (size_t)m->firstRow + m->rowCount, -1, sums,
+                byCategory ? local.data() : nullptr);
+        income += sums.income;
+        expense += sums.expense;
+        for (uint32_t c = 0; c < local.size(); c++) {
+            if (!local[c]) continue;
+            uint32_t id = remap[c];
+            if (byCategory->size() <= id) byCategory->resize(id + 1, 0);
+            (*byCategory)[id] += local[c];
+        }
+    }
+};
+
+// ================= Analytics Results =================
+// Plain values returned by User queries: exact Money amounts and category
+// IDs, no text. Formatting (text or JSON) lives in Report Rendering and is
+// paid only by callers that want it.
+struct MonthSummary {
+    int32_t monthKey = -1;
+    Money income;
+    Money expense;
+    Money savings() const { return income - expense; }
+};
+
+struct RangeSummary {
+    int32_t fromDay = kInvalidDay;   // inclusive
+    int32_t toDay = kInvalidDay;     // inclusive
+    Money income;
+    Money expense;
+    Money savings() const { return income - expense; }
+};
+
+struct CategoryAmount {
+    uint32_t categoryId;
+    Money amount;
+};
+
+struct CategoryBreakdown {
+    int32_t monthKey = -1;
+    vector<CategoryAmount> expenses;    // ordered by category name
+};
+
+enum class Advice : uint8_t {
+    NoTransactions,
+    Overspending,
+    LowSavings,           // saved under 20% of income
+    HealthySavings,
+    HighCategorySpend,    // one category is over half of all expense
+};
+
+struct Recommendation {
+    Advice code;
+    uint32_t categoryId = 0;    // HighCategorySpend only
+};
+
+struct Recommendations {
+    int32_t monthKey = -1;
+    Money savings;
+    vector<Recommendation> items;
+};
+
+struct CategoryForecast {
+    uint32_t categoryId;
+    Money monthToDate;
+    Money endOfMonth;
+    Money nextQuarter;
+};
+
+// Projections for asOf's month and the three after it. To-date figures
+// count every row dated in that month; the rest of the month is the
+// forecast scaled by the share of days left after asOf.
+struct SpendingForecast {
+    int32_t asOfDay = kInvalidDay;
+    int32_t monthKey = -1;
+    uint32_t monthsFitted = 0;                  // closed months behind the model
+    Money incomeToDate;
+    Money expenseToDate;
+    Money income;                               // projected month totals
+    Money expense;
+    Money nextQuarterIncome;                    // the three months after
+    Money nextQuarterExpense;
+    vector<CategoryForecast> expenses;          // ordered by category name
+};
+
+struct AccountForecast {
+    string username;
+    SpendingForecast forecast;
+};
+
+// Raised by the Spending Monitor as an expense is appended.
+enum class AlertKind : uint8_t {
+    OutlierExpense,       // far above the category's usual amount
+    OverspendPace,        // month-to-date expense heading well past the usual month
+};
+
+struct SpendingAlert {
+    uint64_t seq = 0;           // per user, from 1, increasing
+    AlertKind kind;
+    int32_t day;                // the expense that raised it
+    uint32_t categoryId;
+    Money amount;               // the expense, or the month's projected expense
+    Money expected;             // the category's usual amount, or the usual month
+};
+
+// One user's re-evaluated months (see FinanceTracker::refreshAdvice).
+struct AccountAdvice {
+    string username;
+    vector<Recommendations> months;     // oldest first
+};
+
+struct TransactionRow {
+    int32_t day;
+    Money amount;
+    uint32_t categoryId;
+    bool income;
+    string description;
+    uint64_t row = 0;           // row number, for edits and deletes
+};
+
+struct MonthActivity {
+    MonthSummary summary;
+    vector<CategoryAmount> expenses;    // ordered by category name
+};
+
+// Everything the dashboard shows for one account.
+struct AccountHistory {
+    string username;
+    uint32_t currency = Money::kUSD;
+    size_t transactions = 0;
+    vector<MonthActivity> months;       // every month with rows, oldest first
+};
+
+// Paged listing. Pages are addressed by offset, or by keyset: the key of
+// the last row of the previous page, which stays valid while rows are
+// added. Keys are (day or minor units, row number).
+enum class RowOrder : uint8_t { Date, Amount };
+
+struct PageKey {
+    int64_t value = 0;
+    uint32_t row = 0;           // row numbers stay below User::kMaxRows
+};
+
+struct PageRequest {
+    RowOrder order = RowOrder::Date;
+    bool descending = false;
+    size_t limit = 50;
+    size_t offset = 0;          // ignored when hasAfter
+    bool hasAfter = false;
+    PageKey after;              // continue after this row
+};
+
+struct PageResult {
+    size_t rows = 0;            // rows written
+    size_t bytes = 0;           // bytes written, one '\n'-terminated line per row
+    size_t total = 0;           // rows in the whole listing
+    bool more = false;          // rows remain past this page
+    PageKey last;               // pass as `after` for the next page
+};
+
+// One listing line in the getTransactionStrings layout plus '\n', built
+// with to_chars. Returns the bytes written, or 0 if it does not fit.
+static size_t formatTransactionLine(char* out, size_t cap, int32_t day, const Money& amount,
+                                    const string& category, bool income, string_view desc) {
+    char date[16], money[32];
+    int y, m, d;
+    civilFromDays(day, y, m, d);
+    snprintf(date, sizeof date, "%04d-%02d-%02d", y, m, d);
+    size_t moneyLen = amount.format(money);
+    const char* type = income ? "Income" : "Expense";
+    size_t typeLen = income ? 6 : 7;
+
+    auto padded = [](size_t len, size_t width) { return len < width ? width : len; };
+    size_t need = padded(10, 12) + 3 + padded(moneyLen, 10) + 3 + padded(category.size(), 12) +
+                  3 + padded(typeLen, 10) + 3 + desc.size() + 1;
+    if (need > cap) return 0;
+
+    char* p = out;
+    auto put = [&](const char* text, size_t len, size_t width) {
+        if (len < width) {
+            memset(p, ' ', width - len);
+            p += width - len;
+        }
+        if (len) memcpy(p, text, len);      // empty descriptions view no storage
+        p += len;
+    };
+    put(date, 10, 12);
+    put(" | ", 3, 0);
+    put(money, moneyLen, 10);
+    put(" | ", 3, 0);
+    put(category.data(), category.size(), 12);
+    put(" | ", 3, 0);
+    put(type, typeLen, 10);
+    put(" | ", 3, 0);
+    put(desc.data(), desc.size(), 0);
+    *p++ = '\n';
+    return p - out;
+}
+
+// ================= Recommendation Rules =================
+// Advice is declared as data: each rule tests one measure of a trailing
+// window of months against a threshold. AdviceProgram compiles a rule list
+// once (category names resolved, window lengths deduplicated) into flat
+// steps that User runs per month and caches until an append touches a
+// month in the window. Tests are exact integer comparisons on minor
+// units; percentages are cross-multiplied, never divided.
+enum class RuleMeasure : uint8_t {
+    Volume,             // |income| + |expense|
+    Savings,            // income - expense
+    SavingsPercent,     // savings as a percent of income
+    CategoryPercent,    // a category's share of expense, in percent
+    Always,             // no test: a group's fallback
+};
+
+struct AdviceRule {
+    Advice advice;
+    RuleMeasure measure;
+    bool above = false;         // fires when the measure exceeds threshold, else when below it
+    int64_t threshold = 0;      // minor units, or percent for the *Percent measures
+    uint32_t windowMonths = 1;  // months summed, ending with the month evaluated
+    string category;            // CategoryPercent: one category, or empty for each
+    uint32_t group = 0;         // at most one rule of a non-zero group fires, first wins
+    bool final = false;         // no later rule runs once this one fires
+};
+
+// The historical rules: nothing to say about an empty month; otherwise
+// overspending, under 20% saved, or healthy; then every category that is
+// over half of all expense.
+static vector<AdviceRule> defaultAdviceRules() {
+    return {
+        {Advice::NoTransactions, RuleMeasure::Volume, false, 1, 1, "", 0, true},
+        {Advice::Overspending, RuleMeasure::Savings, false, 0, 1, "", 1, false},
+        {Advice::LowSavings, RuleMeasure::SavingsPercent, false, 20, 1, "", 1, false},
+        {Advice::HealthySavings, RuleMeasure::Always, false, 0, 1, "", 1, false},
+        {Advice::HighCategorySpend, RuleMeasure::CategoryPercent, true, 50, 1, "", 0, false},
+    };
+}
+
+// Sums over one window of months, filled in by the caller.
+struct WindowTotals {
+    int64_t income = 0;
+    int64_t expense = 0;
+    vector<int64_t> expenseByCategory;
+};
+
+class AdviceProgram {
+public:
+    static const uint32_t kMaxWindowMonths = 120;
+    static const uint32_t kEachCategory = UINT32_MAX;
+
+    struct Step {
+        RuleMeasure measure;
+        bool above;
+        bool final;
+        Advice advice;
+        uint32_t group;
+        uint32_t window;        // index into windows()
+        uint32_t category;      // kEachCategory: every category with expense
+        int64_t threshold;
+    };
+
+    // A default-constructed program runs defaultAdviceRules().
+    AdviceProgram() { compile(defaultAdviceRules()); }
+
+    // False, leaving the program unchanged, if a rule's window is empty or
+    // longer than kMaxWindowMonths, or it names a category on a measure
+    // that takes none or that the category table has no room for. Every
+    // successful compile gets a new version().
+    bool compile(const vector<AdviceRule>& rules) {
+        vector<uint32_t> lengths;
+        for (const AdviceRule& rule : rules) {
+            if (rule.windowMonths == 0 || rule.windowMonths > kMaxWindowMonths) return false;
+            if (!rule.category.empty() && rule.measure != RuleMeasure::CategoryPercent) return false;
+            lengths.push_back(rule.windowMonths);
+        }
+        sort(lengths.begin(), lengths.end());
+        lengths.erase(unique(lengths.begin(), lengths.end()), lengths.end());
+
+        vector<Step> compiled;
+        uint32_t groupCount = 1;
+        for (const AdviceRule& rule : rules) {
+            Step step;
+            step.measure = rule.measure;
+            step.above = rule.above;
+            step.final = rule.final;
+            step.advice = rule.advice;
+            step.group = rule.group;
+            step.window = (uint32_t)(lower_bound(lengths.begin(), lengths.end(), rule.windowMonths) -
+                                     lengths.begin());
+            step.category = rule.category.empty() ? kEachCategory
+                                                  : CategoryDictionary::instance().intern(rule.category);
+            if (step.category == CategoryDictionary::kNoId && !rule.category.empty()) return false;
+            step.threshold = rule.threshold;
+            compiled.push_back(step);
+            groupCount = max(groupCount, rule.group + 1);
+        }
+        source = rules;
+        steps = move(compiled);
+        windowLengths = move(lengths);
+        groups = groupCount;
+        programVersion = nextVersion.fetch_add(1) + 1;
+        return true;
+    }
+
+    uint64_t version() const { return programVersion; }
+    const vector<AdviceRule>& rules() const { return source; }
+
+    // Distinct window lengths in months, ascending; run() expects one
+    // WindowTotals per entry.
+    const vector<uint32_t>& windows() const { return windowLengths; }
+
+    // Months after a changed month whose advice may change with it.
+    uint32_t span() const { return windowLengths.empty() ? 1 : windowLengths.back(); }
+
+    void run(const vector<WindowTotals>& totals, vector<Recommendation>& items) const {
+        vector<char> fired(groups, 0);
+        for (const Step& step : steps) {
+            if (step.group && fired[step.group]) continue;
+            const WindowTotals& t = totals[step.window];
+            size_t before = items.size();
+            switch (step.measure) {
+            case RuleMeasure::Volume:
+                if (passes(step.above, abs(t.income) + abs(t.expense), step.threshold))
+                    items.push_back(Recommendation{step.advice});
+                break;
+            case RuleMeasure::Savings:
+                if (passes(step.above, t.income - t.expense, step.threshold))
+                    items.push_back(Recommendation{step.advice});
+                break;
+            case RuleMeasure::SavingsPercent:
+                if (passes(step.above, (t.income - t.expense) * 100, t.income * step.threshold))
+                    items.push_back(Recommendation{step.advice});
+                break;
+            case RuleMeasure::CategoryPercent:
+                if (step.category == kEachCategory) {
+                    for (uint32_t id : CategoryDictionary::instance().sortedByName(t.expenseByCategory)) {
+                        if (passes(step.above, t.expenseByCategory[id] * 100, t.expense * step.threshold))
+                            items.push_back(Recommendation{step.advice, id});
+                    }
+                } else {
+                    int64_t amount = step.category < t.expenseByCategory.size()
+                                         ? t.expenseByCategory[step.category] : 0;
+                    if (passes(step.above, amount * 100, t.expense * step.threshold))
+                        items.push_back(Recommendation{step.advice, step.category});
+                }
+                break;
+            case RuleMeasure::Always:
+                items.push_back(Recommendation{step.advice});
+                break;
+            }
+            if (items.size() == before) continue;
+            fired[step.group] = 1;
+            if (step.final) break;
+        }
+    }
+
+private:
+    vector<AdviceRule> source;
+    vector<Step> steps;
+    vector<uint32_t> windowLengths;
+    uint32_t groups = 1;
+    uint64_t programVersion = 0;
+    static atomic<uint64_t> nextVersion;
+
+    static bool passes(bool above, int64_t lhs, int64_t rhs) { return above ? lhs > rhs : lhs < rhs; }
+};
+
+atomic<uint64_t> AdviceProgram::nextVersion{0};
+
+// ================= Spending Monitor =================
+// Online statistics kept per user and updated in O(1) by every appended
+// expense: an exponentially weighted mean and variance of amounts per
+// category, and a weighted mean of closed month totals. An expense far
+// above its category's mean, or a month-to-date total on pace to pass the
+// usual month, raises an alert as the row lands. Memory is bounded: at
+// most kMaxCategories categories (the least recently seen is replaced)
+// and the last kMaxAlerts alerts.
+struct AnomalyOptions {
+    bool enabled = true;
+    double alpha = 0.1;             // weight of the newest amount in a category
+    double monthAlpha = 0.3;        // weight of the newest closed month
+    double zScore = 3.0;            // outlier: amount > mean + zScore * stddev ...
+    double minRatio = 2.0;          // ... and at least minRatio * mean
+    uint32_t minSamples = 8;        // amounts seen in a category before it can flag
+    double paceFactor = 1.25;       // pace: projected month > paceFactor * usual month
+    int paceFromDay = 8;            // earlier in the month only the actual total counts
+    uint32_t minMonths = 3;         // closed months before pace alerts
+};
+
+class SpendingMonitor {
+public:
+    static const size_t kMaxCategories = 16;
+    static const size_t kMaxAlerts = 16;
+
+    struct Alert {
+        uint64_t seq;
+        AlertKind kind;
+        int32_t day;
+        uint32_t categoryId;
+        int64_t amount;
+        int64_t expected;
+    };
+
+    // Process-wide; set before ingest starts.
+    static AnomalyOptions& options() {
+        static AnomalyOptions o;
+        return o;
+    }
+
+    // Feeds one row; only expenses count. With raise false the statistics
+    // are updated but no alert is recorded (history replay).
+    void observe(int32_t day, int32_t monthKey, uint32_t categoryId, int64_t cents, bool income,
+                 bool raise = true) {
+        const AnomalyOptions& o = options();
+        if (income || !o.enabled) return;
+        observeMonth(day, monthKey, categoryId, cents, raise, o);
+        if (cents <= 0) return;
+        Stats& stats = slot(categoryId);
+        double x = (double)cents;
+        if (raise && stats.samples >= o.minSamples && x > stats.mean * o.minRatio) {
+            double over = x - stats.mean;
+            if (over * over > o.zScore * o.zScore * stats.variance)
+                record(AlertKind::OutlierExpense, day, categoryId, cents, llround(stats.mean));
+        }
+        if (stats.samples++ == 0) {
+            stats.mean = x;
+        } else {
+            double diff = x - stats.mean, step = o.alpha * diff;
+            stats.mean += step;
+            stats.variance = (1 - o.alpha) * (stats.variance + diff * step);
+        }
+    }
+
+    void clear() { *this = SpendingMonitor(); }
+
+    // Alerts with seq > after still held, oldest first.
+    void alertsAfter(uint64_t after, vector<Alert>& out) const {
+        uint64_t first = max(after + 1, raised > kMaxAlerts ? raised - kMaxAlerts + 1 : 1);
+        for (uint64_t seq = first; seq <= raised; seq++) out.push_back(alerts[(seq - 1) % kMaxAlerts]);
+    }
+
+    uint64_t lastAlert() const { return raised; }
+
+private:
+    struct Stats {
+        uint32_t categoryId;
+        uint32_t samples = 0;
+        uint64_t lastUse = 0;
+        double mean = 0;
+        double variance = 0;
+    };
+    vector<Stats> categories;           // at most kMaxCategories, searched linearly
+    uint64_t uses = 0;
+    vector<Alert> alerts;               // ring of the last kMaxAlerts
+    uint64_t raised = 0;
+    int32_t month = -1;                 // newest month seen; older rows skip the pace check
+    int64_t monthExpense = 0;
+    bool paceRaised = false;
+    uint32_t closedMonths = 0;
+    double usualMonth = 0;
+
+    Stats& slot(uint32_t categoryId) {
+        uses++;
+        Stats* oldest = nullptr;
+        for (Stats& s : categories) {
+            if (s.categoryId == categoryId) {
+                s.lastUse = uses;
+                return s;
+            }
+            if (!oldest || s.lastUse < oldest->lastUse) oldest = &s;
+        }
+        if (categories.size() < kMaxCategories) {
+            categories.push_back(Stats());
+            oldest = &categories.back();
+        }
+        *oldest = Stats();
+        oldest->categoryId = categoryId;
+        oldest->lastUse = uses;
+        return *oldest;
+    }
+
+    void observeMonth(int32_t day, int32_t monthKey, uint32_t categoryId, int64_t cents,
+                      bool raise, const AnomalyOptions& o) {
+        if (monthKey < month) return;
+        if (monthKey > month) {
+            if (month >= 0) {
+                usualMonth = closedMonths++ == 0 ? (double)monthExpense
+                                                 : usualMonth + o.monthAlpha * (monthExpense - usualMonth);
+            }
+            month = monthKey;
+            monthExpense = 0;
+            paceRaised = false;
+        }
+        monthExpense += cents;
+        if (!raise || paceRaised || closedMonths < o.minMonths || usualMonth <= 0) return;
+        int y, m, d;
+        civilFromDays(day, y, m, d);
+        double limit = o.paceFactor * usualMonth;
+        double projected = d >= o.paceFromDay ? (double)monthExpense * daysInMonth(y, m) / d
+                                              : (double)monthExpense;
+        if (projected > limit) {
+            paceRaised = true;
+            record(AlertKind::OverspendPace, day, categoryId, llround(projected), llround(usualMonth));
+        }
+    }
+
+    void record(AlertKind kind, int32_t day, uint32_t categoryId, int64_t amount, int64_t expected) {
+        Alert alert{++raised, kind, day, categoryId, amount, expected};
+        if (alerts.size() < kMaxAlerts) alerts.push_back(alert);
+        else alerts[(alert.seq - 1) % kMaxAlerts] = alert;
+    }
+};
+
+// ================= Spending Forecast =================
+// Holt's linear exponential smoothing (level plus trend) over closed month
+// totals: income, and expense per category (projected expense is the sum
+// of its categories, so the two always agree). Each User keeps one
+// fitted model and folds months in as they close; rows landing in a month
+// already folded refit it from the month rollups, not from transactions.
+struct HoltSeries {
+    double level = 0;
+    double trend = 0;
+    uint32_t samples = 0;
+
+    void add(double x, double alpha, double beta) {
+        if (samples++ == 0) {
+            level = x;
+        } else if (samples == 2) {
+            trend = x - level;
+            level = x;
+        } else {
+            double previous = level;
+            level = alpha * x + (1 - alpha) * (level + trend);
+            trend = beta * (level - previous) + (1 - beta) * trend;
+        }
+    }
+
+    // The month `ahead` months after the last one added; never negative.
+    double project(int ahead) const { return max(0.0, level + ahead * trend); }
+};
+
+struct ForecastModel {
+    static constexpr double kAlpha = 0.5;   // level smoothing
+    static constexpr double kBeta = 0.2;    // trend smoothing
+
+    int32_t through = -1;                   // last month folded in
+    uint32_t months = 0;
+    HoltSeries income;
+    vector<uint32_t> categoryIds;           // ascending, parallel to categories
+    vector<HoltSeries> categories;          // from each category's first expense
+
+    // Folds in one closed month; byCategory is expense by category ID.
+    void fold(int32_t monthKey, int64_t in, const vector<int64_t>& byCategory) {
+        for (uint32_t id = 0; id < byCategory.size(); id++) {
+            if (byCategory[id] == 0 || binary_search(categoryIds.begin(), categoryIds.end(), id)) continue;
+            size_t at = lower_bound(categoryIds.begin(), categoryIds.end(), id) - categoryIds.begin();
+            categoryIds.insert(categoryIds.begin() + at, id);
+            categories.insert(categories.begin() + at, HoltSeries());
+        }
+        income.add((double)in, kAlpha, kBeta);
+        for (size_t i = 0; i < categoryIds.size(); i++) {
+            uint32_t id = categoryIds[i];
+            categories[i].add(id < byCategory.size() ? (double)byCategory[id] : 0.0, kAlpha, kBeta);
+        }
+        through = monthKey;
+        months++;
+    }
+};
+
+// ================= Ledger Versions =================
+// One published state of a user's ledger. Version N is the ledger after N
+// edits, deletes and undos, as it stood when the next one began (rows
+// appended in between included). It shares the rollup and tombstones with
+// the live ledger copy-on-write, so publishing one is O(1) and month
+// queries on it take no lock while writers continue.
+//
+// The same structure, with `log` set, is the user's read view: the state
+// after the last completed write, which queries read instead of taking
+// the user's lock (see User::view). Only read views carry the alerts.
+struct LedgerVersion {
+    uint64_t number = 0;
+    uint32_t currency = Money::kUSD;
+    uint64_t layout = 0;                    // User::layout it was taken under
+    size_t rows = 0;                        // open-ledger rows, deleted ones included
+    RowSet dead;                            // open-ledger row numbers
+    MonthRollup rollup;                     // open months
+    vector<const SealedLedger*> sealed;     // live for as long as the user
+    shared_ptr<const Ledger> log;           // read views only; pins the ledger
+    uint64_t writes = 0;                    // read views: User::writes it reflects
+    shared_ptr<const vector<SpendingMonitor::Alert>> alerts;   // read views: oldest first
+
+    size_t transactionCount() const {
+        size_t count = rows - dead.size();
+        for (const SealedLedger* segment : sealed) count += segment->size();
+        return count;
+    }
+
+    // Every month with rows, open or sealed, oldest first.
+    vector<int32_t> monthKeys() const {
+        vector<int32_t> keys;
+        rollup.forEach([&](int32_t key, const MonthTotals&) { keys.push_back(key); });
+        for (const SealedLedger* segment : sealed) {
+            for (size_t m = 0; m < segment->monthCount(); m++) keys.push_back(segment->monthKeyAt(m));
+        }
+        sort(keys.begin(), keys.end());
+        keys.erase(unique(keys.begin(), keys.end()), keys.end());
+        return keys;
+    }
+
+    // The listing, sealed rows first, with open rows read from ledger:
+    // `log`, or for an older version the current one if no sealing has
+    // renumbered rows since.
+    void listRows(const Ledger& ledger, vector<TransactionRow>& out) const {
+        size_t row = 0;
+        for (const SealedLedger* segment : sealed)
+            appendRows(*segment, segment->size(), nullptr, row, out);
+        appendRows(ledger, rows, &dead, row, out);
+    }
+
+    MonthSummary summarizeMonth(int32_t monthKey) const {
+        MonthSummary result;
+        result.monthKey = monthKey;
+        sumMonth(monthKey, result.income, result.expense, nullptr);
+        return result;
+    }
+
+    CategoryBreakdown categoryBreakdown(int32_t monthKey) const {
+        Money income, expense;
+        vector<int64_t> byCategory;
+        sumMonth(monthKey, income, expense, &byCategory);
+        CategoryBreakdown result;
+        result.monthKey = monthKey;
+        for (uint32_t id : CategoryDictionary::instance().sortedByName(byCategory))
+            result.expenses.push_back(CategoryAmount{id, Money(byCategory[id], currency)});
+        return result;
+    }
+
+    void sumMonth(int32_t key, Money& income, Money& expense, vector<int64_t>* byCategory) const {
+        int64_t in = 0, out = 0;
+        if (byCategory) byCategory->clear();
+        if (const MonthTotals* totals = rollup.find(key)) {
+            in = totals->income;
+            out = totals->expense;
+            if (byCategory) addCells(totals->expenseByCategory, *byCategory);
+        }
+        for (const SealedLedger* segment : sealed) segment->addMonth(key, in, out, byCategory);
+        income = Money(in, currency);
+        expense = Money(out, currency);
+    }
+
+    // Totals of rows dated within [fromDay, toDay]: the rollup for open
+    // months, prefix sums for sealed ones.
+    DayTotals sumRange(int32_t fromDay, int32_t toDay) const {
+        DayTotals t = rollup.sumRange(fromDay, toDay);
+        for (const SealedLedger* segment : sealed) {
+            DayTotals s = segment->sumRange(fromDay, toDay);
+            t.income += s.income;
+            t.expense += s.expense;
+        }
+        return t;
+    }
+
+private:
+    // Rows [0, count), numbered from `row` on, leaving out those in dead.
+    template <class Rows>
+    void appendRows(const Rows& source, size_t count, const RowSet* dead, size_t& row,
+                    vector<TransactionRow>& out) const {
+        for (size_t i = 0; i < count; i++, row++) {
+            if (dead && dead->contains(i)) continue;
+            out.push_back(TransactionRow{source.dayAt(i), Money(source.centsAt(i), currency),
+                                         source.categoryAt(i), source.isIncome(i),
+                                         source.descriptionAt(i), row});
+        }
+    }
+};
+
+// ================= Password Hashing =================
+// Buffered reads from the OS CSPRNG: getrandom on Linux, /dev/urandom on
+// other POSIX systems and random_device (backed by the system RNG) on
+// Windows. fill() returns false if the source fails; callers fail closed.
+class SecureRandom {
+    mutex lock;
+    unsigned char pool[4096];
+    size_t used = sizeof pool;
+
+    bool refill() {
+#if defined(__linux__)
+        size_t got = 0;
+        while (got < sizeof pool) {
+            ssize_t n = getrandom(pool + got, sizeof pool - got, 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            got += (size_t)n;
+        }
+#elif defined(_WIN32)
+        random_device rd;
+        for (size_t i = 0; i < sizeof pool; i += 4) {
+            uint32_t v = rd();
+            memcpy(pool + i, &v, 4);
+        }
+#else
+        FILE* f = fopen("/dev/urandom", "rb");
+        bool ok = f && fread(pool, 1, sizeof pool, f) == sizeof pool;
+        if (f) fclose(f);
+        if (!ok) return false;
+#endif
+        used = 0;
+        return true;
+    }
+
+public:
+    static SecureRandom& instance() {
+        static SecureRandom source;
+        return source;
+    }
+
+    bool fill(void* out, size_t n) {
+        lock_guard<mutex> guard(lock);
+        unsigned char* p = static_cast<unsigned char*>(out);
+        while (n) {
+            if (used == sizeof pool && !refill()) return false;
+            size_t take = min(n, sizeof pool - used);
+            memcpy(p, pool + used, take);
+            // Bytes handed out are wiped so the pool never holds a live token.
+            memset(pool + used, 0, take);
+            used += take;
+            p += take;
+            n -= take;
+        }
+        return true;
+    }
+};
+
+class Sha256 {
+    uint32_t h[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                     0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    unsigned char block[64];
+    size_t used = 0;
+    uint64_t total = 0;
+
+    static uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+    void compress(const unsigned char* p) {
+        static const uint32_t k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++)
+            w[i] = uint32_t(p[4 * i]) << 24 | uint32_t(p[4 * i + 1]) << 16 | uint32_t(p[4 * i + 2]) << 8 | p[4 * i + 3];
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+        for (int i = 0; i < 64; i++) {
+            uint32_t t1 = hh + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            hh = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+        h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
+    }
+
+public:
+    static const size_t kDigestSize = 32;
+
+    void update(const void* data, size_t n) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        total += n;
+        while (n) {
+            size_t take = min(n, sizeof block - used);
+            memcpy(block + used, p, take);
+            used += take;
+            p += take;
+            n -= take;
+            if (used == sizeof block) {
+                compress(block);
+                used = 0;
+            }
+        }
+    }
+
+    void finish(unsigned char out[kDigestSize]) {
+        uint64_t bits = total * 8;
+        block[used++] = 0x80;
+        if (used > 56) {
+            memset(block + used, 0, sizeof block - used);
+            compress(block);
+            used = 0;
+        }
+        memset(block + used, 0, 56 - used);
+        for (int i = 0; i < 8; i++) block[56 + i] = (unsigned char)(bits >> (56 - 8 * i));
+        compress(block);
+        for (int i = 0; i < 8; i++) {
+            out[4 * i] = (unsigned char)(h[i] >> 24);
+            out[4 * i + 1] = (unsigned char)(h[i] >> 16);
+            out[4 * i + 2] = (unsigned char)(h[i] >> 8);
+            out[4 * i + 3] = (unsigned char)h[i];
+        }
+    }
+};
+
+// A stored credential: PBKDF2-HMAC-SHA256 of the password under a random
+// per-user salt. Users, the WAL and snapshots keep only this; encode() is
+// its on-disk form (iterations, salt, digest).
+class PasswordHash {
+public:
+    static const size_t kSaltSize = 16;
+    static const uint32_t kDefaultIterations = 100000;
+
+    // Returns false if no salt could be drawn.
+    static bool derive(const string& password, uint32_t iterations, PasswordHash& out) {
+        out.iterations = iterations;
+        if (!SecureRandom::instance().fill(out.salt, kSaltSize)) return false;
+        pbkdf2(password, out.salt, iterations, out.digest);
+        return true;
+    }
+
+    // Compares digests in constant time.
+    bool matches(const string& password) const {
+        if (iterations == 0) return false;
+        unsigned char candidate[Sha256::kDigestSize];
+        pbkdf2(password, salt, iterations, candidate);
+        unsigned char diff = 0;
+        for (size_t i = 0; i < sizeof candidate; i++) diff |= candidate[i] ^ digest[i];
+        return diff == 0;
+    }
+
+    string encode() const {
+        string out(4 + kSaltSize + Sha256::kDigestSize, '\0');
+        memcpy(&out[0], &iterations, 4);
+        memcpy(&out[4], salt, kSaltSize);
+        memcpy(&out[4 + kSaltSize], digest, Sha256::kDigestSize);
+        return out;
+    }
+
+    static bool decode(const string& text, PasswordHash& out) {
+        if (text.size() != 4 + kSaltSize + Sha256::kDigestSize) return false;
+        memcpy(&out.iterations, &text[0], 4);
+        memcpy(out.salt, &text[4], kSaltSize);
+        memcpy(out.digest, &text[4 + kSaltSize], Sha256::kDigestSize);
+        return out.iterations != 0;
+    }
+
+private:
+    uint32_t iterations = 0;                    // 0: matches nothing
+    unsigned char salt[kSaltSize] = {};
+    unsigned char digest[Sha256::kDigestSize] = {};
+
+    // One output block (dkLen == hLen). The keyed inner and outer states
+    // are computed once and copied for every HMAC.
+    static void pbkdf2(const string& password, const unsigned char* salt, uint32_t iterations,
+                       unsigned char out[Sha256::kDigestSize]) {
+        unsigned char key[64] = {};
+        if (password.size() > sizeof key) {
+            Sha256 k;
+            k.update(password.data(), password.size());
+            k.finish(key);
+        } else {
+            memcpy(key, password.data(), password.size());
+        }
+        unsigned char pad[64];
+        Sha256 inner, outer;
+        for (int i = 0; i < 64; i++) pad[i] = key[i] ^ 0x36;
+        inner.update(pad, 64);
+        for (int i = 0; i < 64; i++) pad[i] = key[i] ^ 0x5c;
+        outer.update(pad, 64);
+
+        auto hmac = [&](const unsigned char* a, size_t an, const unsigned char* b, size_t bn,
+                        unsigned char mac[Sha256::kDigestSize]) {
+            Sha256 in = inner, o = outer;
+            in.update(a, an);
+            in.update(b, bn);
+            in.finish(mac);
+            o.update(mac, Sha256::kDigestSize);
+            o.finish(mac);
+        };
+        static const unsigned char blockIndex[4] = {0, 0, 0, 1};
+        unsigned char u[Sha256::kDigestSize];
+        hmac(salt, kSaltSize, blockIndex, 4, u);
+        memcpy(out, u, sizeof u);
+        for (uint32_t i = 1; i < iterations; i++) {
+            hmac(u, sizeof u, nullptr, 0, u);
+            for (size_t j = 0; j < sizeof u; j++) out[j] ^= u[j];
+        }
+    }
+};
+
+// ================= User Class =================
+class User {
+    string username;
+    PasswordHash password;
+    uint32_t currency;                          // every amount is in this currency
+    shared_ptr<Ledger> ledger = make_shared<Ledger>();  // open months, append-only
+    MonthRollup rollup;                         // covers `ledger` only
+    vector<unique_ptr<SealedLedger>> sealed;    // closed months, memory-mapped
+    mutable shared_mutex lock;   // writers exclusive, queries shared
+
+    // Read view (a LedgerVersion with `log`), replaced atomically at the
+    // end of every write. Readers pin what they load and take no lock;
+    // sealing or a reload replaces `ledger` rather than changing it, so a
+    // pinned view stays readable.
+    shared_ptr<const LedgerVersion> published;
+    shared_ptr<LedgerVersion> current;  // `published`, writable once no reader holds it
+    shared_ptr<LedgerVersion> spareView;    // the view before it, reused the same way
+    uint64_t writes = 0;                // publications so far
+    shared_ptr<const vector<SpendingMonitor::Alert>> alerts;    // null once the monitor changes them
+
+    // Edits and deletes. A deleted row stays in the ledger, so row numbers
+    // never shift, and is tombstoned in `dead`; an edit deletes the row and
+    // appends its replacement. Each change first publishes the state before
+    // it to `versions`. Sealing drops deleted rows and renumbers the rest
+    // (bumping `layout`), which also ends what undo can reach. Versions and
+    // the undo stack are kept in memory only.
+    RowSet dead;                                        // open-ledger row numbers
+    struct Change {
+        size_t removed;                                 // open-ledger row numbers
+        size_t added;                                   // kNoRow for a delete
+    };
+    static const size_t kNoRow = SIZE_MAX;
+    deque<Change> undoStack;                            // newest last
+    static const size_t kMaxUndo = 1024;                // older changes can't be undone
+    deque<shared_ptr<const LedgerVersion>> versions;    // consecutive numbers, oldest first
+    static const size_t kMaxVersions = 1024;
+    uint64_t changes = 0;                               // the current version's number
+    uint64_t layout = 0;
+
+    // Listing indexes: row numbers (sealed rows first) sorted by (key, row).
+    // Page queries bring them up to the read view, writers never touch
+    // them: rows appended since are sorted and merged in, rows deleted or
+    // restored since (found by comparing tombstone sets) are removed or
+    // reinserted in place, and a new layout (sealing renumbers rows)
+    // rebuilds.
+    struct RowIndex {
+        vector<uint32_t> rows;      // deleted rows left out; all below kMaxRows
+        vector<int64_t> keys;       // parallel to rows
+        size_t through = 0;         // row numbers below this are in
+        uint64_t layout = UINT64_MAX;   // LedgerVersion::layout it follows
+        RowSet dead;                // the tombstones it reflects
+
+        // Where (key, row) is or would go.
+        size_t position(int64_t key, uint32_t row) const {
+            size_t lo = 0, hi = rows.size();
+            while (lo < hi) {
+                size_t mid = (lo + hi) / 2;
+                if (keys[mid] != key ? keys[mid] < key : rows[mid] < row) lo = mid + 1;
+                else hi = mid;
+            }
+            return lo;
+        }
+    };
+    mutable RowIndex orderIndex[2];     // by RowOrder
+    mutable mutex orderLock;
+
+    // Months whose totals writes have changed, for the advice cache and
+    // the forecast model. A write collects its months in `staged` and
+    // hands them to `changed` once its view is published, so a reader that
+    // takes them and then loads the view sees them. changedLock is held
+    // only for the hand-over and the take, never while advice or a
+    // forecast is computed. Sealing moves rows without changing any
+    // month's totals, so it changes nothing here.
+    struct MonthChanges {
+        vector<int32_t> months;         // runs collapsed
+        bool rebuild = false;           // advice: every month is stale
+        int32_t earliest = INT32_MAX;   // forecast: refit from here
+    };
+    static const size_t kMaxChangedMonths = 4096;   // past this, rebuild instead
+    MonthChanges staged;                            // under the exclusive lock
+    mutable MonthChanges changed{{}, true, INT32_MAX};
+    mutable mutex changedLock;
+
+    // Advice per month under one AdviceProgram, from the read view. An
+    // advice query takes the changed months, drops the cached months whose
+    // windows reach them and keeps them pending for refreshAdvice.
+    struct AdviceCache {
+        uint64_t version = 0;                           // program the months came from
+        unordered_map<int32_t, Recommendations> months;
+        set<int32_t> pending;                           // stale since the last refresh
+    };
+    mutable AdviceCache advice;
+    mutable mutex adviceLock;
+    atomic<bool> adviceQueued{false};
+
+    // Fed by every append under the exclusive lock. A reload only marks
+    // it stale; the next append replays sealed rows, then the ledger.
+    SpendingMonitor monitor;
+    bool monitorStale = false;
+    bool replaying = false;             // WAL replay: rows update statistics only
+
+    // Fitted, from the read view, through the month before the last
+    // forecast's; a forecast refits when a changed month has been folded.
+    mutable ForecastModel forecastModel;
+    mutable mutex forecastLock;
+
+    friend class Storage;
+public:
+    User(string u, const PasswordHash& p, uint32_t currencyCode = Money::kUSD)
+        : username(u), password(p), currency(currencyCode) {
+        publishViewLocked();
+    }
+
+    string getUsername() const { return username; }
+    uint32_t getCurrency() const { return currency; }
+    bool checkPassword(const string& p) const { return password.matches(p); }
+
+    // Set while FinanceTracker holds this user in its advice refresh queue;
+    // markAdviceQueued() is true only for the call that sets it.
+    bool markAdviceQueued() { return !adviceQueued.exchange(true); }
+    void clearAdviceQueued() { adviceQueued.store(false); }
+
+    // Row numbers (sealed rows first, deleted rows included) are 32-bit in
+    // the listing indexes, page cursors, sealed files and snapshots, so a
+    // user holds at most kMaxRows; appends and edits past it are refused.
+    static const size_t kMaxRows = UINT32_MAX;
+
+    // Takes ownership of t; the row is copied into the ledger. Returns
+    // false (and stores nothing) if its date is malformed, its amount is
+    // not in this user's currency or the user already has kMaxRows rows.
+    bool addTransaction(Transaction* t) {
+        bool ok = t->hasValidDate() && t->getAmount().currencyCode() == currency;
+        uint32_t categoryId = ok ? CategoryDictionary::instance().intern(t->getCategory())
+                                 : CategoryDictionary::kNoId;
+        ok = categoryId != CategoryDictionary::kNoId &&
+             appendRow(t->getDay(), t->getAmount().minorUnits(), categoryId, t->getDescription(),
+                       t->getType() == "Income");
+        delete t;
+        return ok;
+    }
+
+    bool addTransaction(const string& date, double amount, const string& category,
+                        const string& desc, bool income) {
+        int32_t day = packDate(date);
+        uint32_t categoryId = CategoryDictionary::instance().intern(category);
+        if (day == kInvalidDay || categoryId == CategoryDictionary::kNoId) return false;
+        return appendRow(day, Money::fromMajor(amount).minorUnits(), categoryId, desc, income);
+    }
+
+    // day must be a valid packed date. False if the user has kMaxRows rows.
+    bool appendRow(int32_t day, int64_t cents, uint32_t categoryId, const string& desc,
+                   bool income) {
+        return appendRow(day, cents, categoryId, desc, income, [] {});
+    }
+
+    // logged() runs under the exclusive lock just before the row is added,
+    // so the WAL holds a user's rows in row-number order (edits name rows
+    // by number). A refused row is not logged.
+    template <class Logged>
+    bool appendRow(int32_t day, int64_t cents, uint32_t categoryId, const string& desc,
+                   bool income, Logged logged) {
+        unique_lock<shared_mutex> guard(lock);
+        if (!roomLocked(1)) return false;
+        logged();
+        appendLocked(day, cents, categoryId, desc, income);
+        publishViewLocked();
+        return true;
+    }
+
+    // Appends a parsed batch under a single lock acquisition; false,
+    // appending none of it, if it would take the user past kMaxRows.
+    bool appendBatch(const ImportBatch& batch) { return appendBatch(batch, [] {}); }
+
+    template <class Logged> bool appendBatch(const ImportBatch& batch, Logged logged) {
+        unique_lock<shared_mutex> guard(lock);
+        if (!roomLocked(batch.size())) return false;
+        logged();
+        if (monitorStale) replayMonitor();
+        for (size_t i = 0; i < batch.size(); i++) {
+            size_t len;
+            const char* desc = batch.descriptionData(i, len);
+            ledger->append(batch.days[i], batch.cents[i], batch.categories[i], desc, len,
+                          batch.income[i] != 0);
+            int32_t monthKey = ledger->monthKeyAt(ledger->size() - 1);
+            rollup.add(batch.days[i], batch.categories[i], batch.income[i] != 0, batch.cents[i]);
+            noteMonthChanged(monthKey);
+            monitor.observe(batch.days[i], monthKey, batch.categories[i], batch.cents[i],
+                            batch.income[i] != 0, !replaying);
+        }
+        publishViewLocked();
+        return true;
+    }
+
+    // Replaces the ledger wholesale (snapshot load), deleted rows given by
+    // number, and rebuilds the rollup.
+    void adoptLedger(Ledger loaded, const vector<uint64_t>& deleted = {}) {
+        unique_lock<shared_mutex> guard(lock);
+        ledger = make_shared<Ledger>(move(loaded));
+        dead.clear();
+        for (uint64_t row : deleted) {
+            if (row < ledger->size()) dead.insert(row);
+        }
+        rollup.clear();
+        ledger->forEachRow([&](size_t row, int32_t day, int32_t, int64_t cents,
+                              uint32_t category, bool income) {
+            if (!dead.contains(row)) rollup.add(day, category, income, cents);
+        });
+        forgetHistoryLocked();
+        monitorStale = true;
+        publishViewLocked();
+    }
+
+    // Moves every row dated before monthKey into a sealed file at path,
+    // leaving only later (open) months in the mutable ledger. Deleted rows
+    // are dropped. False if path is one of this user's sealed files.
+    bool sealBefore(int32_t monthKey, const string& path) {
+        unique_lock<shared_mutex> guard(lock);
+        error_code ec;
+        for (auto& segment : sealed) {
+            if (segment->path() == path || filesystem::equivalent(segment->path(), path, ec))
+                return false;
+        }
+        vector<uint32_t> closed, open;      // below kMaxRows
+        for (size_t i = 0; i < ledger->size(); i++) {
+            if (!dead.contains(i)) (ledger->monthKeyAt(i) < monthKey ? closed : open).push_back(i);
+        }
+        if (closed.empty()) return true;
+        stable_sort(closed.begin(), closed.end(),
+                    [&](uint32_t a, uint32_t b) { return ledger->dayAt(a) < ledger->dayAt(b); });
+
+        unique_ptr<SealedLedger> segment(new SealedLedger());
+        if (!SealedLedger::write(path, *ledger, closed)) return false;
+        if (!segment->open(path)) {
+            filesystem::remove(path, ec);
+            return false;
+        }
+
+        shared_ptr<Ledger> remaining = make_shared<Ledger>();
+        for (uint32_t i : open) {
+            remaining->append(ledger->dayAt(i), ledger->centsAt(i), ledger->categoryAt(i),
+                             ledger->descriptionAt(i), ledger->isIncome(i));
+        }
+        for (uint32_t i : closed) {
+            rollup.remove(ledger->dayAt(i), ledger->categoryAt(i), ledger->isIncome(i),
+                          ledger->centsAt(i));
+        }
+        dead.clear();
+        ledger = move(remaining);
+        undoStack.clear();
+        layout++;
+        sealed.push_back(move(segment));
+        publishViewLocked();
+        return true;
+    }
+
+    // Maps an existing sealed file (e.g. listed in a snapshot); false if
+    // its rows would take the user past kMaxRows.
+    bool attachSealed(const string& path) {
+        unique_ptr<SealedLedger> segment(new SealedLedger());
+        if (!segment->open(path)) return false;
+        unique_lock<shared_mutex> guard(lock);
+        if (!roomLocked(segment->size())) return false;
+        sealed.push_back(move(segment));
+        monitorStale = true;
+        forgetHistoryLocked();
+        publishViewLocked();
+        return true;
+    }
+
+    // Rebuilds the rollup from the ledger and reports any cell where the
+    // incrementally maintained copy disagrees. Empty result == consistent.
+    vector<string> verifyRollup() const {
+        shared_lock<shared_mutex> guard(lock);
+        MonthRollup rebuilt;
+        for (size_t i = 0; i < ledger->size(); i++) {
+            if (dead.contains(i)) continue;
+            rebuilt.add(ledger->dayAt(i), ledger->categoryAt(i), ledger->isIncome(i),
+                        ledger->centsAt(i));
+        }
+        return MonthRollup::diff(rebuilt, rollup);
+    }
+
+    // Paths of sealed files whose rows fail SealedLedger::verify. Empty
+    // result == all intact.
+    vector<string> verifySealed() const {
+        shared_lock<shared_mutex> guard(lock);
+        vector<string> bad;
+        for (auto& segment : sealed)
+            if (!segment->verify()) bad.push_back(segment->path());
+        return bad;
+    }
+
+    // The state as of the last completed write. Queries read it (counts,
+    // listings, month and range totals, alerts, forecasts, advice, pages)
+    // without taking the user's lock.
+    shared_ptr<const LedgerVersion> view() const { return atomic_load(&published); }
+
+    // Sealed rows first (oldest segment first), then the mutable ledger;
+    // deleted rows are not counted.
+    size_t getTransactionCount() const { return view()->transactionCount(); }
+
+    vector<TransactionRow> listTransactions() const {
+        shared_ptr<const LedgerVersion> v = view();
+        vector<TransactionRow> result;
+        result.reserve(v->rows);
+        v->listRows(*v->log, result);
+        return result;
+    }
+
+    // Row numbers are the listing's (TransactionRow::row): sealed rows
+    // first, then the open ledger, a deleted row keeping its number. Only
+    // open rows can change. logged() runs under the exclusive lock once the
+    // change is known to apply. False if the row is sealed, deleted or
+    // past the end.
+    template <class Logged> bool deleteRow(uint64_t row, Logged logged) {
+        unique_lock<shared_mutex> guard(lock);
+        size_t i;
+        if (!openRowLocked(row, i)) return false;
+        logged();
+        publishLocked();
+        setDeletedLocked(i, true);
+        pushUndoLocked(Change{i, kNoRow});
+        publishViewLocked();
+        return true;
+    }
+
+    // Deletes row and appends its replacement, which gets a new number.
+    // day must be a valid packed date. Also false at kMaxRows.
+    template <class Logged>
+    bool editRow(uint64_t row, int32_t day, int64_t cents, uint32_t categoryId, const string& desc,
+                 bool income, Logged logged) {
+        unique_lock<shared_mutex> guard(lock);
+        size_t i;
+        if (!openRowLocked(row, i) || !roomLocked(1)) return false;
+        logged();
+        publishLocked();
+        setDeletedLocked(i, true);
+        appendLocked(day, cents, categoryId, desc, income);
+        pushUndoLocked(Change{i, ledger->size() - 1});
+        publishViewLocked();
+        return true;
+    }
+
+    // Reverts the newest change not yet undone, as a change of its own:
+    // the deleted row comes back and an edit's replacement is deleted.
+    // logged(restored, removed) gets the row numbers for restoreRows;
+    // removed is UINT64_MAX when undoing a delete. False if there is
+    // nothing to undo.
+    template <class Logged> bool undo(Logged logged) {
+        unique_lock<shared_mutex> guard(lock);
+        if (undoStack.empty()) return false;
+        Change change = undoStack.back();
+        undoStack.pop_back();
+        size_t base = sealedRowsLocked();
+        logged(base + change.removed, change.added == kNoRow ? UINT64_MAX : base + change.added);
+        revertLocked(change);
+        return true;
+    }
+
+    // Replays an undo logged as (restored, removed).
+    bool restoreRows(uint64_t restored, uint64_t removed) {
+        unique_lock<shared_mutex> guard(lock);
+        size_t base = sealedRowsLocked(), i = restored - base, j = removed - base;
+        if (restored < base || i >= ledger->size() || !dead.contains(i)) return false;
+        bool remove = removed != UINT64_MAX;
+        if (remove && (removed < base || j >= ledger->size() || dead.contains(j) || j == i))
+            return false;
+        Change change{i, remove ? j : kNoRow};
+        if (!undoStack.empty() && undoStack.back().removed == change.removed &&
+            undoStack.back().added == change.added)
+            undoStack.pop_back();
+        revertLocked(change);
+        return true;
+    }
+
+    // The current version's number: edits, deletes and undos so far.
+    uint64_t currentVersion() const { return view()->number; }
+
+    // Version n, the current one included; null if it is newer than the
+    // current one or older than the kMaxVersions kept. A version holds its
+    // totals however far the ledger moves on.
+    shared_ptr<const LedgerVersion> version(uint64_t n) const {
+        shared_lock<shared_mutex> guard(lock);
+        if (n == changes) return snapshotLocked();
+        if (n > changes || versions.empty() || n < versions.front()->number) return nullptr;
+        return versions[n - versions.front()->number];
+    }
+
+    // The listing as of version n; false if it is not held or sealing has
+    // renumbered rows since.
+    bool listVersion(uint64_t n, vector<TransactionRow>& out) const {
+        shared_ptr<const LedgerVersion> v = version(n), current = view();
+        if (!v || v->layout != current->layout) return false;
+        out.clear();
+        v->listRows(*current->log, out);
+        return true;
+    }
+
+    // Formats one page of the listing into buf (no per-row allocation).
+    // Stops early, with result.more set, if the next row would not fit.
+    void formatPage(const PageRequest& request, char* buf, size_t cap, PageResult& result) const {
+        walkPage(request, result, [&](const LedgerVersion& v, size_t row, const vector<size_t>& bases) {
+            size_t written = formatRow(v, row, bases, buf + result.bytes, cap - result.bytes);
+            result.bytes += written;
+            return written != 0;
+        });
+    }
+
+    // The same page as structured rows; result.bytes stays 0.
+    void pageRows(const PageRequest& request, vector<TransactionRow>& out, PageResult& result) const {
+        walkPage(request, result, [&](const LedgerVersion& v, size_t row, const vector<size_t>& bases) {
+            out.push_back(rowAt(v, row, bases));
+            return true;
+        });
+    }
+
+    // Totals of rows dated within [fromDay, toDay] (see
+    // LedgerVersion::sumRange).
+    void getRangeTotals(int32_t fromDay, int32_t toDay, int64_t& income, int64_t& expense) const {
+        DayTotals t = view()->sumRange(fromDay, toDay);
+        income = t.income;
+        expense = t.expense;
+    }
+
+    RangeSummary summarizeRange(int32_t fromDay, int32_t toDay) const {
+        int64_t income, expense;
+        getRangeTotals(fromDay, toDay, income, expense);
+        RangeSummary result;
+        result.fromDay = fromDay;
+        result.toDay = toDay;
+        result.income = Money(income, currency);
+        result.expense = Money(expense, currency);
+        return result;
+    }
+
+    // Month totals in minor units, open and sealed months alike.
+    void getMonthTotals(int32_t monthKey, int64_t& income, int64_t& expense) const {
+        Money in, out;
+        sumMonth(monthKey, in, out, nullptr);
+        income = in.minorUnits();
+        expense = out.minorUnits();
+    }
+
+    // Adds the open ledger's expense per (month, category) into table.
+    void addExpenseByMonth(unordered_map<int32_t, vector<int64_t>>& table) const {
+        view()->rollup.forEach([&](int32_t key, const MonthTotals& totals) {
+            addCells(totals.expenseByCategory, table[key]);
+        });
+    }
+
+    // Sealed segments are immutable and only ever appended, so the
+    // pointers stay valid for as long as the user exists.
+    vector<const SealedLedger*> getSealedSegments() const { return view()->sealed; }
+
+    MonthSummary summarizeMonth(int32_t monthKey) const { return view()->summarizeMonth(monthKey); }
+
+    CategoryBreakdown categoryBreakdown(int32_t monthKey) const {
+        return view()->categoryBreakdown(monthKey);
+    }
+
+    AccountHistory history() const {
+        AccountHistory result;
+        result.username = username;
+        result.currency = currency;
+        shared_ptr<const LedgerVersion> v = view();
+        result.transactions = v->transactionCount();
+
+        const CategoryDictionary& dict = CategoryDictionary::instance();
+        vector<int64_t> byCategory;
+        for (int32_t key : v->monthKeys()) {
+            MonthActivity month;
+            month.summary.monthKey = key;
+            v->sumMonth(key, month.summary.income, month.summary.expense, &byCategory);
+            for (uint32_t id : dict.sortedByName(byCategory))
+                month.expenses.push_back(CategoryAmount{id, Money(byCategory[id], currency)});
+            result.months.push_back(move(month));
+        }
+        return result;
+    }
+
+    // Spending Monitor alerts with seq > after that are still held.
+    vector<SpendingAlert> spendingAlerts(uint64_t after = 0) const {
+        shared_ptr<const LedgerVersion> v = view();
+        vector<SpendingAlert> result;
+        for (auto& a : *v->alerts) {
+            if (a.seq <= after) continue;
+            result.push_back(SpendingAlert{a.seq, a.kind, a.day, a.categoryId, Money(a.amount, currency),
+                                           Money(a.expected, currency)});
+        }
+        return result;
+    }
+
+    // Sequence number of the newest alert (0 if none yet).
+    uint64_t lastSpendingAlert() const {
+        shared_ptr<const LedgerVersion> v = view();
+        return v->alerts->empty() ? 0 : v->alerts->back().seq;
+    }
+
+    // Projects asOf's month and the next quarter from the cached model,
+    // first folding in any months closed since the last forecast.
+    SpendingForecast forecast(int32_t asOfDay) const {
+        SpendingForecast result;
+        result.asOfDay = asOfDay;
+        result.monthKey = monthKeyOfDay(asOfDay);
+        if (result.monthKey < 0) return result;
+        int y, m, d;
+        civilFromDays(asOfDay, y, m, d);
+        double left = (double)(daysInMonth(y, m) - d) / daysInMonth(y, m);
+
+        lock_guard<mutex> l(forecastLock);
+        int32_t changedFrom;
+        {
+            lock_guard<mutex> c(changedLock);
+            changedFrom = changed.earliest;
+            changed.earliest = INT32_MAX;
+        }
+        shared_ptr<const LedgerVersion> v = view();
+        fitForecastLocked(*v, changedFrom, addMonths(result.monthKey, -1));
+        const ForecastModel& model = forecastModel;
+        vector<int64_t> byCategory;
+        v->sumMonth(result.monthKey, result.incomeToDate, result.expenseToDate, &byCategory);
+        auto money = [&](double cents) { return Money(llround(cents), currency); };
+        auto quarter = [](const HoltSeries& series) {
+            return series.project(2) + series.project(3) + series.project(4);
+        };
+        result.monthsFitted = model.months;
+        result.income = result.incomeToDate + money(model.income.project(1) * left);
+        result.nextQuarterIncome = money(quarter(model.income));
+        double restOfMonth = 0, nextQuarter = 0;
+
+        // Categories with a model or with expense this month, by name.
+        vector<int64_t> listed(byCategory.size(), 0);
+        for (size_t id = 0; id < byCategory.size(); id++) listed[id] = byCategory[id] != 0;
+        for (uint32_t id : model.categoryIds) {
+            if (listed.size() <= id) listed.resize(id + 1, 0);
+            listed[id] = 1;
+        }
+        for (uint32_t id : CategoryDictionary::instance().sortedByName(listed)) {
+            CategoryForecast c;
+            c.categoryId = id;
+            c.monthToDate = Money(id < byCategory.size() ? byCategory[id] : 0, currency);
+            c.endOfMonth = c.monthToDate;
+            c.nextQuarter = Money(0, currency);
+            auto it = lower_bound(model.categoryIds.begin(), model.categoryIds.end(), id);
+            if (it != model.categoryIds.end() && *it == id) {
+                const HoltSeries& series = model.categories[it - model.categoryIds.begin()];
+                c.endOfMonth = c.endOfMonth + money(series.project(1) * left);
+                c.nextQuarter = money(quarter(series));
+                restOfMonth += series.project(1) * left;
+                nextQuarter += quarter(series);
+            }
+            result.expenses.push_back(c);
+        }
+        result.expense = result.expenseToDate + money(restOfMonth);
+        result.nextQuarterExpense = money(nextQuarter);
+        return result;
+    }
+
+    // Advice for one month from program, cached until an append touches a
+    // month in one of its windows.
+    Recommendations recommend(int32_t monthKey, const AdviceProgram& program) const {
+        lock_guard<mutex> l(adviceLock);
+        shared_ptr<const LedgerVersion> v = absorbAdviceChangesLocked(program);
+        auto it = advice.months.find(monthKey);
+        if (it == advice.months.end())
+            it = advice.months.emplace(monthKey, evaluateAdvice(*v, monthKey, program)).first;
+        return it->second;
+    }
+
+    // Appends advice for every month made stale since the last call (all
+    // months with rows the first time, after a reload, or under new rules),
+    // oldest first. Returns how many months were appended.
+    size_t refreshAdvice(const AdviceProgram& program, vector<Recommendations>& out) const {
+        lock_guard<mutex> l(adviceLock);
+        shared_ptr<const LedgerVersion> v = absorbAdviceChangesLocked(program);
+        for (int32_t key : advice.pending) {
+            auto it = advice.months.find(key);
+            if (it == advice.months.end())
+                it = advice.months.emplace(key, evaluateAdvice(*v, key, program)).first;
+            out.push_back(it->second);
+        }
+        size_t count = advice.pending.size();
+        advice.pending.clear();
+        return count;
+    }
+
+private:
+    // First row number of each of v's sealed segments, then of its open
+    // ledger.
+    static vector<size_t> segmentBases(const LedgerVersion& v) {
+        vector<size_t> bases;
+        size_t base = 0;
+        for (const SealedLedger* segment : v.sealed) {
+            bases.push_back(base);
+            base += segment->size();
+        }
+        bases.push_back(base);
+        return bases;
+    }
+
+    static int64_t rowKey(const LedgerVersion& v, RowOrder order, size_t row, const vector<size_t>& bases) {
+        size_t s = upper_bound(bases.begin(), bases.end(), row) - bases.begin() - 1;
+        size_t i = row - bases[s];
+        if (s < v.sealed.size())
+            return order == RowOrder::Date ? v.sealed[s]->dayAt(i) : v.sealed[s]->centsAt(i);
+        return order == RowOrder::Date ? v.log->dayAt(i) : v.log->centsAt(i);
+    }
+
+    // Positions the page in the read view and calls emit(view, row, bases)
+    // for each of its rows until the limit or until emit returns false.
+    // orderLock only serializes page queries; the view is loaded under it,
+    // so the indexes only ever move forward.
+    template <class Emit>
+    void walkPage(const PageRequest& request, PageResult& result, Emit emit) const {
+        lock_guard<mutex> l(orderLock);
+        shared_ptr<const LedgerVersion> v = view();
+        const RowIndex& index = refreshIndex(*v, request.order);
+        const vector<uint32_t>& rows = index.rows;
+        const vector<int64_t>& keys = index.keys;
+        size_t n = rows.size();
+        result = PageResult();
+        result.total = n;
+
+        // Position in iteration order (0 = first row shown).
+        size_t start = min(request.offset, n);
+        if (request.hasAfter) {
+            auto less = [&](size_t i, const PageKey& k) {
+                return keys[i] != k.value ? keys[i] < k.value : rows[i] < k.row;
+            };
+            // First index past `after` in ascending order.
+            size_t lo = 0, hi = n;
+            while (lo < hi) {
+                size_t mid = (lo + hi) / 2;
+                if (less(mid, request.after) ||
+                    (keys[mid] == request.after.value && rows[mid] == request.after.row))
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            if (request.descending) {
+                // Rows strictly before `after`: [0, lo) minus `after` itself.
+                size_t before = lo;
+                if (before > 0 && keys[before - 1] == request.after.value &&
+                    rows[before - 1] == request.after.row)
+                    before--;
+                start = n - before;
+            } else {
+                start = lo;
+            }
+        }
+
+        vector<size_t> bases = segmentBases(*v);
+        size_t pos = start;
+        for (; pos < n && result.rows < request.limit; pos++) {
+            size_t i = request.descending ? n - 1 - pos : pos;
+            if (!emit(*v, rows[i], bases)) break;
+            result.rows++;
+            result.last = PageKey{keys[i], rows[i]};
+        }
+        result.more = pos < n;
+    }
+
+    TransactionRow rowAt(const LedgerVersion& v, size_t row, const vector<size_t>& bases) const {
+        size_t s = upper_bound(bases.begin(), bases.end(), row) - bases.begin() - 1;
+        size_t i = row - bases[s];
+        if (s < v.sealed.size()) {
+            const SealedLedger& seg = *v.sealed[s];
+            return TransactionRow{seg.dayAt(i), Money(seg.centsAt(i), currency), seg.categoryAt(i),
+                                  seg.isIncome(i), seg.descriptionAt(i), row};
+        }
+        const Ledger& log = *v.log;
+        return TransactionRow{log.dayAt(i), Money(log.centsAt(i), currency), log.categoryAt(i),
+                              log.isIncome(i), log.descriptionAt(i), row};
+    }
+
+    size_t formatRow(const LedgerVersion& v, size_t row, const vector<size_t>& bases, char* out,
+                     size_t cap) const {
+        const CategoryDictionary& dict = CategoryDictionary::instance();
+        size_t s = upper_bound(bases.begin(), bases.end(), row) - bases.begin() - 1;
+        size_t i = row - bases[s];
+        if (s < v.sealed.size()) {
+            const SealedLedger& seg = *v.sealed[s];
+            return formatTransactionLine(out, cap, seg.dayAt(i), Money(seg.centsAt(i), currency),
+                                         dict.displayName(seg.categoryAt(i)), seg.isIncome(i),
+                                         seg.descriptionView(i));
+        }
+        const Ledger& log = *v.log;
+        return formatTransactionLine(out, cap, log.dayAt(i), Money(log.centsAt(i), currency),
+                                     dict.displayName(log.categoryAt(i)), log.isIncome(i),
+                                     log.descriptionView(i));
+    }
+
+    // Brings an index up to view v. Caller holds `orderLock`.
+    const RowIndex& refreshIndex(const LedgerVersion& v, RowOrder order) const {
+        RowIndex& index = orderIndex[(int)order];
+        vector<size_t> bases = segmentBases(v);
+        size_t open = bases.back(), total = open + v.rows;
+        if (index.layout != v.layout) {
+            index.rows.clear();
+            index.keys.clear();
+            index.through = 0;
+            index.layout = v.layout;
+            index.dead.clear();
+        }
+        // Rows deleted or restored since the index last caught up.
+        index.dead.forEachDifference(v.dead, [&](size_t i) {
+            uint32_t row = (uint32_t)(open + i);
+            if (row >= index.through) return;      // not indexed yet
+            int64_t key = rowKey(v, order, row, bases);
+            size_t at = index.position(key, row);
+            if (v.dead.contains(i)) {
+                index.keys.erase(index.keys.begin() + at);
+                index.rows.erase(index.rows.begin() + at);
+            } else {
+                index.keys.insert(index.keys.begin() + at, key);
+                index.rows.insert(index.rows.begin() + at, row);
+            }
+        });
+        index.dead = v.dead;
+        if (index.through == total) return index;
+
+        vector<pair<int64_t, uint32_t>> added;
+        added.reserve(total - index.through);
+        for (size_t row = index.through; row < total; row++) {
+            if (row < open || !v.dead.contains(row - open))
+                added.push_back({rowKey(v, order, row, bases), (uint32_t)row});
+        }
+        index.through = total;
+        if (added.empty()) return index;
+        sort(added.begin(), added.end());
+
+        size_t covered = index.rows.size();
+        total = covered + added.size();
+        bool inOrder = covered == 0 || make_pair(index.keys.back(), index.rows.back()) <= added[0];
+        index.rows.reserve(total);
+        index.keys.reserve(total);
+        for (auto& a : added) {
+            index.keys.push_back(a.first);
+            index.rows.push_back(a.second);
+        }
+        if (!inOrder) {
+            // Merge the sorted tail into the sorted prefix (both by key, row).
+            vector<uint32_t> rows(total);
+            vector<int64_t> keys(total);
+            size_t a = 0, b = covered, k = 0;
+            while (a < covered || b < total) {
+                bool takeA = b == total ||
+                             (a < covered && make_pair(index.keys[a], index.rows[a]) <
+                                                 make_pair(index.keys[b], index.rows[b]));
+                size_t from = takeA ? a++ : b++;
+                keys[k] = index.keys[from];
+                rows[k++] = index.rows[from];
+            }
+            index.rows.swap(rows);
+            index.keys.swap(keys);
+        }
+        return index;
+    }
+
+    // O(categories) lookup in the month rollup for open months, plus a
+    // scan of the month's row range in any sealed segment that covers it.
+    void sumMonth(int32_t key, Money& income, Money& expense,
+                  vector<int64_t>* byCategory) const {
+        view()->sumMonth(key, income, expense, byCategory);
+    }
+
+    // Brings the model up to date with v through month `last`, refitting
+    // from the first month with rows if a month from changedFrom on was
+    // folded or `last` is behind it. Caller holds forecastLock.
+    void fitForecastLocked(const LedgerVersion& v, int32_t changedFrom, int32_t last) const {
+        if (changedFrom <= forecastModel.through || last < forecastModel.through)
+            forecastModel = ForecastModel();
+        int32_t key = forecastModel.through;
+        if (key < 0) {
+            vector<int32_t> keys = v.monthKeys();
+            if (keys.empty() || keys.front() > last) return;
+            key = keys.front();
+        } else {
+            key = addMonths(key, 1);
+        }
+        Money income, expense;
+        vector<int64_t> byCategory;
+        for (; key <= last; key = addMonths(key, 1)) {
+            v.sumMonth(key, income, expense, &byCategory);
+            forecastModel.fold(key, income.minorUnits(), byCategory);
+        }
+    }
+
+    // Rebuilds the monitor's statistics from history without raising
+    // alerts. Caller holds the exclusive lock.
+    void replayMonitor() {
+        monitor.clear();
+        for (auto& segment : sealed) {
+            size_t row = 0;
+            for (size_t m = 0; m < segment->monthCount(); m++) {
+                for (uint32_t n = 0; n < segment->monthRowCount(m); n++, row++) {
+                    monitor.observe(segment->dayAt(row), segment->monthKeyAt(m), segment->categoryAt(row),
+                                    segment->centsAt(row), segment->isIncome(row), false);
+                }
+            }
+        }
+        ledger->forEachRow([&](size_t row, int32_t day, int32_t monthKey, int64_t cents, uint32_t category,
+                              bool income) {
+            if (!dead.contains(row)) monitor.observe(day, monthKey, category, cents, income, false);
+        });
+        monitorStale = false;
+        alerts.reset();
+    }
+
+    // appendRow's body. The helpers from here to noteMonthChanged that
+    // change state expect the exclusive lock; the others, at least shared.
+    void appendLocked(int32_t day, int64_t cents, uint32_t categoryId, const string& desc,
+                      bool income) {
+        if (monitorStale) replayMonitor();
+        ledger->append(day, cents, categoryId, desc, income);
+        int32_t monthKey = ledger->monthKeyAt(ledger->size() - 1);
+        rollup.add(day, categoryId, income, cents);
+        noteMonthChanged(monthKey);
+        monitor.observe(day, monthKey, categoryId, cents, income, !replaying);
+    }
+
+    // Tombstones open-ledger row i (or brings it back) and updates the
+    // totals; the listing indexes catch up from the tombstones. The monitor
+    // is replayed without it on the next append.
+    void setDeletedLocked(size_t i, bool deleted) {
+        if (!(deleted ? dead.insert(i) : dead.erase(i))) return;
+        int64_t cents = ledger->centsAt(i);
+        bool income = ledger->isIncome(i);
+        if (deleted) rollup.remove(ledger->dayAt(i), ledger->categoryAt(i), income, cents);
+        else rollup.add(ledger->dayAt(i), ledger->categoryAt(i), income, cents);
+        noteMonthChanged(ledger->monthKeyAt(i));
+        monitorStale = true;
+    }
+
+    void pushUndoLocked(const Change& change) {
+        undoStack.push_back(change);
+        if (undoStack.size() > kMaxUndo) undoStack.pop_front();
+    }
+
+    void revertLocked(const Change& change) {
+        publishLocked();
+        setDeletedLocked(change.removed, false);
+        if (change.added != kNoRow) setDeletedLocked(change.added, true);
+        publishViewLocked();
+    }
+
+    // Maps a listing row number to a live open-ledger row.
+    bool openRowLocked(uint64_t row, size_t& i) const {
+        size_t base = sealedRowsLocked();
+        if (row < base || row - base >= ledger->size()) return false;
+        i = row - base;
+        return !dead.contains(i);
+    }
+
+    bool roomLocked(size_t rows) const {
+        return rows <= kMaxRows - sealedRowsLocked() - ledger->size();
+    }
+
+    size_t sealedRowsLocked() const {
+        size_t rows = 0;
+        for (auto& segment : sealed) rows += segment->size();
+        return rows;
+    }
+
+    // Keeps the current state as version `changes`, then starts the next.
+    void publishLocked() {
+        versions.push_back(snapshotLocked());
+        if (versions.size() > kMaxVersions) versions.pop_front();
+        changes++;
+    }
+
+    shared_ptr<const LedgerVersion> snapshotLocked() const {
+        shared_ptr<LedgerVersion> v = make_shared<LedgerVersion>();
+        fillVersionLocked(*v);
+        return v;
+    }
+
+    // Overwrites every field but the read-view ones, so v may be reused.
+    void fillVersionLocked(LedgerVersion& v) const {
+        v.number = changes;
+        v.currency = currency;
+        v.layout = layout;
+        v.rows = ledger->size();
+        v.dead = dead;
+        v.rollup = rollup;
+        v.sealed.clear();
+        for (auto& segment : sealed) v.sealed.push_back(segment.get());
+    }
+
+    // Ends every write: publishes the read view, then hands the write's
+    // changed months over. Caller holds the exclusive lock. The view
+    // replaced two writes ago is refilled if no reader still pins it, and
+    // with MonthRollup's spare nodes that makes a single-row write
+    // allocation-free in the steady state; a pinned view costs the next
+    // write a fresh one.
+    void publishViewLocked() {
+        writes++;
+        if (!alerts || (alerts->empty() ? 0 : alerts->back().seq) != monitor.lastAlert()) {
+            shared_ptr<vector<SpendingMonitor::Alert>> held = make_shared<vector<SpendingMonitor::Alert>>();
+            monitor.alertsAfter(0, *held);
+            alerts = move(held);
+        }
+        shared_ptr<LedgerVersion> next;
+        if (soleOwner(spareView)) {
+            next = move(spareView);
+        } else {
+            next = make_shared<LedgerVersion>();
+        }
+        fillVersionLocked(*next);
+        next->log = ledger;
+        next->writes = writes;
+        next->alerts = alerts;
+        atomic_store(&published, shared_ptr<const LedgerVersion>(next));
+        spareView = move(current);
+        current = move(next);
+        if (soleOwner(spareView)) {
+            fillVersionLocked(*spareView);      // lets go of the rollup's spare nodes
+        }
+        if (!staged.rebuild && staged.months.empty() && staged.earliest == INT32_MAX) return;
+        lock_guard<mutex> l(changedLock);
+        changed.earliest = min(changed.earliest, staged.earliest);
+        for (int32_t key : staged.months) addChangedMonth(changed, key);
+        if (staged.rebuild) {
+            changed.months.clear();
+            changed.rebuild = true;
+        }
+        staged.months.clear();              // keeps its capacity
+        staged.rebuild = false;
+        staged.earliest = INT32_MAX;
+    }
+
+    // A reload starts the version history over and leaves every cached
+    // month stale.
+    void forgetHistoryLocked() {
+        versions.clear();
+        undoStack.clear();
+        changes = 0;
+        layout++;
+        staged.rebuild = true;
+        staged.earliest = INT32_MIN;
+    }
+
+    // Caller holds the exclusive lock.
+    void noteMonthChanged(int32_t monthKey) {
+        staged.earliest = min(staged.earliest, monthKey);
+        addChangedMonth(staged, monthKey);
+    }
+
+    static void addChangedMonth(MonthChanges& to, int32_t monthKey) {
+        if (to.rebuild || (!to.months.empty() && to.months.back() == monthKey)) return;
+        if (to.months.size() == kMaxChangedMonths) {
+            to.months.clear();
+            to.rebuild = true;
+            return;
+        }
+        to.months.push_back(monthKey);
+    }
+
+    // Takes the changed months and turns them into stale cache entries:
+    // each changed month and the span() - 1 months after it, up to the
+    // newest month with rows. Returns the read view loaded after the take,
+    // which has every change taken. Caller holds adviceLock.
+    shared_ptr<const LedgerVersion> absorbAdviceChangesLocked(const AdviceProgram& program) const {
+        MonthChanges taken;
+        {
+            lock_guard<mutex> l(changedLock);
+            taken.months.swap(changed.months);
+            taken.rebuild = changed.rebuild;
+            changed.rebuild = false;
+        }
+        shared_ptr<const LedgerVersion> v = view();
+        if (advice.version != program.version()) {
+            advice.version = program.version();
+            taken.rebuild = true;
+        }
+        if (!taken.rebuild && taken.months.empty()) return v;
+        vector<int32_t> keys = v->monthKeys();
+        vector<int32_t> touched;
+        if (taken.rebuild) {
+            advice.months.clear();
+            touched = keys;
+        } else {
+            touched.swap(taken.months);
+        }
+        int32_t newest = keys.empty() ? -1 : keys.back();
+        for (int32_t key : touched) {
+            for (uint32_t k = 0; k < program.span(); k++) {
+                int32_t month = addMonths(key, (int)k);
+                if (k && month > newest) break;
+                advice.months.erase(month);
+                advice.pending.insert(month);
+            }
+        }
+        return v;
+    }
+
+    // Sums the program's windows ending at monthKey (nested, so one walk
+    // back through the months fills them all) and runs it.
+    Recommendations evaluateAdvice(const LedgerVersion& v, int32_t monthKey,
+                                   const AdviceProgram& program) const {
+        const vector<uint32_t>& lengths = program.windows();
+        vector<WindowTotals> totals(lengths.size());
+        WindowTotals sum;
+        Money income, expense;
+        vector<int64_t> byCategory;
+        Recommendations result;
+        result.monthKey = monthKey;
+        size_t next = 0;
+        for (uint32_t k = 0; k == 0 || next < lengths.size(); k++) {
+            if (k == 0 || monthKey >= 0) {
+                v.sumMonth(monthKey < 0 ? monthKey : addMonths(monthKey, -(int)k), income, expense,
+                           &byCategory);
+                sum.income += income.minorUnits();
+                sum.expense += expense.minorUnits();
+                if (sum.expenseByCategory.size() < byCategory.size())
+                    sum.expenseByCategory.resize(byCategory.size(), 0);
+                for (size_t id = 0; id < byCategory.size(); id++) sum.expenseByCategory[id] += byCategory[id];
+            }
+            if (k == 0) result.savings = income - expense;
+            while (next < lengths.size() && lengths[next] == k + 1) totals[next++] = sum;
+        }
+        program.run(totals, result.items);
+        return result;
+    }
+};
+
+// ================= Slab Pool =================
+// Objects carved out of fixed-size slabs instead of one heap allocation
+// each. Objects live until the pool is destroyed, which destroys them all
+// and releases memory a slab at a time. Not thread-safe.
+template <class T, size_t kPerSlab = 64>
+class SlabPool {
+    struct Slab {
+        alignas(T) unsigned char bytes[sizeof(T) * kPerSlab];
+    };
+    vector<unique_ptr<Slab>> slabs;
+    size_t usedInLast = kPerSlab;
+public:
+    SlabPool() {}
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+    ~SlabPool() {
+        for (size_t s = slabs.size(); s-- > 0;) {
+            size_t n = s + 1 == slabs.size() ? usedInLast : kPerSlab;
+            T* objects = (T*)slabs[s]->bytes;
+            for (size_t i = n; i-- > 0;) objects[i].~T();
+        }
+    }
+
+    template <class... Args> T* create(Args&&... args) {
+        if (usedInLast == kPerSlab) {
+            slabs.emplace_back(new Slab);
+            usedInLast = 0;
+        }
+        T* object = new (slabs.back()->bytes + sizeof(T) * usedInLast) T(forward<Args>(args)...);
+        usedInLast++;
+        return object;
+    }
+};
+
+// ================= User Directory =================
+// Username -> User* index: open addressing with linear probing, split into
+// shards that each have their own reader/writer lock, so logins and
+// registrations on different shards never contend.
+class UserDirectory {
+    static constexpr size_t kShardBits = 6;
+    static constexpr size_t kShards = size_t(1) << kShardBits;
+
+    struct Slot {
+        uint64_t hash = 0;
+        uint64_t seq = 0;       // registration order
+        User* user = nullptr;   // nullptr == empty
+    };
+
+    struct alignas(64) Shard {
+        mutable shared_mutex lock;
+        vector<Slot> slots;
+        size_t count = 0;
+        SlabPool<User> pool;    // owns the shard's users
+    };
+
+    Shard shards[kShards];
+    atomic<uint64_t> nextSeq{0};
+public:
+
+    User* find(const string& name) const {
+        uint64_t h = hashName(name);
+        const Shard& shard = shardFor(h);
+        shared_lock<shared_mutex> lock(shard.lock);
+        const Slot* slot = probe(shard, h, name);
+        return slot ? slot->user : nullptr;
+    }
+
+    // Creates the user unless the name is taken; returns nullptr if it is.
+    // logged() runs under the shard lock before the user becomes findable,
+    // so a register record always precedes anything logged for the user.
+    template <class Logged>
+    User* insert(const string& name, const PasswordHash& password, uint32_t currency, Logged logged) {
+        uint64_t h = hashName(name);
+        Shard& shard = shardFor(h);
+        unique_lock<shared_mutex> lock(shard.lock);
+        if (probe(shard, h, name)) return nullptr;
+        logged();
+        return insertLocked(shard, h, name, password, currency);
+    }
+
+    User* insert(const string& name, const PasswordHash& password, uint32_t currency = Money::kUSD) {
+        return insert(name, password, currency, [] {});
+    }
+
+    // Registers many accounts taking each shard lock once; logged(i) runs
+    // as in insert for each account that is actually created.
+    template <class Logged>
+    size_t insertAll(const vector<pair<string, PasswordHash>>& accounts, Logged logged) {
+        vector<vector<size_t>> byShard(kShards);
+        vector<uint64_t> hashes(accounts.size());
+        for (size_t i = 0; i < accounts.size(); i++) {
+            hashes[i] = hashName(accounts[i].first);
+            byShard[hashes[i] >> (64 - kShardBits)].push_back(i);
+        }
+
+        size_t count = 0;
+        for (size_t s = 0; s < kShards; s++) {
+            if (byShard[s].empty()) continue;
+            Shard& shard = shards[s];
+            unique_lock<shared_mutex> lock(shard.lock);
+            reserve(shard, shard.count + byShard[s].size());
+            for (size_t i : byShard[s]) {
+                if (probe(shard, hashes[i], accounts[i].first)) continue;
+                logged(i);
+                insertLocked(shard, hashes[i], accounts[i].first, accounts[i].second);
+                count++;
+            }
+        }
+        return count;
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (auto& shard : shards) {
+            shared_lock<shared_mutex> lock(shard.lock);
+            total += shard.count;
+        }
+        return total;
+    }
+
+    // Users in registration order.
+    vector<User*> all() const {
+        vector<pair<uint64_t, User*>> ordered;
+        for (auto& shard : shards) {
+            shared_lock<shared_mutex> lock(shard.lock);
+            for (auto& slot : shard.slots)
+                if (slot.user) ordered.push_back({slot.seq, slot.user});
+        }
+        sort(ordered.begin(), ordered.end(),
+             [](const pair<uint64_t, User*>& a, const pair<uint64_t, User*>& b) {
+                 return a.first < b.first;
+             });
+        vector<User*> result;
+        result.reserve(ordered.size());
+        for (auto& p : ordered) result.push_back(p.second);
+        return result;
+    }
+
+private:
+    static uint64_t hashName(const string& name) {
+        uint64_t h = 14695981039346656037ull;                // FNV-1a
+        for (unsigned char c : name) h = (h ^ c) * 1099511628211ull;
+        h ^= h >> 33;                                         // spread low bits
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    Shard& shardFor(uint64_t h) { return shards[h >> (64 - kShardBits)]; }
+    const Shard& shardFor(uint64_t h) const { return shards[h >> (64 - kShardBits)]; }
+
+    static const Slot* probe(const Shard& shard, uint64_t h, const string& name) {
+        if (shard.slots.empty()) return nullptr;
+        size_t mask = shard.slots.size() - 1;
+        for (size_t i = h & mask;; i = (i + 1) & mask) {
+            const Slot& slot = shard.slots[i];
+            if (!slot.user) return nullptr;
+            if (slot.hash == h && slot.user->getUsername() == name) return &slot;
+        }
+    }
+
+    User* insertLocked(Shard& shard, uint64_t h, const string& name, const PasswordHash& password,
+                       uint32_t currency = Money::kUSD) {
+        if (probe(shard, h, name)) return nullptr;
+        reserve(shard, shard.count + 1);
+        User* user = shard.pool.create(name, password, currency);
+        place(shard.slots, Slot{h, nextSeq.fetch_add(1, memory_order_relaxed), user});
+        shard.count++;
+        return user;
+    }
+
+    // Keeps the load factor at or below 3/4.
+    static void reserve(Shard& shard, size_t wanted) {
+        size_t capacity = shard.slots.empty() ? 16 : shard.slots.size();
+        while (wanted * 4 > capacity * 3) capacity *= 2;
+        if (capacity == shard.slots.size()) return;
+
+        vector<Slot> grown(capacity);
+        for (auto& slot : shard.slots)
+            if (slot.user) place(grown, slot);
+        shard.slots.swap(grown);
+    }
+
+    static void place(vector<Slot>& slots, const Slot& entry) {
+        size_t mask = slots.size() - 1;
+        size_t i = entry.hash & mask;
+        while (slots[i].user) i = (i + 1) & mask;
+        slots[i] = entry;
+    }
+};
+
+// ================= Durable Storage =================
+// A directory holding snapshot.bin (compacted state as of generation G)
+// plus wal-G.log, wal-G+1.log, ... (changes since). Startup loads the
+// snapshot and replays only the WAL files that follow it.
+
+// Word-at-a-time checksum; chaining through seed lets callers checksum a
+// sequence of buffers without concatenating them.
+static uint64_t checksum64(const void* data, size_t n, uint64_t seed = 0) {
+    const unsigned char* p = (const unsigned char*)data;
+    uint64_t h = seed ^ (0x9E3779B97F4A7C15ull + n);
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        h = (h ^ w) * 0xff51afd7ed558ccdull;
+        h ^= h >> 29;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, p, n);
+    h = (h ^ tail) * 0xc4ceb9fe1a85ec53ull;
+    return h ^ (h >> 32);
+}
+
+// checksum64 of a byte range that arrives in pieces (e.g. column chunks);
+// total length must be known up front. finish() equals checksum64 of the
+// concatenation with the same seed.
+class StreamChecksum {
+    uint64_t h;
+    unsigned char pending[8];
+    size_t pendingLen = 0;
+
+    void mix(const unsigned char* p) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        h = (h ^ w) * 0xff51afd7ed558ccdull;
+        h ^= h >> 29;
+    }
+public:
+    StreamChecksum(size_t totalBytes, uint64_t seed) : h(seed ^ (0x9E3779B97F4A7C15ull + totalBytes)) {}
+
+    void update(const void* data, size_t n) {
+        const unsigned char* p = (const unsigned char*)data;
+        while (pendingLen && n) {
+            pending[pendingLen++] = *p++;
+            n--;
+            if (pendingLen == 8) {
+                mix(pending);
+                pendingLen = 0;
+            }
+        }
+        for (; n >= 8; p += 8, n -= 8) mix(p);
+        memcpy(pending, p, n);
+        pendingLen = n;
+    }
+
+    uint64_t finish() {
+        uint64_t tail = 0;
+        memcpy(&tail, pending, pendingLen);
+        h = (h ^ tail) * 0xc4ceb9fe1a85ec53ull;
+        return h ^ (h >> 32);
+    }
+};
+
+struct ByteWriter {
+    string buf;
+    template <class T> void pod(T v) { buf.append((const char*)&v, sizeof v); }
+    void str(const string& s) {
+        pod<uint32_t>((uint32_t)s.size());
+        buf += s;
+    }
+};
+
+struct ByteReader {
+    const char* p;
+    const char* end;
+    bool ok = true;
+
+    ByteReader(const char* data, size_t n) : p(data), end(data + n) {}
+
+    template <class T> T pod() {
+        T v{};
+        if ((size_t)(end - p) < sizeof v) { ok = false; return v; }
+        memcpy(&v, p, sizeof v);
+        p += sizeof v;
+        return v;
+    }
+    string str() {
+        uint32_t n = pod<uint32_t>();
+        if (!ok || (size_t)(end - p) < n) { ok = false; return string(); }
+        string s(p, n);
+        p += n;
+        return s;
+    }
+};
+
+// Append-only log with group commit: appenders queue framed records and a
+// single flusher thread writes and fsyncs whatever has accumulated, so
+// concurrent writers share one fsync.
+class WriteAheadLog {
+    FILE* file = nullptr;
+    string pending;            // framed records not yet handed to the flusher
+    uint64_t appended = 0;     // sequence number of the newest queued record
+    uint64_t durable = 0;      // sequence number of the newest fsync'ed record
+    uint64_t bytes = 0;        // size of the current file
+    bool flushing = false;
+    bool stopping = false;
+    bool failed = false;
+    mutable mutex m;
+    condition_variable work, done;
+    function<void()> onDurable;    // called by the flusher, under m, after each fsync
+    thread flusher;
+public:
+    ~WriteAheadLog() { close(); }
+
+    bool open(const string& path) {
+        file = fopen(path.c_str(), "ab");
+        if (!file) return false;
+        bytes = (uint64_t)ftell(file);
+        flusher = thread([this] { flushLoop(); });
+        return true;
+    }
+
+    void close() {
+        {
+            lock_guard<mutex> l(m);
+            stopping = true;
+        }
+        work.notify_one();
+        if (flusher.joinable()) flusher.join();
+        if (file) fclose(file);
+        file = nullptr;
+    }
+
+    // Frames the payload as [u32 length][u64 checksum][payload] and queues
+    // it; returns the record's sequence number for waitDurable. After an
+    // I/O failure nothing more is written and the number never turns durable.
+    uint64_t append(const string& payload) {
+        uint32_t len = (uint32_t)payload.size();
+        uint64_t sum = checksum64(payload.data(), payload.size());
+        lock_guard<mutex> l(m);
+        if (failed) return ++appended;
+        pending.append((const char*)&len, sizeof len);
+        pending.append((const char*)&sum, sizeof sum);
+        pending += payload;
+        bytes += sizeof len + sizeof sum + payload.size();
+        work.notify_one();
+        return ++appended;
+    }
+
+    // Blocks until record seq is on stable storage; false if it was lost to
+    // an I/O failure, which also loses every record after it.
+    bool waitDurable(uint64_t seq) {
+        unique_lock<mutex> l(m);
+        done.wait(l, [&] { return durable >= seq || failed; });
+        return durable >= seq;
+    }
+
+    // Newest durable sequence number; failed is set once an I/O error
+    // means later records will never become durable.
+    uint64_t durableSeq(bool& failedOut) const {
+        lock_guard<mutex> l(m);
+        failedOut = failed;
+        return durable;
+    }
+
+    // fn runs on the flusher thread after every fsync or failure, with the
+    // log locked: it must only signal. Pass nullptr to stop.
+    void setDurableCallback(function<void()> fn) {
+        lock_guard<mutex> l(m);
+        onDurable = move(fn);
+    }
+
+    // Drains queued records and continues in a new file.
+    bool rotate(const string& path) {
+        unique_lock<mutex> l(m);
+        done.wait(l, [&] { return (pending.empty() && !flushing) || failed; });
+        if (failed) return false;
+        FILE* next = fopen(path.c_str(), "ab");
+        if (!next) return false;
+        fclose(file);
+        file = next;
+        bytes = 0;
+        return true;
+    }
+
+    uint64_t size() const {
+        lock_guard<mutex> l(m);
+        return bytes;
+    }
+
+    // Calls fn(payload) for each intact record of the file at path and
+    // truncates a torn tail left by a crash. False if the file is missing,
+    // or with `failed` set if the tail could not be truncated.
+    template <class Fn>
+    static bool replay(const string& path, Fn fn, bool& failed) {
+        FILE* f = fopen(path.c_str(), "rb");
+        if (!f) return false;
+        string data;
+        char chunk[1 << 16];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof chunk, f)) > 0) data.append(chunk, n);
+        fclose(f);
+
+        size_t pos = 0;
+        while (data.size() - pos >= 12) {
+            uint32_t len;
+            uint64_t sum;
+            memcpy(&len, data.data() + pos, 4);
+            memcpy(&sum, data.data() + pos + 4, 8);
+            if (data.size() - pos - 12 < len) break;
+            if (checksum64(data.data() + pos + 12, len) != sum) break;
+            fn(data.data() + pos + 12, (size_t)len);
+            pos += 12 + len;
+        }
+        if (pos != data.size()) {
+            error_code ec;
+            filesystem::resize_file(path, pos, ec);
+            if (ec) {
+                failed = true;
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    void flushLoop() {
+        unique_lock<mutex> l(m);
+        while (true) {
+            work.wait(l, [&] { return stopping || !pending.empty(); });
+            if (pending.empty()) break;
+            if (failed) {
+                // A short write broke the framing: replay stops there, so
+                // nothing after it may be written or reported durable.
+                pending.clear();
+                continue;
+            }
+
+            string batch;
+            batch.swap(pending);
+            uint64_t target = appended;
+            FILE* f = file;
+            flushing = true;
+            l.unlock();
+            bool ok = fwrite(batch.data(), 1, batch.size(), f) == batch.size() && syncFile(f);
+            l.lock();
+            flushing = false;
+            if (ok) durable = target;
+            else failed = true;
+            done.notify_all();
+            if (onDurable) onDurable();
+        }
+    }
+};
+
+class Storage {
+    enum RecordKind : uint8_t {
+        kRegister = 1, kTransaction = 2, kBatch = 3, kDelete = 4, kEdit = 5, kUndo = 6, kSeal = 7
+    };
+    static constexpr uint64_t kSnapshotMagic = 0x34504E5354465050ull;   // "PPFTSNP4"
+
+    string dir;
+    uint64_t generation = 0;
+    WriteAheadLog wal;
+public:
+    // Everything a snapshot needs, copied while writers are paused.
+    struct Image {
+        struct Entry {
+            User* user;
+            shared_ptr<const Ledger> ledger;    // append-only: rows past `rows` are ignored
+            size_t rows;
+            vector<string> sealedPaths;
+            RowSet dead;
+        };
+        uint64_t generation = 0;
+        vector<string> categories;
+        vector<Entry> users;
+    };
+
+    // Loads snapshot + WAL tail into users, then opens the WAL for append.
+    bool open(const string& directory, UserDirectory& users) {
+        dir = directory;
+        error_code ec;
+        filesystem::create_directories(dir, ec);
+        if (ec || !loadSnapshot(users)) return false;
+
+        uint64_t g = generation;
+        bool failed = false;
+        while (WriteAheadLog::replay(walPath(g), [&](const char* p, size_t n) {
+            applyRecord(ByteReader(p, n), users);
+        }, failed)) {
+            g++;
+        }
+        if (failed) return false;
+        generation = g > generation ? g - 1 : generation;
+        for (User* user : users.all()) {
+            unique_lock<shared_mutex> guard(user->lock);
+            user->replaying = false;
+            user->forgetHistoryLocked();
+            user->publishViewLocked();
+        }
+        return wal.open(walPath(generation));
+    }
+
+    uint64_t logRegister(const string& name, const PasswordHash& password, uint32_t currency) {
+        ByteWriter w;
+        w.pod<uint8_t>(kRegister);
+        w.str(name);
+        w.str(password.encode());
+        w.pod(currency);
+        return wal.append(w.buf);
+    }
+
+    uint64_t logTransaction(const string& name, int32_t day, int64_t cents,
+                            const string& category, const string& desc, bool income) {
+        ByteWriter w;
+        w.pod<uint8_t>(kTransaction);
+        w.str(name);
+        w.pod(day);
+        w.pod(cents);
+        w.pod<uint8_t>(income);
+        w.str(category);
+        w.str(desc);
+        return wal.append(w.buf);
+    }
+
+    // Edits name rows by number (TransactionRow::row); the caller logs
+    // under the user's lock so numbers match on replay.
+    uint64_t logDelete(const string& name, uint64_t row) {
+        ByteWriter w;
+        w.pod<uint8_t>(kDelete);
+        w.str(name);
+        w.pod(row);
+        return wal.append(w.buf);
+    }
+
+    uint64_t logEdit(const string& name, uint64_t row, int32_t day, int64_t cents,
+                     const string& category, const string& desc, bool income) {
+        ByteWriter w;
+        w.pod<uint8_t>(kEdit);
+        w.str(name);
+        w.pod(row);
+        w.pod(day);
+        w.pod(cents);
+        w.pod<uint8_t>(income);
+        w.str(category);
+        w.str(desc);
+        return wal.append(w.buf);
+    }
+
+    uint64_t logUndo(const string& name, uint64_t restored, uint64_t removed) {
+        ByteWriter w;
+        w.pod<uint8_t>(kUndo);
+        w.str(name);
+        w.pod(restored);
+        w.pod(removed);
+        return wal.append(w.buf);
+    }
+
+    // Sealing renumbers open rows, and the records after it use the new
+    // numbers; replay seals again at the same point (writing the same file).
+    uint64_t logSeal(const string& name, int32_t monthKey, const string& path) {
+        ByteWriter w;
+        w.pod<uint8_t>(kSeal);
+        w.str(name);
+        w.pod(monthKey);
+        w.str(path);
+        return wal.append(w.buf);
+    }
+
+    // One record for a whole import batch; category IDs are written as a
+    // record-local name table since dictionary IDs are per process.
+    uint64_t logBatch(const string& name, const ImportBatch& batch) {
+        const CategoryDictionary& dict = CategoryDictionary::instance();
+        unordered_map<uint32_t, uint32_t> local;
+        vector<uint32_t> names, ids(batch.size());
+        for (size_t i = 0; i < batch.size(); i++) {
+            auto it = local.emplace(batch.categories[i], (uint32_t)names.size()).first;
+            if (it->second == names.size()) names.push_back(it->first);
+            ids[i] = it->second;
+        }
+
+        ByteWriter w;
+        w.pod<uint8_t>(kBatch);
+        w.str(name);
+        w.pod<uint32_t>((uint32_t)names.size());
+        for (uint32_t id : names) w.str(dict.displayName(id));
+        w.pod<uint32_t>((uint32_t)batch.size());
+        w.buf.append((const char*)batch.days.data(), batch.size() * 4);
+        w.buf.append((const char*)batch.cents.data(), batch.size() * 8);
+        w.buf.append((const char*)ids.data(), batch.size() * 4);
+        w.buf.append((const char*)batch.income.data(), batch.size());
+        w.buf.append((const char*)batch.descEnds.data(), batch.size() * 8);
+        w.pod<uint64_t>(batch.descArena.size());
+        w.buf += batch.descArena;
+        return wal.append(w.buf);
+    }
+
+    bool waitDurable(uint64_t seq) { return wal.waitDurable(seq); }
+    uint64_t durableSeq(bool& failed) const { return wal.durableSeq(failed); }
+    void setDurableCallback(function<void()> fn) { wal.setDurableCallback(move(fn)); }
+    uint64_t walBytes() const { return wal.size(); }
+
+    // First half of a checkpoint; the caller must have paused all writers.
+    // Switches to a fresh WAL and pins the state that precedes it: each
+    // ledger with its row count, which later appends leave intact.
+    bool beginCheckpoint(UserDirectory& users, Image& image) {
+        if (!wal.rotate(walPath(generation + 1))) return false;
+        generation++;
+        image.generation = generation;
+        const CategoryDictionary& dict = CategoryDictionary::instance();
+        for (uint32_t id = 0; id < dict.size(); id++) image.categories.push_back(dict.displayName(id));
+        for (User* user : users.all()) {
+            shared_lock<shared_mutex> guard(user->lock);
+            vector<string> paths;
+            for (auto& segment : user->sealed) paths.push_back(segment->path());
+            image.users.push_back(
+                Image::Entry{user, user->ledger, user->ledger->size(), move(paths), user->dead});
+        }
+        return true;
+    }
+
+    // Second half, run with writers active again: writes the snapshot
+    // atomically and drops the WAL files it supersedes.
+    bool finishCheckpoint(const Image& image) {
+        string tmp = dir + "/snapshot.tmp";
+        FILE* f = fopen(tmp.c_str(), "wb");
+        if (!f) return false;
+        vector<char> buffer(1 << 20);
+        setvbuf(f, buffer.data(), _IOFBF, buffer.size());
+
+        bool ok = true;
+        auto put = [&](const void* p, size_t n, uint64_t& sum) {
+            if (n && fwrite(p, 1, n, f) != n) ok = false;
+            sum = checksum64(p, n, sum);
+        };
+        auto putStr = [&](const string& str, uint64_t& sum) {
+            uint32_t n = (uint32_t)str.size();
+            put(&n, sizeof n, sum);
+            put(str.data(), n, sum);
+        };
+        // The first count elements, with the same bytes and checksum as one
+        // put() of them; the column may be growing past count meanwhile.
+        auto putColumn = [&](const auto& column, size_t count, uint64_t& sum) {
+            using Column = decay_t<decltype(column)>;
+            StreamChecksum stream(count * sizeof(column[0]), sum);
+            for (size_t k = 0; k < Column::chunkCount(count); k++) {
+                size_t n = Column::chunkSize(k, count) * sizeof(column[0]);
+                if (n && fwrite(column.chunkData(k), 1, n, f) != n) ok = false;
+                stream.update(column.chunkData(k), n);
+            }
+            sum = stream.finish();
+        };
+
+        uint64_t sum = 0;
+        put(&kSnapshotMagic, 8, sum);
+        put(&image.generation, 8, sum);
+        uint32_t categoryCount = (uint32_t)image.categories.size();
+        put(&categoryCount, 4, sum);
+        for (auto& name : image.categories) putStr(name, sum);
+        uint64_t userCount = image.users.size();
+        put(&userCount, 8, sum);
+        put(&sum, 8, sum);
+
+        for (auto& entry : image.users) {
+            const User* user = entry.user;
+            const Ledger& l = *entry.ledger;
+            uint64_t rows = entry.rows, arena = l.descriptionEnd(rows);
+            vector<uint64_t> bits((rows + 63) / 64);
+            for (size_t w = 0; w < bits.size(); w++) bits[w] = l.incomeWord(w);
+            if (rows & 63) bits.back() &= (uint64_t(1) << (rows & 63)) - 1;   // later appends
+            uint64_t block = 0;
+            putStr(user->username, block);
+            putStr(user->password.encode(), block);
+            put(&user->currency, 4, block);
+            uint32_t sealedCount = (uint32_t)entry.sealedPaths.size();
+            put(&sealedCount, 4, block);
+            for (auto& path : entry.sealedPaths) putStr(path, block);
+            put(&rows, 8, block);
+            put(&arena, 8, block);
+            putColumn(l.dayColumn(), rows, block);
+            putColumn(l.centsColumn(), rows, block);
+            putColumn(l.categoryColumn(), rows, block);
+            put(bits.data(), bits.size() * 8, block);
+            putColumn(l.descEndColumn(), rows, block);
+            StreamChecksum text(arena, block);
+            l.descriptionArena().forEachChunk(arena, [&](const char* data, size_t n) {
+                if (n && fwrite(data, 1, n, f) != n) ok = false;
+                text.update(data, n);
+            });
+            block = text.finish();
+            vector<uint64_t> deleted;
+            entry.dead.forEach([&](size_t row) { deleted.push_back(row); });
+            uint64_t deletedCount = deleted.size();
+            put(&deletedCount, 8, block);
+            if (deletedCount) put(deleted.data(), deletedCount * 8, block);
+            put(&block, 8, block);
+        }
+        ok = syncFile(f) && ok;
+        ok = fclose(f) == 0 && ok;
+        if (!ok) return false;
+
+        error_code ec;
+        filesystem::rename(tmp, dir + "/snapshot.bin", ec);
+        if (ec) return false;
+        for (uint64_t g = image.generation; g-- > 0 && filesystem::remove(walPath(g), ec);) {}
+        return true;
+    }
+
+private:
+    string walPath(uint64_t g) const { return dir + "/wal-" + to_string(g) + ".log"; }
+
+    bool loadSnapshot(UserDirectory& users) {
+        string path = dir + "/snapshot.bin";
+        FILE* f = fopen(path.c_str(), "rb");
+        if (!f) return true;                       // fresh directory
+        vector<char> buffer(1 << 20);
+        setvbuf(f, buffer.data(), _IOFBF, buffer.size());
+
+        // Counts are checked against the bytes left before anything is
+        // sized from them: checksums are only known once a block is read,
+        // and a damaged count must fail the load, not the allocation.
+        error_code ec;
+        uint64_t left = filesystem::file_size(path, ec);
+        bool ok = !ec;
+        auto fits = [&](uint64_t count, uint64_t width) {
+            if (ok && count > left / width) ok = false;
+            return ok;
+        };
+        auto get = [&](void* p, size_t n, uint64_t& sum) {
+            if (n && (!fits(n, 1) || fread(p, 1, n, f) != n)) ok = false;
+            if (ok) left -= n;
+            sum = checksum64(p, ok ? n : 0, sum);
+        };
+        auto getStr = [&](string& str, uint64_t& sum) {
+            uint32_t n = 0;
+            get(&n, 4, sum);
+            if (!fits(n, 1)) return;
+            str.resize(n);
+            get(&str[0], n, sum);
+        };
+        auto getColumn = [&](auto& column, size_t count, uint64_t& sum) {
+            if (!fits(count, sizeof(column[0]))) return;
+            column.resize(count);
+            StreamChecksum stream(count * sizeof(column[0]), sum);
+            for (size_t k = 0; ok && k < column.chunkCount(); k++) {
+                size_t n = column.chunkSize(k) * sizeof(column[0]);
+                if (n && fread(column.chunkData(k), 1, n, f) != n) ok = false;
+                left -= n;
+                stream.update(column.chunkData(k), n);
+            }
+            sum = stream.finish();
+        };
+
+        uint64_t sum = 0, magic = 0, stored = 0, userCount = 0;
+        uint32_t categoryCount = 0;
+        get(&magic, 8, sum);
+        get(&generation, 8, sum);
+        get(&categoryCount, 4, sum);
+        vector<uint32_t> remap(fits(categoryCount, 4) ? categoryCount : 0);
+        for (uint32_t i = 0; ok && i < categoryCount; i++) {
+            string name;
+            getStr(name, sum);
+            remap[i] = CategoryDictionary::instance().intern(name);
+            ok = ok && remap[i] != CategoryDictionary::kNoId;
+        }
+        get(&userCount, 8, sum);
+        uint64_t expected = sum;
+        get(&stored, 8, sum);
+        ok = ok && magic == kSnapshotMagic && stored == expected;
+
+        for (uint64_t u = 0; ok && u < userCount; u++) {
+            uint64_t block = 0, rows = 0, arenaSize = 0;
+            string name, encoded;
+            getStr(name, block);
+            getStr(encoded, block);
+            PasswordHash password;
+            if (ok && !PasswordHash::decode(encoded, password)) ok = false;
+            uint32_t currency = Money::kUSD;
+            get(&currency, 4, block);
+            uint32_t sealedCount = 0;
+            get(&sealedCount, 4, block);
+            vector<string> sealedPaths(fits(sealedCount, 4) ? sealedCount : 0);
+            for (auto& path : sealedPaths) getStr(path, block);
+            get(&rows, 8, block);
+            get(&arenaSize, 8, block);
+            if (!fits(rows, 24) || !fits(arenaSize, 1)) break;
+
+            Ledger l;
+            getColumn(l.days, rows, block);
+            getColumn(l.cents, rows, block);
+            getColumn(l.categoryIds, rows, block);
+            getColumn(l.incomeBits, (rows + 63) / 64, block);
+            getColumn(l.descEnds, rows, block);
+            char empty = 0;
+            get(arenaSize ? l.descArena.reserve(arenaSize) : &empty, arenaSize, block);
+            uint64_t deletedCount = 0;
+            get(&deletedCount, 8, block);
+            if (!fits(deletedCount, 8) || deletedCount > rows) { ok = false; break; }
+            vector<uint64_t> deleted(deletedCount);
+            if (deletedCount) get(deleted.data(), deletedCount * 8, block);
+            uint64_t blockExpected = block;
+            get(&stored, 8, block);
+            if (!ok || stored != blockExpected) { ok = false; break; }
+
+            for (size_t k = 0; ok && k < l.categoryIds.chunkCount(); k++) {
+                uint32_t* ids = l.categoryIds.chunkData(k);
+                for (size_t i = 0; i < l.categoryIds.chunkSize(k); i++) {
+                    if (ids[i] >= remap.size()) { ok = false; break; }
+                    ids[i] = remap[ids[i]];
+                }
+            }
+            for (size_t i = 0; ok && i < rows; i++)
+                ok = l.descEnds[i] <= arenaSize && (i == 0 || l.descEnds[i - 1] <= l.descEnds[i]);
+            if (!ok) break;
+            l.finishLoad();
+            User* user = users.insert(name, password, currency);
+            if (!user) user = users.find(name);
+            user->adoptLedger(move(l), deleted);
+            for (auto& path : sealedPaths) ok = ok && user->attachSealed(path);
+        }
+        fclose(f);
+        return ok;
+    }
+
+    // Rows replayed here were seen before the restart: they update each
+    // user's Spending Monitor statistics but raise no alerts until open()
+    // finishes.
+    void applyRecord(ByteReader r, UserDirectory& users) {
+        uint8_t kind = r.pod<uint8_t>();
+        string name = r.str();
+        auto target = [&] {
+            User* user = users.find(name);
+            if (user) user->replaying = true;
+            return user;
+        };
+        if (kind == kRegister) {
+            PasswordHash password;
+            bool decoded = PasswordHash::decode(r.str(), password);
+            uint32_t currency = r.pod<uint32_t>();
+            if (r.ok && decoded) users.insert(name, password, currency);
+        } else if (kind == kTransaction) {
+            int32_t day = r.pod<int32_t>();
+            int64_t cents = r.pod<int64_t>();
+            bool income = r.pod<uint8_t>() != 0;
+            string category = r.str();
+            string desc = r.str();
+            User* user = target();
+            uint32_t categoryId = CategoryDictionary::instance().intern(category);
+            if (r.ok && user && categoryId != CategoryDictionary::kNoId)
+                user->appendRow(day, cents, categoryId, desc, income);
+        } else if (kind == kBatch) {
+            vector<uint32_t> remap(r.pod<uint32_t>());
+            for (auto& id : remap) id = CategoryDictionary::instance().intern(r.str());
+            uint32_t rows = r.pod<uint32_t>();
+            if (count(remap.begin(), remap.end(), CategoryDictionary::kNoId)) return;
+            if (!r.ok || (size_t)(r.end - r.p) < (size_t)rows * 25) return;
+
+            ImportBatch batch;
+            batch.days.resize(rows);
+            batch.cents.resize(rows);
+            batch.categories.resize(rows);
+            batch.income.resize(rows);
+            batch.descEnds.resize(rows);
+            auto take = [&](void* dst, size_t n) { memcpy(dst, r.p, n); r.p += n; };
+            take(batch.days.data(), rows * 4);
+            take(batch.cents.data(), rows * 8);
+            take(batch.categories.data(), rows * 4);
+            take(batch.income.data(), rows);
+            take(batch.descEnds.data(), rows * 8);
+            uint64_t arenaSize = r.pod<uint64_t>();
+            if (!r.ok || (uint64_t)(r.end - r.p) < arenaSize) return;
+            batch.descArena.assign(r.p, arenaSize);
+            r.p += arenaSize;
+            uint64_t prevEnd = 0;
+            for (uint32_t i = 0; i < rows; i++) {
+                if (batch.categories[i] >= remap.size()) return;
+                if (batch.descEnds[i] < prevEnd || batch.descEnds[i] > batch.descArena.size()) return;
+                batch.categories[i] = remap[batch.categories[i]];
+                prevEnd = batch.descEnds[i];
+            }
+            User* user = target();
+            if (r.ok && user) user->appendBatch(batch);
+        } else if (kind == kDelete) {
+            uint64_t row = r.pod<uint64_t>();
+            User* user = target();
+            if (r.ok && user) user->deleteRow(row, [] {});
+        } else if (kind == kEdit) {
+            uint64_t row = r.pod<uint64_t>();
+            int32_t day = r.pod<int32_t>();
+            int64_t cents = r.pod<int64_t>();
+            bool income = r.pod<uint8_t>() != 0;
+            string category = r.str();
+            string desc = r.str();
+            User* user = target();
+            uint32_t categoryId = CategoryDictionary::instance().intern(category);
+            if (r.ok && user && categoryId != CategoryDictionary::kNoId)
+                user->editRow(row, day, cents, categoryId, desc, income, [] {});
+        } else if (kind == kUndo) {
+            uint64_t restored = r.pod<uint64_t>();
+            uint64_t removed = r.pod<uint64_t>();
+            User* user = target();
+            if (r.ok && user) user->restoreRows(restored, removed);
+        } else if (kind == kSeal) {
+            int32_t monthKey = r.pod<int32_t>();
+            string path = r.str();
+            User* user = target();
+            if (!r.ok || !user) return;
+            for (auto& segment : user->sealed)
+                if (segment->path() == path) return;      // the snapshot already has it
+            user->sealBefore(monthKey, path);
+        }
+    }
+};
+
+// ================= CSV Bulk Import =================
+// Streaming importer for bank/CSV exports. The file is memory-mapped and
+// cut into newline-aligned chunks that worker threads parse in parallel;
+// parsed chunks are handed to a sink strictly in file order.
+//
+// Columns default to date,amount,category,description,type. A header row
+// naming them (any order; description may also be desc/memo/details) is
+// detected automatically. Without a type column, or when the field is
+// empty, negative amounts are expenses and positive ones income. Quoted
+// fields may contain delimiters and doubled quotes but not newlines.
+struct ImportOptions {
+    char delimiter = ',';
+    size_t chunkBytes = size_t(4) << 20;
+    unsigned threads = 0;            // 0 = one per hardware thread
+    size_t maxDiagnostics = 100;
+};
+
+struct ImportDiagnostic {
+    uint64_t line;                   // 1-based line in the file
+    string reason;
+};
+
+struct ImportStats {
+    bool ok = false;                 // file read and every batch committed
+    uint64_t rowsAccepted = 0;
+    uint64_t rowsRejected = 0;
+    uint64_t bytes = 0;
+    double seconds = 0;
+    vector<ImportDiagnostic> diagnostics;   // first maxDiagnostics rejections
+
+    double rowsPerSecond() const {
+        return seconds > 0 ? (rowsAccepted + rowsRejected) / seconds : 0;
+    }
+};
+
+// "-1234.5" -> -123450. At most two decimals are kept; a third rounds half
+// away from zero. One sign at most; no exponents, grouping or currency
+// symbols.
+static bool parseCents(const char* p, size_t n, int64_t& out) {
+    const char* end = p + n;
+    while (p < end && *p == ' ') p++;
+    while (end > p && end[-1] == ' ') end--;
+    bool negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) p++;
+    if (p < end && (*p == '-' || *p == '+')) return false;     // from_chars takes a second '-'
+
+    int64_t whole = 0;
+    const char* dot = find(p, end, '.');
+    if (dot == p && dot == end) return false;
+    if (dot > p) {
+        auto r = from_chars(p, dot, whole);
+        if (r.ec != errc() || r.ptr != dot || whole > INT64_MAX / 100 - 1) return false;
+    }
+    int64_t fraction = 0, digits = 0;
+    if (dot < end) {
+        if (dot + 1 == end && dot == p) return false;
+        for (const char* q = dot + 1; q < end; q++, digits++) {
+            if (*q < '0' || *q > '9') return false;
+            if (digits < 2) fraction = fraction * 10 + (*q - '0');
+            else if (digits == 2 && *q >= '5') fraction++;
+        }
+        if (digits == 1) fraction *= 10;
+    }
+    out = whole * 100 + fraction;
+    if (negative) out = -out;
+    return true;
+}
+
+class CsvImporter {
+    struct Field {
+        const char* p;
+        size_t n;
+    };
+
+    struct Columns {
+        int date = 0, amount = 1, category = 2, description = 3, type = 4;
+    };
+
+    struct ChunkResult {
+        ImportBatch batch;
+        uint64_t lines = 0;
+        uint64_t rejected = 0;
+        vector<ImportDiagnostic> diagnostics;   // chunk-relative lines
+    };
+
+    // Per-thread category cache keyed by the raw bytes (views into the
+    // mapping, or into `owned` for unescaped quoted fields).
+    struct CategoryCache {
+        unordered_map<string_view, uint32_t> ids;
+        deque<string> owned;
+
+        uint32_t lookup(const char* p, size_t n) {
+            auto it = ids.find(string_view(p, n));
+            if (it != ids.end()) return it->second;
+            string name(p, n);
+            uint32_t id = CategoryDictionary::instance().intern(name);
+            if (id == CategoryDictionary::kNoId) return id;
+            owned.push_back(move(name));
+            ids.emplace(string_view(owned.back()), id);
+            return id;
+        }
+    };
+public:
+    template <class Sink>
+    static ImportStats run(const string& path, const ImportOptions& options, Sink sink) {
+        auto start = chrono::steady_clock::now();
+        ImportStats stats;
+        MappedFile file;
+        if (!file.open(path)) return stats;
+        const char* data = file.data();
+        size_t size = file.size();
+        stats.bytes = size;
+
+        // Header detection on the first line.
+        Columns cols;
+        size_t dataStart = 0;
+        uint64_t headerLines = 0;
+        {
+            const char* nl = (const char*)memchr(data, '\n', size);
+            const char* lineEnd = nl ? nl : data + size;
+            vector<Field> fields;
+            vector<string> scratch;
+            if (splitRecord(data, trimCr(data, lineEnd), options.delimiter, fields, scratch) &&
+                detectHeader(fields, cols)) {
+                dataStart = nl ? nl - data + 1 : size;
+                headerLines = 1;
+            }
+        }
+
+        vector<pair<size_t, size_t>> chunks;
+        for (size_t begin = dataStart; begin < size;) {
+            size_t end = min(size, begin + max<size_t>(options.chunkBytes, 1));
+            if (end < size) {
+                const char* nl = (const char*)memchr(data + end, '\n', size - end);
+                end = nl ? nl - data + 1 : size;
+            }
+            chunks.push_back({begin, end});
+            begin = end;
+        }
+
+        unsigned threads = options.threads ? options.threads : thread::hardware_concurrency();
+        threads = max(1u, min<unsigned>(threads, (unsigned)max<size_t>(chunks.size(), 1)));
+        const size_t window = threads * 4;      // bounds parsed-but-uncommitted chunks
+
+        vector<unique_ptr<ChunkResult>> results(chunks.size());
+        mutex m;
+        condition_variable ready, drained;
+        size_t committed = 0;
+        atomic<size_t> next{0};
+
+        auto worker = [&] {
+            CategoryCache cache;
+            for (size_t i; (i = next.fetch_add(1)) < chunks.size();) {
+                {
+                    unique_lock<mutex> l(m);
+                    drained.wait(l, [&] { return i < committed + window; });
+                }
+                unique_ptr<ChunkResult> result(new ChunkResult());
+                parseChunk(data + chunks[i].first, data + chunks[i].second, cols, options, cache,
+                           *result);
+                lock_guard<mutex> l(m);
+                results[i] = move(result);
+                ready.notify_all();
+            }
+        };
+        vector<thread> pool;
+        for (unsigned t = 0; t < threads; t++) pool.emplace_back(worker);
+
+        uint64_t lineBase = headerLines;
+        for (size_t i = 0; i < chunks.size(); i++) {
+            unique_ptr<ChunkResult> result;
+            {
+                unique_lock<mutex> l(m);
+                ready.wait(l, [&] { return results[i] != nullptr; });
+                result = move(results[i]);
+            }
+            if (result->batch.size()) sink(result->batch);
+            stats.rowsAccepted += result->batch.size();
+            stats.rowsRejected += result->rejected;
+            for (auto& d : result->diagnostics) {
+                if (stats.diagnostics.size() >= options.maxDiagnostics) break;
+                stats.diagnostics.push_back({lineBase + d.line, d.reason});
+            }
+            lineBase += result->lines;
+            {
+                lock_guard<mutex> l(m);
+                committed = i + 1;
+            }
+            drained.notify_all();
+        }
+        for (auto& t : pool) t.join();
+
+        stats.ok = true;
+        stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return stats;
+    }
+
+private:
+    static const char* trimCr(const char* begin, const char* end) {
+        return end > begin && end[-1] == '\r' ? end - 1 : end;
+    }
+
+    static bool equalsFolded(const Field& f, const char* word) {
+        size_t n = strlen(word);
+        if (f.n != n) return false;
+        for (size_t i = 0; i < n; i++)
+            if (tolower((unsigned char)f.p[i]) != word[i]) return false;
+        return true;
+    }
+
+    static bool detectHeader(const vector<Field>& fields, Columns& cols) {
+        Columns found;
+        found.date = found.amount = found.category = found.description = found.type = -1;
+        for (int i = 0; i < (int)fields.size(); i++) {
+            const Field& f = fields[i];
+            if (equalsFolded(f, "date")) found.date = i;
+            else if (equalsFolded(f, "amount")) found.amount = i;
+            else if (equalsFolded(f, "category")) found.category = i;
+            else if (equalsFolded(f, "description") || equalsFolded(f, "desc") ||
+                     equalsFolded(f, "memo") || equalsFolded(f, "details")) found.description = i;
+            else if (equalsFolded(f, "type")) found.type = i;
+        }
+        if (found.date < 0 || found.amount < 0) return false;
+        cols = found;
+        return true;
+    }
+
+    // Splits one record into fields. Quoted fields lose their quotes and
+    // have doubled quotes collapsed into scratch. False on a stray quote.
+    static bool splitRecord(const char* p, const char* end, char delim, vector<Field>& fields,
+                            vector<string>& scratch) {
+        fields.clear();
+        size_t quoted = 0;
+        while (true) {
+            if (p < end && *p == '"') {
+                if (scratch.size() <= quoted) scratch.emplace_back();
+                string& out = scratch[quoted++];
+                out.clear();
+                const char* q = p + 1;
+                while (true) {
+                    const char* close = (const char*)memchr(q, '"', end - q);
+                    if (!close) return false;
+                    out.append(q, close - q);
+                    if (close + 1 < end && close[1] == '"') {
+                        out += '"';
+                        q = close + 2;
+                        continue;
+                    }
+                    p = close + 1;
+                    break;
+                }
+                fields.push_back({out.data(), out.size()});
+                if (p == end) return true;
+                if (*p != delim) return false;
+                p++;
+            } else {
+                const char* d = (const char*)memchr(p, delim, end - p);
+                const char* fieldEnd = d ? d : end;
+                fields.push_back({p, (size_t)(fieldEnd - p)});
+                if (!d) return true;
+                p = d + 1;
+            }
+        }
+    }
+
+    static void parseChunk(const char* p, const char* end, const Columns& cols,
+                           const ImportOptions& options, CategoryCache& cache, ChunkResult& out) {
+        vector<Field> fields;
+        vector<string> scratch;
+        out.batch.days.reserve((end - p) / 48);
+        int needed = max({cols.date, cols.amount, cols.category, cols.description});
+        static const Field empty = {"", 0};
+
+        while (p < end) {
+            const char* nl = (const char*)memchr(p, '\n', end - p);
+            const char* lineEnd = nl ? nl : end;
+            const char* recordEnd = trimCr(p, lineEnd);
+            out.lines++;
+            const char* reason = nullptr;
+
+            if (recordEnd == p) {
+                // blank line
+            } else if (!splitRecord(p, recordEnd, options.delimiter, fields, scratch)) {
+                reason = "malformed quoting";
+            } else if ((int)fields.size() <= needed) {
+                reason = "missing fields";
+            } else {
+                auto field = [&](int c) -> const Field& {
+                    return c >= 0 && c < (int)fields.size() ? fields[c] : empty;
+                };
+                Field date = field(cols.date);
+                const Field& type = field(cols.type);
+                while (date.n && date.p[0] == ' ') date.p++, date.n--;
+                while (date.n && date.p[date.n - 1] == ' ') date.n--;
+                int32_t day = packDate(date.p, date.n);
+                int64_t cents;
+                bool income = false;
+                if (day == kInvalidDay) {
+                    reason = "invalid date";
+                } else if (!parseCents(field(cols.amount).p, field(cols.amount).n, cents)) {
+                    reason = "invalid amount";
+                } else if (type.n == 0) {
+                    income = cents >= 0;
+                    cents = cents < 0 ? -cents : cents;
+                } else if (cents < 0) {
+                    reason = "negative amount (the type column gives the sign)";
+                } else if (equalsFolded(type, "income")) {
+                    income = true;
+                } else if (!equalsFolded(type, "expense")) {
+                    reason = "unknown type (expected Income or Expense)";
+                }
+                const Field& category = field(cols.category);
+                uint32_t categoryId = reason ? 0 : cache.lookup(category.p, category.n);
+                if (categoryId == CategoryDictionary::kNoId) reason = "category table full";
+                if (!reason) {
+                    const Field& desc = field(cols.description);
+                    out.batch.add(day, cents, categoryId, income, desc.p, desc.n);
+                }
+            }
+
+            if (reason) {
+                out.rejected++;
+                if (out.diagnostics.size() < options.maxDiagnostics)
+                    out.diagnostics.push_back({out.lines, reason});
+            }
+            p = nl ? nl + 1 : end;
+        }
+    }
+};
+
+// ================= Session Table =================
+// Session handles returned by FinanceTracker::loginUser. An ID is 128 bits
+// straight from the OS random source, so holding one token says nothing
+// about any other; it is also the HTTP bearer token. The zero ID means
+// "no session".
+struct SessionId {
+    uint64_t hi = 0, lo = 0;
+
+    explicit operator bool() const { return (hi | lo) != 0; }
+    bool operator==(const SessionId& o) const { return hi == o.hi && lo == o.lo; }
+
+    string toHex() const {
+        char text[33];
+        snprintf(text, sizeof text, "%016llx%016llx", (unsigned long long)hi, (unsigned long long)lo);
+        return text;
+    }
+
+    // Accepts exactly 32 hex digits; anything else gives the zero ID.
+    static SessionId fromHex(string_view text) {
+        SessionId id;
+        if (text.size() != 32) return id;
+        auto half = [](string_view part, uint64_t& v) {
+            auto r = from_chars(part.data(), part.data() + part.size(), v, 16);
+            return r.ec == errc() && r.ptr == part.data() + part.size();
+        };
+        if (!half(text.substr(0, 16), id.hi) || !half(text.substr(16), id.lo)) return SessionId{};
+        return id;
+    }
+};
+
+class SessionTable {
+    static constexpr size_t kShards = 64;
+
+    struct IdHash {
+        size_t operator()(const SessionId& id) const { return (size_t)(id.lo ^ id.hi); }
+    };
+
+    struct alignas(64) Shard {
+        mutable mutex lock;
+        unordered_map<SessionId, User*, IdHash> sessions;
+    };
+
+    Shard shards[kShards];
+public:
+    // Returns the zero ID if the random source fails.
+    SessionId open(User* user) {
+        SessionId id;
+        for (;;) {
+            if (!SecureRandom::instance().fill(&id, sizeof id)) return SessionId{};
+            if (!id) continue;
+            Shard& shard = shards[id.lo % kShards];
+            lock_guard<mutex> guard(shard.lock);
+            if (shard.sessions.emplace(id, user).second) return id;
+        }
+    }
+
+    void close(SessionId id) {
+        Shard& shard = shards[id.lo % kShards];
+        lock_guard<mutex> guard(shard.lock);
+        shard.sessions.erase(id);
+    }
+
+    User* find(SessionId id) const {
+        const Shard& shard = shards[id.lo % kShards];
+        lock_guard<mutex> guard(shard.lock);
+        auto it = shard.sessions.find(id);
+        return it == shard.sessions.end() ? nullptr : it->second;
+    }
+};
+
+// ================= Work-Stealing Pool =================
+// Fixed set of workers, each owning a deque of task indices. A worker pops
+// from the back of its own deque and, once that is empty, steals from the
+// front of the others', so uneven tasks (one huge user, many small ones)
+// still keep every core busy. parallelFor runs one job at a time.
+class WorkStealingPool {
+    struct alignas(64) Worker {
+        mutex lock;
+        deque<size_t> tasks;
+    };
+
+    vector<unique_ptr<Worker>> workers;
+    vector<thread> threads;
+    const function<void(size_t, size_t)>* job = nullptr;
+    atomic<size_t> pending{0};
+    mutex jobMutex;                 // serializes parallelFor callers
+    mutex waitLock;
+    condition_variable wake, done;
+    uint64_t generation = 0;
+    bool stopping = false;
+public:
+    explicit WorkStealingPool(size_t threadCount) {
+        threadCount = max<size_t>(1, threadCount);
+        for (size_t i = 0; i < threadCount; i++) workers.emplace_back(new Worker());
+        for (size_t i = 0; i < threadCount; i++) threads.emplace_back([this, i] { workerLoop(i); });
+    }
+
+    ~WorkStealingPool() {
+        {
+            lock_guard<mutex> l(waitLock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    size_t size() const { return workers.size(); }
+
+    // Runs task(index, worker) for every index in [0, count) and returns
+    // once all have finished. worker < size() identifies the thread, for
+    // per-thread partial results.
+    void parallelFor(size_t count, const function<void(size_t, size_t)>& task) {
+        if (count == 0) return;
+        lock_guard<mutex> serial(jobMutex);
+        job = &task;
+        pending = count;
+        // Contiguous blocks per worker keep neighbouring tasks together.
+        size_t n = workers.size(), block = (count + n - 1) / n;
+        for (size_t w = 0; w < n; w++) {
+            lock_guard<mutex> l(workers[w]->lock);
+            for (size_t i = w * block; i < min(count, (w + 1) * block); i++)
+                workers[w]->tasks.push_back(i);
+        }
+        unique_lock<mutex> l(waitLock);
+        generation++;
+        wake.notify_all();
+        done.wait(l, [&] { return pending == 0; });
+    }
+
+private:
+    void workerLoop(size_t self) {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                unique_lock<mutex> l(waitLock);
+                wake.wait(l, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            size_t index;
+            while (take(self, index)) {
+                (*job)(index, self);
+                if (pending.fetch_sub(1) == 1) {
+                    lock_guard<mutex> l(waitLock);
+                    done.notify_all();
+                }
+            }
+        }
+    }
+
+    bool take(size_t self, size_t& index) {
+        {
+            Worker& own = *workers[self];
+            lock_guard<mutex> l(own.lock);
+            if (!own.tasks.empty()) {
+                index = own.tasks.back();
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t k = 1; k < workers.size(); k++) {
+            Worker& victim = *workers[(self + k) % workers.size()];
+            lock_guard<mutex> l(victim.lock);
+            if (!victim.tasks.empty()) {
+                index = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// ================= Org-Wide Analytics =================
+// Aggregates across every user of one currency for a month.
+struct OrgReport {
+    struct Overspender {
+        string username;
+        int64_t overspend;          // expense - income, minor units
+    };
+
+    uint32_t currency = Money::kUSD;
+    int32_t monthKey = -1;
+    size_t users = 0;               // users in this currency
+    int64_t income = 0;             // month totals, minor units
+    int64_t expense = 0;
+    map<int32_t, vector<int64_t>> expenseByMonth;   // month -> expense per category ID
+    // [0]: saved < 0% of income; [1 + k]: k*10% to (k+1)*10% (100% lands in [10]).
+    size_t savingsRateBuckets[11] = {0};
+    size_t usersWithoutIncome = 0;
+    vector<Overspender> topOverspenders;            // largest first
+};
+
+// ================= Report Rendering =================
+// Optional text and JSON forms of the Analytics Results. Text matches the
+// historical report layout; JSON keeps amounts as integer minor units.
+static string formatMonthKey(int32_t key) {
+    if (key < 0) return "invalid";
+    char buf[16];
+    snprintf(buf, sizeof buf, "%04d-%02d", key / 100, key % 100);
+    return buf;
+}
+
+// Right-aligns text in width columns, like setw on a stream.
+static void appendPadded(string& out, const string& text, size_t width) {
+    if (text.size() < width) out.append(width - text.size(), ' ');
+    out += text;
+}
+
+static void appendTotals(string& out, const Money& income, const Money& expense) {
+    out += "  Total Income:  " + income.toString() + "\n";
+    out += "  Total Expense: " + expense.toString() + "\n";
+    out += "  Savings:       " + (income - expense).toString();
+}
+
+static string renderSummary(const MonthSummary& summary) {
+    string out = "Summary for " + formatMonthKey(summary.monthKey) + ":\n";
+    appendTotals(out, summary.income, summary.expense);
+    return out;
+}
+
+static string renderSummary(const RangeSummary& summary) {
+    string out = "Summary for " + formatDate(summary.fromDay) + " to " + formatDate(summary.toDay) + ":\n";
+    appendTotals(out, summary.income, summary.expense);
+    return out;
+}
+
+static string renderCategoryBreakdown(const CategoryBreakdown& breakdown) {
+    const CategoryDictionary& dict = CategoryDictionary::instance();
+    string out = "Expense by Category for " + formatMonthKey(breakdown.monthKey) + ":\n";
+    for (auto& c : breakdown.expenses) {
+        out += "  ";
+        appendPadded(out, dict.name(c.categoryId), 12);
+        out += ": " + c.amount.toString() + "\n";
+    }
+    return out;
+}
+
+static string renderRecommendations(const Recommendations& recs) {
+    string out = "=== AI-Led Business Recommender for " + formatMonthKey(recs.monthKey) + " ===\n";
+    if (!recs.items.empty() && recs.items[0].code != Advice::NoTransactions)
+        out += "Your savings: " + recs.savings.toString() + "\n";
+    for (auto& r : recs.items) {
+        switch (r.code) {
+        case Advice::NoTransactions:
+            out += "No transactions found for this month.\n";
+            break;
+        case Advice::Overspending:
+            out += "⚠️ You are overspending! Consider reducing non-essential costs.\n";
+            break;
+        case Advice::LowSavings:
+            out += "💡 Your savings are low. Try to set at least 20% of income aside.\n";
+            break;
+        case Advice::HealthySavings:
+            out += "✅ Great! Your savings are healthy this month.\n";
+            break;
+        case Advice::HighCategorySpend:
+            out += "⚠️ High spending in category: " + CategoryDictionary::instance().name(r.categoryId) +
+                   ". Consider optimizing this expense.\n";
+            break;
+        }
+    }
+    return out;
+}
+
+static string renderForecast(const SpendingForecast& f) {
+    const CategoryDictionary& dict = CategoryDictionary::instance();
+    string out = "=== Spending Forecast for " + formatMonthKey(f.monthKey) + " (as of " + formatDate(f.asOfDay) +
+                 ", " + to_string(f.monthsFitted) + " months of history) ===\n";
+    out += "  Income:  " + f.incomeToDate.toString() + " so far, " + f.income.toString() +
+           " by month end, " + f.nextQuarterIncome.toString() + " next quarter\n";
+    out += "  Expense: " + f.expenseToDate.toString() + " so far, " + f.expense.toString() +
+           " by month end, " + f.nextQuarterExpense.toString() + " next quarter\n";
+    for (auto& c : f.expenses) {
+        out += "  ";
+        appendPadded(out, dict.name(c.categoryId), 12);
+        out += ": " + c.monthToDate.toString() + " -> " + c.endOfMonth.toString() + ", next quarter " +
+               c.nextQuarter.toString() + "\n";
+    }
+    return out;
+}
+
+static string renderTransactionRow(const TransactionRow& row) {
+    string out;
+    appendPadded(out, formatDate(row.day), 12);
+    out += " | ";
+    appendPadded(out, row.amount.toString(), 10);
+    out += " | ";
+    appendPadded(out, CategoryDictionary::instance().displayName(row.categoryId), 12);
+    out += " | ";
+    appendPadded(out, row.income ? "Income" : "Expense", 10);
+    out += " | ";
+    out += row.description;
+    return out;
+}
+
+static const char* adviceName(Advice code) {
+    switch (code) {
+    case Advice::NoTransactions: return "no_transactions";
+    case Advice::Overspending: return "overspending";
+    case Advice::LowSavings: return "low_savings";
+    case Advice::HealthySavings: return "healthy_savings";
+    case Advice::HighCategorySpend: return "high_category_spend";
+    }
+    return "unknown";
+}
+
+static const char* alertName(AlertKind kind) {
+    return kind == AlertKind::OverspendPace ? "overspend_pace" : "outlier_expense";
+}
+
+static const char* measureName(RuleMeasure measure) {
+    switch (measure) {
+    case RuleMeasure::Volume: return "volume";
+    case RuleMeasure::Savings: return "savings";
+    case RuleMeasure::SavingsPercent: return "savings_percent";
+    case RuleMeasure::CategoryPercent: return "category_percent";
+    case RuleMeasure::Always: return "always";
+    }
+    return "unknown";
+}
+
+static void appendJsonString(string& out, const string& text) {
+    out += '"';
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += (char)c;
+        } else if (c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof buf, "\\u%04x", c);
+            out += buf;
+        } else {
+            out += (char)c;
+        }
+    }
+    out += '"';
+}
+
+static void appendJsonInt(string& out, int64_t v) {
+    char buf[24];
+    out.append(buf, to_chars(buf, buf + sizeof buf, v).ptr);
+}
+
+static void appendJsonMoney(string& out, const char* key, const Money& m) {
+    out += '"';
+    out += key;
+    out += "\":";
+    appendJsonInt(out, m.minorUnits());
+}
+
+static void appendJson(string& out, const MonthSummary& summary) {
+    out += "{\"month\":";
+    appendJsonString(out, formatMonthKey(summary.monthKey));
+    out += ",\"currency\":";
+    appendJsonString(out, summary.income.currencyName());
+    out += ',';
+    appendJsonMoney(out, "income", summary.income);
+    out += ',';
+    appendJsonMoney(out, "expense", summary.expense);
+    out += '}';
+}
+
+static void appendJson(string& out, const CategoryBreakdown& breakdown) {
+    const CategoryDictionary& dict = CategoryDictionary::instance();
+    out += "{\"month\":";
+    appendJsonString(out, formatMonthKey(breakdown.monthKey));
+    out += ",\"expenses\":[";
+    for (size_t i = 0; i < breakdown.expenses.size(); i++) {
+        if (i) out += ',';
+        out += "{\"category\":";
+        appendJsonString(out, dict.name(breakdown.expenses[i].categoryId));
+        out += ',';
+        appendJsonMoney(out, "amount", breakdown.expenses[i].amount);
+        out += '}';
+    }
+    out += "]}";
+}
+
+static void appendJson(string& out, const Recommendations& recs) {
+    out += "{\"month\":";
+    appendJsonString(out, formatMonthKey(recs.monthKey));
+    out += ',';
+    appendJsonMoney(out, "savings", recs.savings);
+    out += ",\"advice\":[";
+    for (size_t i = 0; i < recs.items.size(); i++) {
+        if (i) out += ',';
+        out += "{\"code\":";
+        appendJsonString(out, adviceName(recs.items[i].code));
+        if (recs.items[i].code == Advice::HighCategorySpend) {
+            out += ",\"category\":";
+            appendJsonString(out, CategoryDictionary::instance().name(recs.items[i].categoryId));
+        }
+        out += '}';
+    }
+    out += "]}";
+}
+
+static void appendJson(string& out, const SpendingForecast& f) {
+    out += "{\"month\":";
+    appendJsonString(out, formatMonthKey(f.monthKey));
+    out += ",\"asOf\":";
+    appendJsonString(out, formatDate(f.asOfDay));
+    out += ",\"monthsFitted\":";
+    appendJsonInt(out, f.monthsFitted);
+    out += ',';
+    appendJsonMoney(out, "incomeToDate", f.incomeToDate);
+    out += ',';
+    appendJsonMoney(out, "expenseToDate", f.expenseToDate);
+    out += ',';
+    appendJsonMoney(out, "income", f.income);
+    out += ',';
+    appendJsonMoney(out, "expense", f.expense);
+    out += ',';
+    appendJsonMoney(out, "nextQuarterIncome", f.nextQuarterIncome);
+    out += ',';
+    appendJsonMoney(out, "nextQuarterExpense", f.nextQuarterExpense);
+    out += ",\"expenses\":[";
+    for (size_t i = 0; i < f.expenses.size(); i++) {
+        const CategoryForecast& c = f.expenses[i];
+        out += i ? ",{\"category\":" : "{\"category\":";
+        appendJsonString(out, CategoryDictionary::instance().name(c.categoryId));
+        out += ',';
+        appendJsonMoney(out, "monthToDate", c.monthToDate);
+        out += ',';
+        appendJsonMoney(out, "endOfMonth", c.endOfMonth);
+        out += ',';
+        appendJsonMoney(out, "nextQuarter", c.nextQuarter);
+        out += '}';
+    }
+    out += "]}";
+}
+
+static void appendJson(string& out, const SpendingAlert& alert) {
+    out += "{\"seq\":";
+    appendJsonInt(out, (int64_t)alert.seq);
+    out += ",\"kind\":";
+    appendJsonString(out, alertName(alert.kind));
+    out += ",\"date\":";
+    appendJsonString(out, formatDate(alert.day));
+    out += ",\"category\":";
+    appendJsonString(out, CategoryDictionary::instance().name(alert.categoryId));
+    out += ',';
+    appendJsonMoney(out, "amount", alert.amount);
+    out += ',';
+    appendJsonMoney(out, "expected", alert.expected);
+    out += '}';
+}
+
+// Categories are case-folded, as they are matched.
+static void appendJson(string& out, const AdviceRule& rule) {
+    out += "{\"advice\":";
+    appendJsonString(out, adviceName(rule.advice));
+    out += ",\"measure\":";
+    appendJsonString(out, measureName(rule.measure));
+    out += rule.above ? ",\"above\":true,\"threshold\":" : ",\"above\":false,\"threshold\":";
+    appendJsonInt(out, rule.threshold);
+    out += ",\"window\":";
+    appendJsonInt(out, rule.windowMonths);
+    out += ",\"category\":";
+    if (rule.category.empty()) out += "null";
+    else appendJsonString(out, foldCase(rule.category));
+    out += ",\"group\":";
+    appendJsonInt(out, rule.group);
+    out += rule.final ? ",\"final\":true}" : ",\"final\":false}";
+}
+
+static void appendJson(string& out, const TransactionRow& row) {
+    out += "{\"date\":";
+    appendJsonString(out, formatDate(row.day));
+    out += ',';
+    appendJsonMoney(out, "amount", row.amount);
+    out += ",\"category\":";
+    appendJsonString(out, CategoryDictionary::instance().displayName(row.categoryId));
+    out += ",\"type\":";
+    out += row.income ? "\"Income\"" : "\"Expense\"";
+    out += ",\"description\":";
+    appendJsonString(out, row.description);
+    out += ",\"row\":";
+    appendJsonInt(out, (int64_t)row.row);
+    out += '}';
+}
+
+// ================= FinanceTracker Class =================
+// Thread-safe: any number of sessions may ingest and query concurrently.
+// Every write holds writeGate shared plus its own user's lock (a
+// registration, the directory shard's), so writers to different users
+// run in parallel; checkpoint() and sealHistory() take
+// writeGate exclusively and pause all writers while they hold it (a seal
+// for as long as it writes the sealed file). Queries read published
+// views and take neither.
+class FinanceTracker {
+    UserDirectory users;
+    SessionTable sessions;
+    unique_ptr<Storage> storage;
+    shared_mutex writeGate;          // writers shared, checkpoint/seal exclusive
+    mutex checkpointMutex;
+    uint64_t checkpointBytes = uint64_t(64) << 20;
+    thread checkpointer;             // checkpoints once the WAL passes checkpointBytes
+    mutex checkpointWake;
+    condition_variable checkpointDue;
+    bool checkpointWanted = false;
+    bool closing = false;
+    unique_ptr<WorkStealingPool> pool;  // started on first org-wide report
+    mutex poolMutex;
+    shared_ptr<const AdviceProgram> advice = make_shared<AdviceProgram>();
+    mutable mutex adviceMutex;          // guards the pointer, not the program
+    vector<User*> adviceQueue;          // appended to since the last refreshAdvice
+    mutex adviceQueueMutex;
+    uint32_t passwordIterations = PasswordHash::kDefaultIterations;
+public:
+    // PBKDF2 iterations for passwords registered from now on; accounts
+    // keep the count they were hashed with. Benchmarks lower it to measure
+    // the directory rather than key stretching. Call before registering.
+    void setPasswordIterations(uint32_t iterations) { passwordIterations = max(iterations, 1u); }
+
+    // Loads the state persisted in dir and logs every later change there.
+    // Call before registering users or logging in.
+    bool openStorage(const string& dir, uint64_t walBytesBeforeCheckpoint = uint64_t(64) << 20) {
+        unique_ptr<Storage> s(new Storage());
+        if (!s->open(dir, users)) return false;
+        storage = move(s);
+        checkpointBytes = walBytesBeforeCheckpoint;
+        checkpointer = thread([this] { runCheckpoints(); });
+        return true;
+    }
+
+    ~FinanceTracker() {
+        if (!checkpointer.joinable()) return;
+        {
+            lock_guard<mutex> l(checkpointWake);
+            closing = true;
+        }
+        checkpointDue.notify_one();
+        checkpointer.join();
+    }
+
+    // Newest WAL sequence number on stable storage; failed is set once the
+    // log has hit an I/O error. Without storage every change counts as
+    // durable.
+    uint64_t durableSeq(bool& failed) const {
+        failed = false;
+        return storage ? storage->durableSeq(failed) : UINT64_MAX;
+    }
+
+    // True once the WAL has hit an I/O error. From then on every write is
+    // refused before it is applied; queries keep working.
+    bool readOnly() const {
+        bool failed = false;
+        durableSeq(failed);
+        return failed;
+    }
+
+    // Runs fn on the WAL flusher thread after each fsync (see
+    // WriteAheadLog::setDurableCallback); nullptr stops it.
+    void onDurable(function<void()> fn) {
+        if (storage) storage->setDurableCallback(move(fn));
+    }
+
+    // Writes a compacted snapshot and retires the WAL it covers. Writers
+    // are paused only while the WAL rotates and ledger lengths are pinned.
+    bool checkpoint() {
+        if (!storage) return false;
+        lock_guard<mutex> serial(checkpointMutex);
+        Storage::Image image;
+        {
+            unique_lock<shared_mutex> pause(writeGate);
+            if (!storage->beginCheckpoint(users, image)) return false;
+        }
+        return storage->finishCheckpoint(image);
+    }
+
+    // Moves u's rows from months before `month` (YYYY-MM) into a read-only
+    // memory-mapped file at path. With storage attached the seal is logged
+    // before the WAL rotates for a checkpoint in the same writer pause:
+    // until that snapshot lands, recovery replays the seal ahead of the
+    // records that use its row numbers.
+    bool sealHistory(const string& u, const string& month, const string& path) {
+        User* user = findUser(u);
+        int32_t key = monthKeyOf(month);
+        if (!user || key < 0) return false;
+        lock_guard<mutex> serial(checkpointMutex);
+        Storage::Image image;
+        uint64_t seq = 0;
+        {
+            unique_lock<shared_mutex> pause(writeGate);
+            if (readOnly() || !user->sealBefore(key, path)) return false;
+            if (storage) {
+                seq = storage->logSeal(u, key, path);
+                if (!storage->beginCheckpoint(users, image)) return false;
+            }
+        }
+        return !storage || (storage->waitDurable(seq) && storage->finishCheckpoint(image));
+    }
+
+    // currency is the ISO 4217 code every amount of this user is kept in.
+    // The writes below wait until their change is durable, unless given
+    // `logged`: then they return once it is applied and logged, and
+    // *logged receives the WAL sequence number to check against
+    // durableSeq (0 if nothing was logged).
+    //
+    // A write that returns false has had one of two outcomes:
+    //  - not applied: bad input, or readOnly() was already true, which each
+    //    write checks under the write gate before touching anything;
+    //  - applied but not durable: the WAL failed after the write passed
+    //    that check, so its record never reached disk. The change stays
+    //    visible until a restart, which drops it, and readOnly() is now
+    //    true. Retrying is refused rather than applied twice.
+    bool registerUser(const string& u, const string& p, const string& currency = "USD",
+                      uint64_t* logged = nullptr) {
+        uint32_t code = Money::currencyCode(currency);
+        PasswordHash hash;
+        if (!code || findUser(u) || !PasswordHash::derive(p, passwordIterations, hash)) return false;
+        uint64_t seq = 0;
+        {
+            shared_lock<shared_mutex> gate(writeGate);
+            if (readOnly()) return false;
+            bool added = users.insert(u, hash, code, [&] {
+                if (storage) seq = storage->logRegister(u, hash, code);
+            });
+            if (!added) return false;
+        }
+        return commit(seq, logged);
+    }
+
+    // Registers (username, password) pairs; returns how many were new.
+    size_t registerUsers(const vector<pair<string, string>>& accounts) {
+        vector<pair<string, PasswordHash>> hashed(accounts.size());
+        for (size_t i = 0; i < accounts.size(); i++) {
+            hashed[i].first = accounts[i].first;
+            if (!PasswordHash::derive(accounts[i].second, passwordIterations, hashed[i].second))
+                return 0;
+        }
+        size_t count;
+        uint64_t seq = 0;
+        {
+            shared_lock<shared_mutex> gate(writeGate);
+            if (readOnly()) return 0;
+            count = users.insertAll(hashed, [&](size_t i) {
+                if (storage) seq = storage->logRegister(hashed[i].first, hashed[i].second, Money::kUSD);
+            });
+        }
+        commit(seq);
+        return count;
+    }
+
+    // Returns a new session handle, or the zero ID if the credentials are
+    // wrong (or no random ID could be drawn).
+    SessionId loginUser(const string& u, const string& p) {
+        User* user = findUser(u);
+        if (user && user->checkPassword(p)) return sessions.open(user);
+        return SessionId{};
+    }
+
+    void logoutUser(SessionId session) { sessions.close(session); }
+
+    User* getSessionUser(SessionId session) const { return sessions.find(session); }
+
+    // amount is in major units of the user's currency.
+    bool addTransaction(SessionId session, const string& date, double amount,
+                        const string& category, const string& desc, const string& type) {
+        User* user = sessions.find(session);
+        if (!user) return false;
+        return addTransaction(session, date, Money::fromMajor(amount, user->getCurrency()),
+                              category, desc, type);
+    }
+
+    // Returns false if the session is not logged in, the date is not a
+    // valid YYYY-MM-DD calendar date, amount is in another currency or the
+    // user has User::kMaxRows rows.
+    bool addTransaction(SessionId session, const string& date, Money amount,
+                        const string& category, const string& desc, const string& type,
+                        uint64_t* logged = nullptr) {
+        User* user = sessions.find(session);
+        if (!user || amount.currencyCode() != user->getCurrency()) return false;
+
+        int32_t day = packDate(date);
+        if (day == kInvalidDay) return false;
+        int64_t cents = amount.minorUnits();
+        bool income = foldCase(type) == "income";
+        uint32_t categoryId = CategoryDictionary::instance().intern(category);
+        if (categoryId == CategoryDictionary::kNoId) return false;
+        uint64_t seq = 0;
+        {
+            shared_lock<shared_mutex> gate(writeGate);
+            if (readOnly()) return false;
+            bool added = user->appendRow(day, cents, categoryId, desc, income, [&] {
+                if (storage)
+                    seq = storage->logTransaction(user->getUsername(), day, cents, category, desc, income);
+            });
+            if (!added) return false;
+        }
+        queueForAdvice(user);
+        return commit(seq, logged);
+    }
+
+    // Deletes the row numbered `row` in the listing (TransactionRow::row).
+    // False if the session is not logged in or the row is sealed, already
+    // deleted or past the end.
+    bool deleteTransaction(SessionId session, uint64_t row, uint64_t* logged = nullptr) {
+        User* user = sessions.find(session);
+        if (!user) return false;
+        uint64_t seq = 0;
+        bool ok;
+        {
+            shared_lock<shared_mutex> gate(writeGate);
+            ok = !readOnly() && user->deleteRow(row, [&] {
+                if (storage) seq = storage->logDelete(user->getUsername(), row);
+            });
+        }
+        if (!ok) return false;
+        queueForAdvice(user);
+        return commit(seq, logged);
+    }
+
+    // Replaces a row, as for deleteTransaction; the new row is appended and
+    // gets the next row number. Also false for an invalid date or currency.
+    bool editTransaction(SessionId session, uint64_t row, const string& date, Money amount,
+                         const string& category, const string& desc, const string& type,
+                         uint64_t* logged = nullptr) {
+        User* user = sessions.find(session);
+        int32_t day = packDate(date);
+        if (!user || day == kInvalidDay || amount.currencyCode() != user->getCurrency()) return false;
+        int64_t cents = amount.minorUnits();
+        bool income = foldCase(type) == "income";
+        uint32_t categoryId = CategoryDictionary::instance().intern(category);
+        if (categoryId == CategoryDictionary::kNoId) return false;
+        uint64_t seq = 0;
+        bool ok;
+        {
+            shared_lock<shared_mutex> gate(writeGate);
+            ok = !readOnly() && user->editRow(row, day, cents, categoryId, desc, income, [&] {
+                if (storage)
+                    seq = storage->logEdit(user->getUsername(), row, day, cents, category, desc, income);
+            });
+        }
+        if (!ok) return false;
+        queueForAdvice(user);
+        return commit(seq, logged);
+    }
+
+    // Reverts the newest edit or delete not yet undone, among the last
+    // 1024 since the last restart or seal; false if there is none.
+    bool undoLastChange(SessionId session, uint64_t* logged = nullptr) {
+        User* user = sessions.find(session);
+        if (!user) return false;
+        uint64_t seq = 0;
+        bool ok;
+        {
+            shared_lock<shared_mutex> gate(writeGate);
+            ok = !readOnly() && user->undo([&](uint64_t restored, uint64_t removed) {
+                if (storage) seq = storage->logUndo(user->getUsername(), restored, removed);
+            });
+        }
+        if (!ok) return false;
+        queueForAdvice(user);
+        return commit(seq, logged);
+    }
+
+    // Bulk-appends a CSV export to the session's ledger; with storage
+    // attached each parsed chunk becomes one WAL record. Chunks parsed
+    // after the tracker turns read-only, or that would take the user past
+    // User::kMaxRows, are dropped and not counted as accepted.
+    ImportStats importCsv(SessionId session, const string& path,
+                          const ImportOptions& options = ImportOptions()) {
+        User* user = sessions.find(session);
+        if (!user || readOnly()) return ImportStats();
+        string name = user->getUsername();
+        uint64_t seq = 0, refused = 0;
+        ImportStats stats = CsvImporter::run(path, options, [&](const ImportBatch& batch) {
+            shared_lock<shared_mutex> gate(writeGate);
+            bool added = !readOnly() && user->appendBatch(batch, [&] {
+                if (storage) seq = storage->logBatch(name, batch);
+            });
+            if (!added) refused += batch.size();
+        });
+        stats.rowsAccepted -= refused;
+        if (stats.rowsAccepted) queueForAdvice(user);
+        stats.ok = commit(seq) && stats.ok && !refused;
+        return stats;
+    }
+
+    // Structured queries: false if the session is not logged in.
+    bool listTransactions(SessionId session, vector<TransactionRow>& out) const {
+        User* user = sessions.find(session);
+        if (!user) return false;
+        out = user->listTransactions();
+        return true;
+    }
+
+    bool summarizeMonth(SessionId session, const string& month, MonthSummary& out) const {
+        User* user = sessions.find(session);
+        if (!user) return false;
+        out = user->summarizeMonth(monthKeyOf(month));
+        return true;
+    }
+
+    bool categoryBreakdown(SessionId session, const string& month, CategoryBreakdown& out) const {
+        User* user = sessions.find(session);
+        if (!user) return false;
+        out = user->categoryBreakdown(monthKeyOf(month));
+        return true;
+    }
+
+    // Versions: the ledger after each edit, delete or undo (see
+    // LedgerVersion), the last User::kMaxVersions of them kept. False if
+    // the session is not logged in or the version is not held.
+    bool currentVersion(SessionId session, uint64_t& out) const {
+        User* user = sessions.find(session);
+        if (!user) return false;
+        out = user->currentVersion();
+        return true;
+    }
+
+    bool summarizeMonthAt(SessionId session, uint64_t version, const string& month,
+                          MonthSummary& out) const {
+        User* user = sessions.find(session);
+        shared_ptr<const LedgerVersion> v = user ? user->version(version) : nullptr;
+        if (!v) return false;
+        out = v->summarizeMonth(monthKeyOf(month));
+        return true;
+    }
+
+    bool categoryBreakdownAt(SessionId session, uint64_t version, const string& month,
+                             CategoryBreakdown& out) const {
+        User* user = sessions.find(session);
+        shared_ptr<const LedgerVersion> v = user ? user->version(version) : nullptr;
+        if (!v) return false;
+        out = v->categoryBreakdown(monthKeyOf(month));
+        return true;
+    }
+
+    bool listTransactionsAt(SessionId session, uint64_t version, vector<TransactionRow>& out) const {
+        User* user = sessions.find(session);
+        return user && user->listVersion(version, out);
+    }
+
+    bool recommend(SessionId session, const string& month, Recommendations& out) const {
+        User* user = sessions.find(session);
+        if (!user) return false;
+        out = user->recommend(monthKeyOf(month), *adviceProgram());
+        return true;
+    }
+
+    // End-of-month and next-quarter projections as of asOf (YYYY-MM-DD,
+    // empty for today); false if the session or the date is invalid.
+    bool forecast(SessionId session, const string& asOf, SpendingForecast& out) const {
+        User* user = sessions.find(session);
+        int32_t day = asOf.empty() ? todayDay() : packDate(asOf);
+        if (!user || day == kInvalidDay) return false;
+        out = user->forecast(day);
+        return true;
+    }
+
+    // Forecasts for every user, spread over the analytics pool. Each user's
+    // model is cached, so repeat runs only fold in newly closed months.
+    vector<AccountForecast> forecastAll(const string& asOf = "") {
+        int32_t day = asOf.empty() ? todayDay() : packDate(asOf);
+        vector<User*> members = users.all();
+        vector<AccountForecast> results(day == kInvalidDay ? 0 : members.size());
+        lock_guard<mutex> l(poolMutex);
+        if (!pool) pool.reset(new WorkStealingPool(thread::hardware_concurrency()));
+        pool->parallelFor(results.size(), [&](size_t i, size_t) {
+            results[i].username = members[i]->getUsername();
+            results[i].forecast = members[i]->forecast(day);
+        });
+        return results;
+    }
+
+    // Spending Monitor alerts raised for the session's user with seq >
+    // after, oldest first; false if the session is not logged in.
+    bool spendingAlerts(SessionId session, vector<SpendingAlert>& out, uint64_t after = 0) const {
+        User* user = sessions.find(session);
+        if (!user) return false;
+        out = user->spendingAlerts(after);
+        return true;
+    }
+
+    // Replaces the advice rules for every user; cached advice is dropped
+    // lazily. False, keeping the current rules, if a rule does not compile.
+    bool setAdviceRules(const vector<AdviceRule>& rules) {
+        shared_ptr<AdviceProgram> program = make_shared<AdviceProgram>();
+        if (!program->compile(rules)) return false;
+        lock_guard<mutex> l(adviceMutex);
+        advice = move(program);
+        return true;
+    }
+
+    vector<AdviceRule> getAdviceRules() const { return adviceProgram()->rules(); }
+
+    // Advice for each month an addTransaction or importCsv has made stale
+    // since the last call (a month, and the months whose windows reach
+    // back to it), per user appended to. Users are evaluated in parallel
+    // from their rollups; untouched users and months cost nothing.
+    vector<AccountAdvice> refreshAdvice() {
+        vector<User*> queued;
+        {
+            lock_guard<mutex> l(adviceQueueMutex);
+            queued.swap(adviceQueue);
+        }
+        shared_ptr<const AdviceProgram> program = adviceProgram();
+        vector<AccountAdvice> results(queued.size());
+        {
+            lock_guard<mutex> l(poolMutex);
+            if (!pool) pool.reset(new WorkStealingPool(thread::hardware_concurrency()));
+            pool->parallelFor(queued.size(), [&](size_t i, size_t) {
+                queued[i]->clearAdviceQueued();
+                results[i].username = queued[i]->getUsername();
+                queued[i]->refreshAdvice(*program, results[i].months);
+            });
+        }
+        results.erase(remove_if(results.begin(), results.end(),
+                                [](const AccountAdvice& a) { return a.months.empty(); }),
+                      results.end());
+        return results;
+    }
+
+    // One page of the transaction listing formatted into buf; false if
+    // the session is not logged in.
+    bool formatTransactionPage(SessionId session, const PageRequest& request, char* buf,
+                               size_t cap, PageResult& result) const {
+        User* user = sessions.find(session);
+        if (!user) return false;
+        user->formatPage(request, buf, cap, result);
+        return true;
+    }
+
+    bool listTransactionPage(SessionId session, const PageRequest& request,
+                             vector<TransactionRow>& rows, PageResult& result) const {
+        User* user = sessions.find(session);
+        if (!user) return false;
+        user->pageRows(request, rows, result);
+        return true;
+    }
+
+    // Text forms of the above; empty if the session is not logged in.
+    vector<string> getTransactionStrings(SessionId session) const {
+        vector<TransactionRow> rows;
+        vector<string> result;
+        if (!listTransactions(session, rows)) return result;
+        result.reserve(rows.size());
+        for (auto& row : rows) result.push_back(renderTransactionRow(row));
+        return result;
+    }
+
+    string getSummaryByMonth(SessionId session, const string& month) const {
+        MonthSummary summary;
+        return summarizeMonth(session, month, summary) ? renderSummary(summary) : string();
+    }
+
+    string getCategoryAnalytics(SessionId session, const string& month) const {
+        CategoryBreakdown breakdown;
+        return categoryBreakdown(session, month, breakdown) ? renderCategoryBreakdown(breakdown)
+                                                            : string();
+    }
+
+    string getBusinessRecommendations(SessionId session, const string& month) const {
+        Recommendations recs;
+        return recommend(session, month, recs) ? renderRecommendations(recs) : string();
+    }
+
+    string getSpendingForecast(SessionId session, const string& asOf = "") const {
+        SpendingForecast f;
+        return forecast(session, asOf, f) ? renderForecast(f) : string();
+    }
+
+    // Range queries. Dates are YYYY-MM-DD and ranges inclusive; an empty
+    // asOf means today (UTC). False if the session or a date is invalid.
+    bool summarizeRange(SessionId session, const string& from, const string& to,
+                        RangeSummary& out) const {
+        User* user = sessions.find(session);
+        int32_t fromDay = packDate(from), toDay = packDate(to);
+        if (!user || fromDay == kInvalidDay || toDay == kInvalidDay) return false;
+        out = user->summarizeRange(fromDay, toDay);
+        return true;
+    }
+
+    // The trailing window of `days` days ending on asOf, e.g. 30, 90 or 365.
+    bool summarizeTrailing(SessionId session, int days, const string& asOf, RangeSummary& out) const {
+        User* user = sessions.find(session);
+        int32_t toDay = asOf.empty() ? todayDay() : packDate(asOf);
+        if (!user || toDay == kInvalidDay || days < 1) return false;
+        out = user->summarizeRange(toDay - (days - 1), toDay);
+        return true;
+    }
+
+    // January 1st of asOf's year through asOf.
+    bool summarizeYearToDate(SessionId session, const string& asOf, RangeSummary& out) const {
+        User* user = sessions.find(session);
+        int32_t toDay = asOf.empty() ? todayDay() : packDate(asOf);
+        if (!user || toDay == kInvalidDay) return false;
+        int y, m, d;
+        civilFromDays(toDay, y, m, d);
+        out = user->summarizeRange(daysFromCivil(y, 1, 1), toDay);
+        return true;
+    }
+
+    string getSummaryForRange(SessionId session, const string& from, const string& to) const {
+        RangeSummary summary;
+        return summarizeRange(session, from, to, summary) ? renderSummary(summary) : string();
+    }
+
+    string getTrailingSummary(SessionId session, int days, const string& asOf = "") const {
+        RangeSummary summary;
+        return summarizeTrailing(session, days, asOf, summary) ? renderSummary(summary) : string();
+    }
+
+    string getYearToDateSummary(SessionId session, const string& asOf = "") const {
+        RangeSummary summary;
+        return summarizeYearToDate(session, asOf, summary) ? renderSummary(summary) : string();
+    }
+
+    User* findUser(const string& u) const {
+        return users.find(u);
+    }
+
+    // Threads used by org-wide reports (default: one per core).
+    void setAnalyticsThreads(size_t threads) {
+        lock_guard<mutex> l(poolMutex);
+        pool.reset(new WorkStealingPool(threads));
+    }
+
+    // Org-wide report over every user whose currency is `currency`: expense
+    // per category for every month, plus the savings-rate distribution and
+    // the topN overspenders for `month`. Users are split into tasks for
+    // their open months and for chunks of their sealed history.
+    OrgReport buildOrgReport(const string& month, const string& currency = "USD",
+                             size_t topN = 10) {
+        OrgReport report;
+        report.currency = Money::currencyCode(currency);
+        report.monthKey = monthKeyOf(month);
+
+        struct Task {
+            uint32_t user;
+            const SealedLedger* segment;    // null: open months + month totals
+            uint32_t firstMonth, lastMonth;
+        };
+        const uint32_t kRowsPerTask = 1 << 16;
+        vector<User*> members;
+        vector<Task> tasks;
+        for (User* user : users.all()) {
+            if (user->getCurrency() != report.currency) continue;
+            uint32_t index = (uint32_t)members.size();
+            members.push_back(user);
+            tasks.push_back(Task{index, nullptr, 0, 0});
+            for (const SealedLedger* segment : user->getSealedSegments()) {
+                uint32_t first = 0, rows = 0;
+                for (uint32_t m = 0; m < segment->monthCount(); m++) {
+                    rows += segment->monthRowCount(m);
+                    if (rows >= kRowsPerTask || m + 1 == segment->monthCount()) {
+                        tasks.push_back(Task{index, segment, first, m + 1});
+                        first = m + 1;
+                        rows = 0;
+                    }
+                }
+            }
+        }
+        report.users = members.size();
+
+        struct alignas(64) Partial {
+            unordered_map<int32_t, vector<int64_t>> expenseByMonth;
+        };
+        vector<pair<int64_t, int64_t>> monthTotals(members.size());
+        {
+            lock_guard<mutex> l(poolMutex);
+            if (!pool) pool.reset(new WorkStealingPool(thread::hardware_concurrency()));
+            vector<Partial> partials(pool->size());
+            pool->parallelFor(tasks.size(), [&](size_t t, size_t worker) {
+                const Task& task = tasks[t];
+                auto& table = partials[worker].expenseByMonth;
+                if (!task.segment) {
+                    User* user = members[task.user];
+                    user->getMonthTotals(report.monthKey, monthTotals[task.user].first,
+                                         monthTotals[task.user].second);
+                    user->addExpenseByMonth(table);
+                    return;
+                }
+                for (uint32_t m = task.firstMonth; m < task.lastMonth; m++) {
+                    int64_t income = 0, expense = 0;
+                    task.segment->addMonth(task.segment->monthKeyAt(m), income, expense,
+                                           &table[task.segment->monthKeyAt(m)]);
+                }
+            });
+            for (auto& partial : partials) {
+                for (auto& cell : partial.expenseByMonth) {
+                    vector<int64_t>& merged = report.expenseByMonth[cell.first];
+                    if (merged.size() < cell.second.size()) merged.resize(cell.second.size(), 0);
+                    for (size_t id = 0; id < cell.second.size(); id++) merged[id] += cell.second[id];
+                }
+            }
+        }
+
+        vector<OrgReport::Overspender> over;
+        for (size_t i = 0; i < members.size(); i++) {
+            int64_t income = monthTotals[i].first, expense = monthTotals[i].second;
+            report.income += income;
+            report.expense += expense;
+            if (expense > income) over.push_back({members[i]->getUsername(), expense - income});
+            if (income <= 0) {
+                report.usersWithoutIncome++;
+            } else if (expense > income) {
+                report.savingsRateBuckets[0]++;
+            } else {
+                int decile = (int)((double)(income - expense) * 10 / income);
+                report.savingsRateBuckets[1 + min(decile, 9)]++;
+            }
+        }
+        size_t keep = min(topN, over.size());
+        partial_sort(over.begin(), over.begin() + keep, over.end(),
+                     [](const OrgReport::Overspender& a, const OrgReport::Overspender& b) {
+                         return a.overspend != b.overspend ? a.overspend > b.overspend
+                                                           : a.username < b.username;
+                     });
+        over.resize(keep);
+        report.topOverspenders = move(over);
+        return report;
+    }
+
+    size_t getUserCount() const { return users.size(); }
+
+    vector<string> getAllUsernames() const {
+        vector<string> usernames;
+        for (auto user : users.all()) {
+            usernames.push_back(user->getUsername());
+        }
+        return usernames;
+    }
+
+private:
+    shared_ptr<const AdviceProgram> adviceProgram() const {
+        lock_guard<mutex> l(adviceMutex);
+        return advice;
+    }
+
+    void queueForAdvice(User* user) {
+        if (!user->markAdviceQueued()) return;
+        lock_guard<mutex> l(adviceQueueMutex);
+        adviceQueue.push_back(user);
+    }
+
+    // Waits for a logged change to become durable, or with `logged` just
+    // hands its sequence number back. Once the WAL has grown past the
+    // configured size the checkpointer is woken; the writer never runs the
+    // checkpoint itself.
+    bool commit(uint64_t seq, uint64_t* logged = nullptr) {
+        if (logged) *logged = seq;
+        if (!storage || seq == 0) return true;
+        bool ok = logged || storage->waitDurable(seq);
+        if (storage->walBytes() >= checkpointBytes) {
+            lock_guard<mutex> l(checkpointWake);
+            checkpointWanted = true;
+            checkpointDue.notify_one();
+        }
+        return ok;
+    }
+
+    // The checkpointer thread: one checkpoint at a time, each re-checking
+    // the WAL size since requests keep arriving while one runs. A failed
+    // checkpoint leaves the WAL in place, so nothing is lost.
+    void runCheckpoints() {
+        unique_lock<mutex> l(checkpointWake);
+        for (;;) {
+            checkpointDue.wait(l, [&] { return checkpointWanted || closing; });
+            if (closing) return;
+            checkpointWanted = false;
+            l.unlock();
+            if (storage->walBytes() >= checkpointBytes) checkpoint();
+            l.lock();
+        }
+    }
+};
+
+// ==================== HTML GUI GENERATOR ====================
+
+// Static parts of the dashboard page. A page is these blobs joined by
+// short tags around its generated data region, so writing one costs a
+// single vectored write instead of a stream insertion per line. Styles and
+// script are either inlined or, for batch reports, shared asset files.
+static constexpr string_view kDashboardHead = R"PFT(<!DOCTYPE html>
+<html lang="en">
+<head>
+    <meta charset="UTF-8">
+    <meta name="viewport" content="width=device-width, initial-scale=1.0">
+    <title>🚀 AI-Powered Finance Tracker - OOP Demonstration</title>
+    <link href="https://fonts.googleapis.com/css2?family=Orbitron:wght@400;500;700;900&family=Exo+2:wght@300;400;500;600;700&display=swap" rel="stylesheet">
+    <script src="https://cdn.jsdelivr.net/npm/chart.js"></script>
+)PFT";
+
+static constexpr string_view kDashboardStyles = R"PFT(        * { margin: 0; padding: 0; box-sizing: border-box; }
+        :root {
+            --primary: #00f2fe; --secondary: #4facfe; --accent: #00ff88;
+            --danger: #ff2d75; --dark: #0a0a1a; --darker: #050510;
+            --card-bg: rgba(16, 18, 27, 0.8); --glass: rgba(255, 255, 255, 0.05);
+            --neon-glow: 0 0 20px var(--primary);
+        }
+        body {
+            font-family: 'Exo 2', sans-serif;
+            background: linear-gradient(135deg, var(--darker) 0%, var(--dark) 50%, #0f1b2b 100%);
+            color: #ffffff; min-height: 100vh; overflow-x: hidden; position: relative;
+        }
+        .container { max-width: 1400px; margin: 0 auto; padding: 20px; }
+        .header {
+            text-align: center; padding: 40px 20px; background: var(--card-bg);
+            backdrop-filter: blur(20px); border: 1px solid var(--glass);
+            border-radius: 24px; margin-bottom: 40px; position: relative;
+            overflow: hidden; box-shadow: 0 8px 32px rgba(0, 0, 0, 0.3);
+        }
+        .header h1 {
+            font-family: 'Orbitron', monospace; font-size: 3em; font-weight: 900;
+            margin-bottom: 10px; background: linear-gradient(135deg, var(--primary), var(--secondary), var(--accent));
+            -webkit-background-clip: text; -webkit-text-fill-color: transparent;
+            text-shadow: var(--neon-glow); letter-spacing: 2px;
+        }
+        .tabs { display: flex; gap: 15px; margin-bottom: 40px; flex-wrap: wrap; justify-content: center; }
+        .tab {
+            padding: 15px 25px; background: var(--card-bg); backdrop-filter: blur(10px);
+            border: 1px solid var(--glass); border-radius: 15px; cursor: pointer;
+            font-family: 'Orbitron', monospace; font-size: 14px; font-weight: 500;
+            color: #fff; transition: all 0.3s cubic-bezier(0.4, 0, 0.2, 1);
+            position: relative; overflow: hidden;
+        }
+        .tab:hover { transform: translateY(-5px) scale(1.05); border-color: var(--primary); box-shadow: var(--neon-glow); }
+        .tab.active { background: linear-gradient(135deg, var(--primary), var(--secondary)); border-color: transparent; box-shadow: var(--neon-glow); transform: translateY(-2px); }
+        .tab-content { display: none; animation: fadeIn 0.5s ease-out; }
+        .tab-content.active { display: block; }
+        @keyframes fadeIn { from { opacity: 0; transform: translateY(20px); } to { opacity: 1; transform: translateY(0); } }
+        .stats-grid { display: grid; grid-template-columns: repeat(auto-fit, minmax(250px, 1fr)); gap: 20px; margin-bottom: 40px; }
+        .stat-card {
+            background: var(--card-bg); backdrop-filter: blur(20px); padding: 25px;
+            border-radius: 20px; border: 1px solid var(--glass); position: relative;
+            overflow: hidden; transition: all 0.3s cubic-bezier(0.4, 0, 0.2, 1);
+            cursor: pointer;
+        }
+        .stat-card:hover { transform: translateY(-8px) scale(1.02); border-color: var(--primary); box-shadow: 0 15px 30px rgba(0, 242, 254, 0.2); }
+        .stat-card h3 { font-size: 12px; opacity: 0.7; margin-bottom: 12px; font-weight: 400; text-transform: uppercase; letter-spacing: 1px; }
+        .stat-card .value { font-size: 32px; font-weight: 700; font-family: 'Orbitron', monospace; background: linear-gradient(135deg, var(--primary), var(--accent)); -webkit-background-clip: text; -webkit-text-fill-color: transparent; }
+        .card { background: var(--card-bg); backdrop-filter: blur(20px); padding: 30px; border-radius: 20px; border: 1px solid var(--glass); margin-bottom: 25px; position: relative; overflow: hidden; transition: all 0.3s ease; }
+        .card:hover { border-color: var(--primary); box-shadow: 0 12px 25px rgba(0, 242, 254, 0.1); }
+        .card h2 { margin-bottom: 25px; font-size: 24px; font-family: 'Orbitron', monospace; color: var(--primary); display: flex; align-items: center; gap: 12px; }
+        .grid-2 { display: grid; grid-template-columns: 1fr 1fr; gap: 25px; }
+        .form-group { margin-bottom: 20px; position: relative; }
+        .form-group label { display: block; margin-bottom: 10px; font-weight: 600; color: var(--primary); font-family: 'Orbitron', monospace; }
+        .form-group input, .form-group select {
+            width: 100%; padding: 15px; border-radius: 12px; border: 2px solid var(--glass);
+            background: rgba(255, 255, 255, 0.05); color: #fff; font-size: 14px;
+            font-family: 'Exo 2', sans-serif; transition: all 0.3s ease;
+        }
+        .form-group input:focus, .form-group select:focus {
+            outline: none; border-color: var(--primary); box-shadow: 0 0 15px rgba(0, 242, 254, 0.3);
+            background: rgba(255, 255, 255, 0.08);
+        }
+        .btn {
+            padding: 15px 30px; background: linear-gradient(135deg, var(--primary), var(--secondary));
+            border: none; border-radius: 12px; color: #fff; font-size: 14px;
+            font-weight: 600; font-family: 'Orbitron', monospace; cursor: pointer;
+            transition: all 0.3s cubic-bezier(0.4, 0, 0.2, 1); position: relative;
+            overflow: hidden; text-transform: uppercase; letter-spacing: 1px;
+        }
+        .btn:hover { transform: translateY(-3px) scale(1.05); box-shadow: 0 8px 20px rgba(0, 242, 254, 0.4); }
+        .notification {
+            position: fixed; top: 20px; right: 20px; padding: 20px 25px; border-radius: 12px;
+            font-weight: 600; display: none; z-index: 10000; animation: slideInRight 0.5s cubic-bezier(0.4, 0, 0.2, 1);
+            backdrop-filter: blur(20px); border: 1px solid var(--glass); font-family: 'Orbitron', monospace;
+        }
+        .notification.success { background: linear-gradient(135deg, var(--accent), #00cc6a); box-shadow: 0 8px 25px rgba(0, 255, 136, 0.3); }
+        .notification.error { background: linear-gradient(135deg, var(--danger), #ff1a6c); box-shadow: 0 8px 25px rgba(255, 45, 117, 0.3); }
+        .output-console { 
+            width: 100%; height: 400px; background: rgba(0, 0, 0, 0.3); 
+            border-radius: 15px; border: 1px solid var(--glass); 
+            padding: 20px; overflow-y: auto; font-family: 'Courier New', monospace;
+            font-size: 14px; color: #00ff88; margin-top: 20px;
+        }
+        .user-card { background: linear-gradient(135deg, var(--card-bg), rgba(16, 18, 27, 0.6)); padding: 20px; border-radius: 15px; border: 1px solid var(--glass); position: relative; overflow: hidden; transition: all 0.3s cubic-bezier(0.4, 0, 0.2, 1); cursor: pointer; margin: 12px 0; }
+        .user-card:hover { transform: translateY(-5px) scale(1.02); border-color: var(--primary); box-shadow: 0 12px 25px rgba(0, 242, 254, 0.2); }
+        table { width: 100%; border-collapse: collapse; margin-top: 20px; }
+        th, td { padding: 12px; text-align: left; border-bottom: 1px solid rgba(255, 255, 255, 0.1); }
+        th { background: rgba(0, 242, 254, 0.1); font-weight: 600; font-family: 'Orbitron', monospace; color: var(--primary); }
+        tr:hover { background: rgba(0, 242, 254, 0.05); }
+        @media (max-width: 1200px) { .grid-2 { grid-template-columns: 1fr; } .header h1 { font-size: 2.5em; } }
+)PFT";
+
+// Markup for every tab.
+static constexpr string_view kDashboardBody = R"PFT(<body>
+    <div class="container">
+        <div class="header">
+            <h1>🚀 AI-Powered Finance Tracker</h1>
+            <p>Object-Oriented Programming Demonstration | Inheritance • Encapsulation • Polymorphism • Abstraction</p>
+        </div>
+        <div class="tabs">
+            <button class="tab active" onclick="showTab('dashboard')">📊 DASHBOARD</button>
+            <button class="tab" onclick="showTab('auth')">🔐 AUTHENTICATION</button>
+            <button class="tab" onclick="showTab('transactions')">💳 TRANSACTIONS</button>
+            <button class="tab" onclick="showTab('analytics')">📈 AI ANALYTICS</button>
+            <button class="tab" onclick="showTab('oop')">⚙️ OOP FEATURES</button>
+        </div>
+        <div id="notification" class="notification"></div>
+        <div id="dashboard" class="tab-content active">
+            <div class="stats-grid">
+                <div class="stat-card">
+                    <h3>OOP Principles</h3>
+                    <div class="value">4/4</div>
+                </div>
+                <div class="stat-card">
+                    <h3>Class Hierarchy</h3>
+                    <div class="value">3 Levels</div>
+                </div>
+                <div class="stat-card">
+                    <h3>AI Features</h3>
+                    <div class="value">Smart Analysis</div>
+                </div>
+                <div class="stat-card">
+                    <h3>Security</h3>
+                    <div class="value">Encrypted</div>
+                </div>
+            </div>
+            
+            <div class="grid-2">
+                <div class="card">
+                    <h2>🎯 OOP ARCHITECTURE OVERVIEW</h2>
+                    <div style="padding: 20px; background: rgba(0, 242, 254, 0.1); border-radius: 12px;">
+                        <h3 style="color: var(--accent); margin-bottom: 15px;">Class Hierarchy:</h3>
+                        <ul style="list-style: none; line-height: 2;">
+                            <li>🏗️ <strong>Transaction</strong> (Base Abstract Class)</li>
+                            <li>  ├── 💰 <strong>Income</strong> (Derived Class)</li>
+                            <li>  └── 💸 <strong>Expense</strong> (Derived Class)</li>
+                            <li>👤 <strong>User</strong> (Composition & Encapsulation)</li>
+                            <li>🏢 <strong>FinanceTracker</strong> (Main Controller)</li>
+                        </ul>
+                    </div>
+                </div>
+                <div class="card">
+                    <h2>🚀 REAL-TIME OUTPUT</h2>
+                    <div id="outputConsole" class="output-console">
+🌌 WELCOME TO AI-POWERED FINANCE TRACKER
+========================================
+🚀 OOP Features Demonstrated:
+  • Inheritance: Transaction → Income/Expense
+  • Encapsulation: Private user data
+  • Polymorphism: Virtual getType() method
+  • Abstraction: Simple public interfaces
+
+💡 Register or Login to get started!
+                    </div>
+                </div>
+            </div>
+        </div>
+        <div id="auth" class="tab-content">
+            <div class="grid-2">
+                <div class="card">
+                    <h2>🔐 USER AUTHENTICATION</h2>
+                    <div class="form-group">
+                        <label>👤 USERNAME</label>
+                        <input type="text" id="username" placeholder="Enter your username">
+                    </div>
+                    <div class="form-group">
+                        <label>🔑 PASSWORD</label>
+                        <input type="password" id="password" placeholder="Enter your password">
+                    </div>
+                    <div style="display: flex; gap: 15px; margin-top: 25px;">
+                        <button class="btn" onclick="login()">🚀 LOGIN</button>
+                        <button class="btn" onclick="register()">📝 REGISTER</button>
+                    </div>
+                </div>
+                <div class="card">
+                    <h2>👥 REGISTERED USERS</h2>
+                    <div id="userList" style="max-height: 300px; overflow-y: auto;">
+                        <div class="user-card">
+                            <h3>No users registered yet</h3>
+                            <p>Register new users to see them here</p>
+                        </div>
+                    </div>
+                    <div id="currentUser" style="margin-top: 20px; padding: 15px; background: rgba(0, 255, 136, 0.1); border-radius: 10px; display: none;">
+                        <strong>👤 Current User: <span id="currentUserName"></span></strong>
+                    </div>
+                </div>
+            </div>
+        </div>
+        <div id="transactions" class="tab-content">
+            <div class="grid-2">
+                <div class="card">
+                    <h2>💳 ADD TRANSACTION</h2>
+                    <div class="form-group">
+                        <label>📅 DATE (YYYY-MM-DD)</label>
+                        <input type="text" id="date" value="2024-01-15" placeholder="2024-01-15">
+                    </div>
+                    <div class="form-group">
+                        <label>💰 AMOUNT</label>
+                        <input type="number" id="amount" value="25.50" placeholder="Enter amount">
+                    </div>
+                    <div class="form-group">
+                        <label>🏷️ CATEGORY</label>
+                        <input type="text" id="category" value="Food" placeholder="Enter category">
+                    </div>
+                    <div class="form-group">
+                        <label>📝 DESCRIPTION</label>
+                        <input type="text" id="description" value="Lunch" placeholder="Enter description">
+                    </div>
+                    <div class="form-group">
+                        <label>🔀 TYPE</label>
+                        <select id="type">
+                            <option value="Expense">Expense</option>
+                            <option value="Income">Income</option>
+                        </select>
+                    </div>
+                    <button class="btn" onclick="addTransaction()">💾 ADD TRANSACTION</button>
+                </div>
+                <div class="card">
+                    <h2>📋 TRANSACTION HISTORY</h2>
+                    <button class="btn" style="margin-bottom: 20px;" onclick="listTransactions()">🔄 REFRESH LIST</button>
+                    <div id="transactionList" style="max-height: 400px; overflow-y: auto;">
+                        <p style="text-align: center; opacity: 0.7;">No transactions yet. Add some transactions to see them here.</p>
+                    </div>
+                </div>
+            </div>
+        </div>
+        <div id="analytics" class="tab-content">
+            <div class="card">
+                <h2>📊 AI-POWERED FINANCIAL ANALYTICS</h2>
+                <div class="form-group">
+                    <label>📅 MONTH FOR ANALYSIS (YYYY-MM)</label>
+                    <input type="text" id="monthInput" value="2024-01" placeholder="2024-01">
+                </div>
+                <div style="display: grid; grid-template-columns: 1fr 1fr 1fr; gap: 15px; margin-top: 20px;">
+                    <button class="btn" onclick="monthlySummary()">📈 MONTHLY SUMMARY</button>
+                    <button class="btn" onclick="categoryAnalytics()">📊 CATEGORY ANALYTICS</button>
+                    <button class="btn" onclick="aiRecommendations()">🤖 AI RECOMMENDATIONS</button>
+                </div>
+            </div>
+            
+            <div class="card">
+                <h2>🎯 ANALYSIS RESULTS</h2>
+                <div id="analysisResults" class="output-console" style="height: 300px;">
+Select an analysis option to see results here...
+                </div>
+            </div>
+        </div>
+        <div id="oop" class="tab-content">
+            <div class="card">
+                <h2>⚙️ OOP PRINCIPLES DEMONSTRATION</h2>
+                <div class="grid-2">
+                    <div>
+                        <h3 style="color: var(--accent); margin-bottom: 15px;">🏗️ INHERITANCE</h3>
+                        <div style="background: rgba(0, 242, 254, 0.1); padding: 15px; border-radius: 10px; margin-bottom: 20px;">
+                            <p><strong>Base Class:</strong> Transaction (Abstract)</p>
+                            <p><strong>Derived Classes:</strong> Income, Expense</p>
+                            <p><strong>Polymorphism:</strong> Virtual getType() method</p>
+                        </div>
+                        
+                        <h3 style="color: var(--accent); margin-bottom: 15px;">🔒 ENCAPSULATION</h3>
+                        <div style="background: rgba(0, 242, 254, 0.1); padding: 15px; border-radius: 10px; margin-bottom: 20px;">
+                            <p><strong>Private Data:</strong> username, password, transactions</p>
+                            <p><strong>Public Interface:</strong> getters and business methods</p>
+                            <p><strong>Data Protection:</strong> Controlled access through methods</p>
+                        </div>
+                    </div>
+                    
+                    <div>
+                        <h3 style="color: var(--accent); margin-bottom: 15px;">🔄 POLYMORPHISM</h3>
+                        <div style="background: rgba(0, 242, 254, 0.1); padding: 15px; border-radius: 10px; margin-bottom: 20px;">
+                            <p><strong>Virtual Function:</strong> getType()</p>
+                            <p><strong>Runtime Binding:</strong> Different behavior for Income/Expense</p>
+                            <p><strong>Unified Interface:</strong> Same method, different implementations</p>
+                        </div>
+                        
+                        <h3 style="color: var(--accent); margin-bottom: 15px;">🎯 ABSTRACTION</h3>
+                        <div style="background: rgba(0, 242, 254, 0.1); padding: 15px; border-radius: 10px; margin-bottom: 20px;">
+                            <p><strong>Simple Interface:</strong> Easy-to-use public methods</p>
+                            <p><strong>Complex Implementation:</strong> Hidden internal logic</p>
+                            <p><strong>Focus on What:</strong> Not how it's implemented</p>
+                        </div>
+                    </div>
+                </div>
+            </div>
+            
+            <div class="card">
+                <h2>💻 CODE SNIPPETS</h2>
+                <div class="output-console" style="height: 250px; font-size: 12px;">
+// INHERITANCE EXAMPLE
+class Transaction { // Base class
+protected:
+    string date, category, description;
+    Money amount; // exact fixed-point
+public:
+    virtual string getType() const = 0; // Pure virtual
+};
+
+class Income : public Transaction { // Derived class
+public:
+    string getType() const override { 
+        return "Income"; // Polymorphism
+    }
+};
+
+// ENCAPSULATION EXAMPLE
+class User {
+private:
+    string username, password; // Private data
+    Ledger ledger; // Columnar transaction store
+public:
+    string getUsername() const { return username; } // Public interface
+};
+                </div>
+            </div>
+        </div>
+    </div>
+)PFT";
+
+// Client-side logic; expects pftData from the page's data region.
+static constexpr string_view kDashboardScript = R"PFT(        let currentUser = null;
+        let users = pftData.users.map(loadUser);
+        let transactions = [];
+        let session = null;
+        
+        // With pftData.api set (the page came from --serve), accounts,
+        // transactions and analytics live on the server's JSON API.
+        async function callApi(method, path, body) {
+            const headers = { 'Content-Type': 'application/json' };
+            if (session) headers['Authorization'] = 'Bearer ' + session;
+            const response = await fetch(path, { method, headers, body: body && JSON.stringify(body) });
+            const reply = await response.json();
+            if (!response.ok) throw new Error(reply.error || response.statusText);
+            return reply;
+        }
+        
+        // Amounts are integer cents; formatting never goes through floats.
+        function formatMoney(cents) {
+            const abs = Math.abs(cents);
+            return (cents < 0 ? '-' : '') + Math.floor(abs / 100) + '.' + String(abs % 100).padStart(2, '0');
+        }
+        
+        // Usernames, categories, descriptions and typed months reach the
+        // page from other people; anything built as markup goes through this.
+        function escapeHtml(text) {
+            return String(text).replace(/[&<>"']/g, c => ({
+                '&': '&amp;', '<': '&lt;', '>': '&gt;', '"': '&quot;', "'": '&#39;'
+            })[c]);
+        }
+        
+        function monthLabel(key) {
+            return Math.floor(key / 100) + '-' + String(key % 100).padStart(2, '0');
+        }
+        
+        // Accounts arrive as month rollups: months maps 'YYYY-MM' to
+        // { income, expense, categories } with expense cents by category.
+        // Transactions added here are folded into the same rollups, so
+        // analytics never rescan rows.
+        function loadUser(data) {
+            const months = {};
+            data.months.forEach(([key, income, expense, cells]) => {
+                const categories = {};
+                for (let i = 0; i < cells.length; i += 2) {
+                    categories[pftData.categories[cells[i]]] = cells[i + 1];
+                }
+                months[monthLabel(key)] = { income, expense, categories };
+            });
+            return { username: data.username, embedded: true, stored: data.transactions, months, transactions: [] };
+        }
+        
+        // The tracker's foldCase, so rows added here group with the embedded
+        // ones: ASCII, Latin-1, Latin Extended-A, Greek and Cyrillic capitals
+        // to lower case, sharp s to "ss", anything else unchanged.
+        function foldCodePoint(cp) {
+            if (cp >= 0x41 && cp <= 0x5A) return cp + 32;
+            if (cp < 0xC0) return cp;
+            if (cp <= 0xDE && cp !== 0xD7) return cp + 32;
+            if (cp >= 0x100 && cp <= 0x137 && cp !== 0x130) return cp | 1;
+            if (cp >= 0x139 && cp <= 0x148) return (cp & 1) ? cp + 1 : cp;
+            if (cp >= 0x14A && cp <= 0x177) return cp | 1;
+            if (cp === 0x178) return 0xFF;
+            if (cp >= 0x179 && cp <= 0x17E) return (cp & 1) ? cp + 1 : cp;
+            if (cp >= 0x391 && cp <= 0x3AB && cp !== 0x3A2) return cp + 32;
+            if (cp === 0x386) return 0x3AC;
+            if (cp >= 0x388 && cp <= 0x38A) return cp + 37;
+            if (cp === 0x38C) return 0x3CC;
+            if (cp === 0x38E || cp === 0x38F) return cp + 63;
+            if (cp === 0x3C2) return 0x3C3;
+            if (cp >= 0x410 && cp <= 0x42F) return cp + 32;
+            if (cp >= 0x400 && cp <= 0x40F) return cp + 80;
+            if (cp >= 0x460 && cp <= 0x481) return cp | 1;
+            return cp;
+        }
+        
+        function foldCase(name) {
+            let out = '';
+            for (const ch of name) {
+                const cp = ch.codePointAt(0);
+                out += cp === 0xDF ? 'ss' : String.fromCodePoint(foldCodePoint(cp));
+            }
+            return out;
+        }
+        
+        // Category keys in the tracker's (UTF-8 byte) order: pftData.categories
+        // arrives sorted, and keys first seen on the page compare by code
+        // point, which orders the same way.
+        const categoryRank = new Map(pftData.categories.map((name, i) => [name, i]));
+        
+        function byName(a, b) {
+            const x = categoryRank.get(a), y = categoryRank.get(b);
+            if (x !== undefined && y !== undefined) return x - y;
+            const p = Array.from(a), q = Array.from(b);
+            for (let i = 0; i < p.length && i < q.length; i++) {
+                if (p[i] !== q[i]) return p[i].codePointAt(0) - q[i].codePointAt(0);
+            }
+            return p.length - q.length;
+        }
+        
+        const noActivity = { income: 0, expense: 0, categories: {} };
+        
+        function monthTotals(user, month) {
+            return user.months[month] || noActivity;
+        }
+        
+        function addToMonth(user, txn) {
+            const month = txn.date.slice(0, 7);
+            const totals = user.months[month] || (user.months[month] = { income: 0, expense: 0, categories: {} });
+            if (txn.type === 'Income') {
+                totals.income += txn.cents;
+            } else {
+                const category = foldCase(txn.category);
+                totals.expense += txn.cents;
+                totals.categories[category] = (totals.categories[category] || 0) + txn.cents;
+            }
+        }
+        
+        function showNotification(message, type) {
+            const notification = document.getElementById('notification');
+            notification.textContent = message;
+            notification.className = `notification ${type}`;
+            notification.style.display = 'block';
+            
+            setTimeout(() => {
+                notification.style.display = 'none';
+            }, 4000);
+        }
+        
+        function appendToOutput(text) {
+            const output = document.getElementById('outputConsole');
+            output.append('\n' + text);
+            output.scrollTop = output.scrollHeight;
+        }
+        
+        function clearOutput() {
+            document.getElementById('outputConsole').innerHTML = '';
+        }
+        
+        function login() {
+            const username = document.getElementById('username').value;
+            const password = document.getElementById('password').value;
+            // The password field is not checked for an embedded account: the
+            // file holds no password, and the only account a page embeds is
+            // the one it was generated for. Anyone who can open the file can
+            // see that account. Accounts registered on the page check theirs.
+            const user = pftData.api ? null : users.find(u => u.username === username);
+            
+            if (!username || (!password && !(user && user.embedded))) {
+                showNotification('Please enter both username and password!', 'error');
+                return;
+            }
+            
+            if (pftData.api) {
+                callApi('POST', '/api/login', { username, password })
+                    .then(reply => {
+                        session = reply.session;
+                        let user = users.find(u => u.username === username);
+                        if (!user) {
+                            user = { username, stored: 0, months: {}, transactions: [] };
+                            users.push(user);
+                            updateUserList();
+                        }
+                        signedIn(user);
+                    })
+                    .catch(() => showNotification('❌ Login failed! Invalid credentials.', 'error'));
+                return;
+            }
+            
+            if (user && (user.embedded || user.password === password)) {
+                signedIn(user);
+            } else {
+                showNotification('❌ Login failed! Invalid credentials.', 'error');
+            }
+        }
+        
+        function signedIn(user) {
+            currentUser = user;
+            showNotification('✅ Login successful! Welcome ' + user.username + '!', 'success');
+            updateUserDisplay();
+            clearOutput();
+            appendToOutput('✅ Login successful! Welcome ' + user.username + '!');
+            appendToOutput('Ready to manage your finances...');
+        }
+        
+        function register() {
+            const username = document.getElementById('username').value;
+            const password = document.getElementById('password').value;
+            
+            if (!username || !password) {
+                showNotification('Please enter both username and password!', 'error');
+                return;
+            }
+            
+            if (pftData.api) {
+                callApi('POST', '/api/register', { username, password })
+                    .then(() => registered({ username, stored: 0, months: {}, transactions: [] }))
+                    .catch(() => showNotification('❌ Registration failed! Username already exists.', 'error'));
+                return;
+            }
+            
+            if (users.find(u => u.username === username)) {
+                showNotification('❌ Registration failed! Username already exists.', 'error');
+                return;
+            }
+            
+            registered({ username, password, stored: 0, months: {}, transactions: [] });
+        }
+        
+        function registered(user) {
+            users.push(user);
+            showNotification('✅ Registration successful! You can now login.', 'success');
+            updateUserList();
+            appendToOutput('✅ New user registered: ' + user.username);
+        }
+        
+        function updateUserList() {
+            const userList = document.getElementById('userList');
+            userList.innerHTML = '';
+            
+            if (users.length === 0) {
+                userList.innerHTML = `
+                    <div class="user-card">
+                        <h3>No users registered yet</h3>
+                        <p>Register new users to see them here</p>
+                    </div>
+                `;
+                return;
+            }
+            
+            users.forEach(user => {
+                const userCard = document.createElement('div');
+                userCard.className = 'user-card';
+                userCard.innerHTML = `
+                    <h3>👤 ${escapeHtml(user.username)}</h3>
+                    <p>Transactions: ${user.stored + user.transactions.length}</p>
+                `;
+                userList.appendChild(userCard);
+            });
+        }
+        
+        function updateUserDisplay() {
+            const currentUserDiv = document.getElementById('currentUser');
+            const currentUserName = document.getElementById('currentUserName');
+            
+            if (currentUser) {
+                currentUserName.textContent = currentUser.username;
+                currentUserDiv.style.display = 'block';
+            } else {
+                currentUserDiv.style.display = 'none';
+            }
+        }
+        
+        function addTransaction() {
+            if (!currentUser) {
+                showNotification('❌ Please login first!', 'error');
+                return;
+            }
+            
+            const date = document.getElementById('date').value;
+            const amount = Math.round(parseFloat(document.getElementById('amount').value) * 100);
+            const category = document.getElementById('category').value;
+            const description = document.getElementById('description').value;
+            const type = document.getElementById('type').value;
+            
+            if (!date || !amount || !category) {
+                showNotification('❌ Please fill all required fields!', 'error');
+                return;
+            }
+            
+            const transaction = {
+                id: Date.now(),
+                date,
+                cents: amount,
+                category,
+                description,
+                type
+            };
+            
+            if (pftData.api) {
+                callApi('POST', '/api/transactions', { date, amount: formatMoney(amount), category, description, type })
+                    .then(() => added(transaction))
+                    .catch(e => showNotification('❌ ' + e.message, 'error'));
+                return;
+            }
+            added(transaction);
+        }
+        
+        function added(transaction) {
+            currentUser.transactions.push(transaction);
+            addToMonth(currentUser, transaction);
+            showNotification('✅ Transaction added successfully!', 'success');
+            appendToOutput(`✅ Added ${transaction.type}: ${formatMoney(transaction.cents)} for ${transaction.category}`);
+        }
+        
+        function listTransactions() {
+            if (!currentUser) {
+                showNotification('❌ Please login first!', 'error');
+                return;
+            }
+            
+            if (pftData.api) {
+                callApi('GET', '/api/transactions?desc=1&limit=200')
+                    .then(reply => showTransactions(reply.transactions.map(t => ({ ...t, cents: t.amount })), 0))
+                    .catch(e => showNotification('❌ ' + e.message, 'error'));
+                return;
+            }
+            showTransactions(currentUser.transactions, currentUser.stored);
+        }
+        
+        // stored: rows summarized in the embedded rollups but not listed.
+        function showTransactions(list, stored) {
+            const transactionList = document.getElementById('transactionList');
+            
+            if (list.length === 0) {
+                transactionList.innerHTML = stored > 0
+                    ? `<p style="text-align: center; opacity: 0.7;">${stored} stored transactions are summarized under Analytics.</p>`
+                    : '<p style="text-align: center; opacity: 0.7;">No transactions yet. Add some transactions to see them here.</p>';
+                return;
+            }
+            
+            let html = `
+                <table>
+                    <thead>
+                        <tr>
+                            <th>Date</th>
+                            <th>Amount</th>
+                            <th>Category</th>
+                            <th>Type</th>
+                            <th>Description</th>
+                        </tr>
+                    </thead>
+                    <tbody>
+            `;
+            
+            list.forEach(txn => {
+                html += `
+                    <tr>
+                        <td>${escapeHtml(txn.date)}</td>
+                        <td>${formatMoney(txn.cents)}</td>
+                        <td>${escapeHtml(txn.category)}</td>
+                        <td>${escapeHtml(txn.type)}</td>
+                        <td>${escapeHtml(txn.description)}</td>
+                    </tr>
+                `;
+            });
+            
+            html += `
+                    </tbody>
+                </table>
+            `;
+            
+            transactionList.innerHTML = html;
+            appendToOutput('📋 Listed all transactions');
+        }
+        
+        function monthlySummary() {
+            if (!currentUser) {
+                showNotification('❌ Please login first!', 'error');
+                return;
+            }
+            
+            const month = document.getElementById('monthInput').value;
+            if (!month) {
+                showNotification('❌ Please enter a month (YYYY-MM)!', 'error');
+                return;
+            }
+            
+            withMonthTotals(month, totals => {
+                document.getElementById('analysisResults').textContent = calculateMonthlySummary(totals, month);
+                appendToOutput('📈 Generated monthly summary for ' + month);
+            });
+        }
+        
+        function categoryAnalytics() {
+            if (!currentUser) {
+                showNotification('❌ Please login first!', 'error');
+                return;
+            }
+            
+            const month = document.getElementById('monthInput').value;
+            if (!month) {
+                showNotification('❌ Please enter a month (YYYY-MM)!', 'error');
+                return;
+            }
+            
+            withMonthTotals(month, totals => {
+                document.getElementById('analysisResults').textContent = calculateCategoryAnalytics(totals, month);
+                appendToOutput('📊 Generated category analytics for ' + month);
+            });
+        }
+        
+        function aiRecommendations() {
+            if (!currentUser) {
+                showNotification('❌ Please login first!', 'error');
+                return;
+            }
+            
+            const month = document.getElementById('monthInput').value;
+            if (!month) {
+                showNotification('❌ Please enter a month (YYYY-MM)!', 'error');
+                return;
+            }
+            
+            const show = results => {
+                document.getElementById('analysisResults').textContent = results;
+                appendToOutput('🤖 Generated AI recommendations for ' + month);
+            };
+            if (pftData.api) {
+                callApi('GET', '/api/recommendations?month=' + encodeURIComponent(month))
+                    .then(recs => show(renderAdvice(recs)))
+                    .catch(e => showNotification('❌ ' + e.message, 'error'));
+                return;
+            }
+            show(generateAIRecommendations(currentUser, month));
+        }
+        
+        // Month totals from the embedded rollups, or from the server's
+        // summary and category endpoints when the page is served.
+        function withMonthTotals(month, show) {
+            if (!pftData.api) {
+                show(monthTotals(currentUser, month));
+                return;
+            }
+            const query = '?month=' + encodeURIComponent(month);
+            Promise.all([callApi('GET', '/api/summary' + query), callApi('GET', '/api/categories' + query)])
+                .then(([summary, breakdown]) => {
+                    const categories = {};
+                    breakdown.expenses.forEach(e => { categories[e.category] = e.amount; });
+                    show({ income: summary.income, expense: summary.expense, categories });
+                })
+                .catch(e => showNotification('❌ ' + e.message, 'error'));
+        }
+        
+        const adviceText = {
+            no_transactions: () => 'No transactions found for this month.',
+            overspending: () => '⚠️ You are overspending! Consider reducing non-essential costs.',
+            low_savings: () => '💡 Your savings are low. Try to set at least 20% of income aside.',
+            healthy_savings: () => '✅ Great! Your savings are healthy this month.',
+            high_category_spend: a => `⚠️ High spending in category: ${a.category}. Consider optimizing this expense.`
+        };
+        
+        // Text for the server's /api/recommendations reply.
+        function renderAdvice(recs) {
+            let result = `=== AI-Led Business Recommender for ${recs.month} ===\n`;
+            if (recs.advice.length > 0 && recs.advice[0].code !== 'no_transactions') {
+                result += `Your savings: ${formatMoney(recs.savings)}\n\n`;
+            }
+            recs.advice.forEach(a => { result += adviceText[a.code](a) + '\n'; });
+            return result;
+        }
+        
+        function calculateMonthlySummary(totals, month) {
+            const totalIncome = totals.income;
+            const totalExpense = totals.expense;
+            const savings = totalIncome - totalExpense;
+            
+            return `
+Summary for ${month}:
+  Total Income:  ${formatMoney(totalIncome)}
+  Total Expense: ${formatMoney(totalExpense)}
+  Savings:       ${formatMoney(savings)}
+  Savings Rate:  ${totalIncome > 0 ? ((savings / totalIncome) * 100).toFixed(1) : '0.0'}%
+            `;
+        }
+        
+        function calculateCategoryAnalytics(totals, month) {
+            const categories = totals.categories;
+            
+            let result = `Expense by Category for ${month}:\n`;
+            for (const category of Object.keys(categories).sort(byName)) {
+                result += `  ${category.padEnd(12)}: ${formatMoney(categories[category])}\n`;
+            }
+            
+            return result;
+        }
+        
+        function addMonths(month, n) {
+            const index = Number(month.slice(0, 4)) * 12 + Number(month.slice(5, 7)) - 1 + n;
+            return monthLabel(Math.floor(index / 12) * 100 + index % 12 + 1);
+        }
+        
+        // Totals of the `length` months ending with month.
+        function windowTotals(user, month, length) {
+            const sum = { income: 0, expense: 0, categories: {} };
+            for (let k = 0; k < length; k++) {
+                const totals = monthTotals(user, addMonths(month, -k));
+                sum.income += totals.income;
+                sum.expense += totals.expense;
+                for (const [category, amount] of Object.entries(totals.categories)) {
+                    sum.categories[category] = (sum.categories[category] || 0) + amount;
+                }
+            }
+            return sum;
+        }
+        
+        // Runs the tracker's advice rules (pftData.rules, in order) the way
+        // AdviceProgram does, so the page and the server agree.
+        function generateAIRecommendations(user, month) {
+            const advice = [];
+            const fired = new Set();
+            const passes = (rule, lhs, rhs) => rule.above ? lhs > rhs : lhs < rhs;
+            for (const rule of pftData.rules) {
+                if (rule.group && fired.has(rule.group)) continue;
+                const totals = windowTotals(user, month, rule.window);
+                const savings = totals.income - totals.expense;
+                const found = advice.length;
+                switch (rule.measure) {
+                case 'volume':
+                    if (passes(rule, Math.abs(totals.income) + Math.abs(totals.expense), rule.threshold)) advice.push({ code: rule.advice });
+                    break;
+                case 'savings':
+                    if (passes(rule, savings, rule.threshold)) advice.push({ code: rule.advice });
+                    break;
+                case 'savings_percent':
+                    if (passes(rule, savings * 100, totals.income * rule.threshold)) advice.push({ code: rule.advice });
+                    break;
+                case 'category_percent': {
+                    const names = rule.category !== null ? [rule.category]
+                        : Object.keys(totals.categories).filter(c => totals.categories[c] !== 0).sort(byName);
+                    for (const category of names) {
+                        if (passes(rule, (totals.categories[category] || 0) * 100, totals.expense * rule.threshold)) {
+                            advice.push({ code: rule.advice, category });
+                        }
+                    }
+                    break;
+                }
+                case 'always':
+                    advice.push({ code: rule.advice });
+                    break;
+                }
+                if (advice.length === found) continue;
+                fired.add(rule.group);
+                if (rule.final) break;
+            }
+            const own = monthTotals(user, month);
+            return renderAdvice({ month, savings: own.income - own.expense, advice });
+        }
+        
+        function showTab(tabName) {
+            document.querySelectorAll('.tab-content').forEach(tab => {
+                tab.classList.remove('active');
+            });
+            
+            document.querySelectorAll('.tab').forEach(tab => {
+                tab.classList.remove('active');
+            });
+            
+            document.getElementById(tabName).classList.add('active');
+            event.target.classList.add('active');
+        }
+        
+        // Initialize
+        document.addEventListener('DOMContentLoaded', function() {
+            if (pftData.viewer !== null) {
+                currentUser = users.find(u => u.username === pftData.viewer) || null;
+            }
+            updateUserList();
+            updateUserDisplay();
+        });
+)PFT";
+
+static constexpr string_view kDashboardTail = R"PFT(</body>
+</html>
+)PFT";
+
+static constexpr string_view kStyleOpen = "    <style>\n";
+static constexpr string_view kStyleClose = "    </style>\n</head>\n";
+static constexpr string_view kStyleLink = "    <link rel=\"stylesheet\" href=\"dashboard.css\">\n</head>\n";
+static constexpr string_view kScriptOpen = "    <script>\n";
+static constexpr string_view kScriptClose = "    </script>\n";
+static constexpr string_view kScriptLink = "    <script src=\"dashboard.js\"></script>\n";
+
+// Writes the pieces to path in order, replacing any existing file.
+static bool writePieces(const string& path, const string_view* pieces, size_t count) {
+#ifdef _WIN32
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = true;
+    for (size_t i = 0; i < count && ok; i++)
+        ok = fwrite(pieces[i].data(), 1, pieces[i].size(), f) == pieces[i].size();
+    return fclose(f) == 0 && ok;
+#else
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    vector<iovec> iov;
+    for (size_t i = 0; i < count; i++)
+        if (!pieces[i].empty()) iov.push_back({(void*)pieces[i].data(), pieces[i].size()});
+    const size_t kMaxPerCall = 16;           // the smallest IOV_MAX POSIX allows
+    bool ok = true;
+    size_t next = 0;
+    while (ok && next < iov.size()) {
+        ssize_t n = ::writev(fd, iov.data() + next, (int)min(iov.size() - next, kMaxPerCall));
+        if (n <= 0) {                        // 0 for a non-empty write is no progress
+            ok = n < 0 && errno == EINTR;
+            continue;
+        }
+        // Skip fully written buffers and trim a partially written one.
+        for (size_t done = (size_t)n; done > 0;) {
+            size_t take = min(done, iov[next].iov_len);
+            iov[next].iov_base = (char*)iov[next].iov_base + take;
+            iov[next].iov_len -= take;
+            done -= take;
+            if (iov[next].iov_len == 0) next++;
+        }
+    }
+    return ::close(fd) == 0 && ok;
+#endif
+}
+
+struct BatchStats {
+    bool ok = false;                 // assets and every page written
+    uint64_t pages = 0;
+    uint64_t bytes = 0;
+    double seconds = 0;
+
+    double pagesPerSecond() const { return seconds > 0 ? pages / seconds : 0; }
+};
+
+// Page file for an account: bytes outside [A-Za-z0-9._-] are %XX-escaped,
+// so any username maps to a distinct name inside the output directory.
+static string pageFileName(const string& username) {
+    static const char hex[] = "0123456789ABCDEF";
+    string name;
+    for (unsigned char c : username) {
+        if (isalnum(c) || c == '.' || c == '_' || c == '-') {
+            name += (char)c;
+        } else {
+            name += '%';
+            name += hex[c >> 4];
+            name += hex[c & 15];
+        }
+    }
+    return name + ".html";
+}
+
+class HTMLGUIGenerator {
+private:
+    FinanceTracker& tracker;
+
+public:
+    HTMLGUIGenerator(FinanceTracker& t) : tracker(t) {}
+
+    // Writes the dashboard page to path. Only viewer's account is embedded
+    // (signed in on load): the page opens embedded accounts without a
+    // password, so a page for nobody in particular embeds none.
+    bool writePage(const string& path, const string& viewer = "") {
+        vector<AccountHistory> accounts;
+        if (!viewer.empty()) {
+            User* user = tracker.findUser(viewer);
+            if (!user) return false;
+            accounts.push_back(user->history());
+        }
+        string data;
+        appendData(data, accounts, tracker.getAdviceRules(), viewer);
+        const string_view pieces[] = {kDashboardHead, kStyleOpen, kDashboardStyles, kStyleClose,
+                                      kDashboardBody, kScriptOpen, data, kDashboardScript,
+                                      kScriptClose, kDashboardTail};
+        return writePieces(path, pieces, sizeof pieces / sizeof pieces[0]);
+    }
+
+    // Writes dashboard.css and dashboard.js to dir once, then one page per
+    // account (see pageFileName) that links them and embeds only that
+    // account's data, spread across threads.
+    BatchStats writeAccountPages(const string& dir, size_t threads) {
+        BatchStats stats;
+        auto start = chrono::steady_clock::now();
+        error_code ec;
+        filesystem::create_directories(dir, ec);
+        bool ok = writePieces(dir + "/dashboard.css", &kDashboardStyles, 1) &&
+                  writePieces(dir + "/dashboard.js", &kDashboardScript, 1);
+        stats.bytes = kDashboardStyles.size() + kDashboardScript.size();
+
+        struct alignas(64) Partial {
+            uint64_t pages = 0;
+            uint64_t bytes = 0;
+            bool ok = true;
+        };
+        vector<string> names = tracker.getAllUsernames();
+        vector<AdviceRule> rules = tracker.getAdviceRules();
+        WorkStealingPool pool(threads);
+        vector<Partial> partials(pool.size());
+        pool.parallelFor(names.size(), [&](size_t i, size_t worker) {
+            Partial& partial = partials[worker];
+            User* user = tracker.findUser(names[i]);
+            vector<AccountHistory> account(1, user->history());
+            string data;
+            appendData(data, account, rules, names[i]);
+            const string_view pieces[] = {kDashboardHead, kStyleLink, kDashboardBody, kScriptOpen,
+                                          data, kScriptClose, kScriptLink, kDashboardTail};
+            if (!writePieces(dir + "/" + pageFileName(names[i]), pieces,
+                             sizeof pieces / sizeof pieces[0])) {
+                partial.ok = false;
+                return;
+            }
+            partial.pages++;
+            for (const string_view& piece : pieces) partial.bytes += piece.size();
+        });
+        for (const Partial& partial : partials) {
+            stats.pages += partial.pages;
+            stats.bytes += partial.bytes;
+            ok = ok && partial.ok;
+        }
+        stats.ok = ok;
+        stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return stats;
+    }
+
+    // The page served by --serve: no embedded accounts; the script signs in
+    // and queries through the server's JSON API instead.
+    string servedPage() const {
+        string data;
+        appendData(data, {}, tracker.getAdviceRules(), "", true);
+        string page;
+        for (string_view piece : {kDashboardHead, kStyleOpen, kDashboardStyles, kStyleClose,
+                                  kDashboardBody, kScriptOpen, string_view(data), kDashboardScript,
+                                  kScriptClose, kDashboardTail})
+            page.append(piece.data(), piece.size());
+        return page;
+    }
+
+    void generateHTML() {
+        if (writePage("finance_tracker.html"))
+            cout << "✅ AI-POWERED FINANCE TRACKER GENERATED SUCCESSFULLY!" << endl;
+        else
+            cout << "❌ Failed to write finance_tracker.html" << endl;
+    }
+
+private:
+    // The page's dynamic region: each account's month rollups as a compact
+    // literal the script reads instead of rescanning transactions. Months
+    // are [yyyymm, income, expense, [category, amount, ...]] in minor
+    // units, with categories as indexes into one shared list of folded
+    // names in the tracker's order. The advice rules ride along so the
+    // script evaluates the same ones.
+    static void appendData(string& out, const vector<AccountHistory>& accounts,
+                           const vector<AdviceRule>& rules, const string& viewer, bool api = false) {
+        const CategoryDictionary& dict = CategoryDictionary::instance();
+        unordered_map<uint32_t, uint32_t> slot;
+        vector<uint32_t> names;                 // sorted by name, as the tracker orders them
+        for (const AccountHistory& account : accounts) {
+            for (const MonthActivity& month : account.months) {
+                for (const CategoryAmount& expense : month.expenses)
+                    if (slot.emplace(expense.categoryId, 0).second) names.push_back(expense.categoryId);
+            }
+        }
+        sort(names.begin(), names.end(),
+             [&](uint32_t a, uint32_t b) { return dict.name(a) < dict.name(b); });
+        for (uint32_t i = 0; i < names.size(); i++) slot[names[i]] = i;
+        string users;
+        for (size_t u = 0; u < accounts.size(); u++) {
+            const AccountHistory& account = accounts[u];
+            users += u ? ",{\"username\":" : "{\"username\":";
+            appendJsonString(users, account.username);
+            users += ",\"currency\":";
+            appendJsonString(users, Money(0, account.currency).currencyName());
+            users += ",\"transactions\":";
+            appendJsonInt(users, (int64_t)account.transactions);
+            users += ",\"months\":[";
+            for (size_t m = 0; m < account.months.size(); m++) {
+                const MonthActivity& month = account.months[m];
+                users += m ? ",[" : "[";
+                appendJsonInt(users, month.summary.monthKey);
+                users += ',';
+                appendJsonInt(users, month.summary.income.minorUnits());
+                users += ',';
+                appendJsonInt(users, month.summary.expense.minorUnits());
+                users += ",[";
+                for (size_t c = 0; c < month.expenses.size(); c++) {
+                    if (c) users += ',';
+                    appendJsonInt(users, slot[month.expenses[c].categoryId]);
+                    users += ',';
+                    appendJsonInt(users, month.expenses[c].amount.minorUnits());
+                }
+                users += "]]";
+            }
+            users += "]}";
+        }
+
+        string json = api ? "{\"api\":true,\"viewer\":" : "{\"api\":false,\"viewer\":";
+        if (viewer.empty()) json += "null";
+        else appendJsonString(json, viewer);
+        json += ",\"categories\":[";
+        for (size_t i = 0; i < names.size(); i++) {
+            if (i) json += ',';
+            appendJsonString(json, dict.name(names[i]));
+        }
+        json += "],\"rules\":[";
+        for (size_t i = 0; i < rules.size(); i++) {
+            if (i) json += ',';
+            appendJson(json, rules[i]);
+        }
+        json += "],\"users\":[";
+        json += users;
+        json += "]}";
+
+        // '<' only occurs inside strings, where \u003c keeps a name from
+        // closing the script element.
+        out += "        const pftData = ";
+        for (char c : json) {
+            if (c == '<') out += "\\u003c";
+            else out += c;
+        }
+        out += ";\n";
+    }
+};
+
+// ==================== HTTP SERVER ====================
+// --serve: one epoll loop speaking enough HTTP/1.1 for the dashboard and
+// for load tests. Connections are kept alive, and pipelined requests are
+// answered in order with their responses flushed together.
+// Bodies must carry a Content-Length; chunked uploads are refused.
+#ifdef PFT_HTTP_SERVER
+
+// Reads a flat JSON object into name -> text: strings unescaped, numbers
+// and literals verbatim. Nested objects and arrays are rejected.
+static bool parseJsonFields(string_view body, unordered_map<string, string>& fields) {
+    size_t i = 0;
+    auto skipSpace = [&] {
+        while (i < body.size() && (body[i] == ' ' || body[i] == '\t' || body[i] == '\r' || body[i] == '\n'))
+            i++;
+    };
+    auto hexDigit = [](char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    auto readHex4 = [&](uint32_t& v) {
+        if (body.size() - i < 4) return false;
+        v = 0;
+        for (int k = 0; k < 4; k++) {
+            int d = hexDigit(body[i++]);
+            if (d < 0) return false;
+            v = v * 16 + (uint32_t)d;
+        }
+        return true;
+    };
+    auto readString = [&](string& out) {
+        if (i >= body.size() || body[i] != '"') return false;
+        i++;
+        while (i < body.size() && body[i] != '"') {
+            char c = body[i++];
+            if ((unsigned char)c < 0x20) return false;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (i >= body.size()) return false;
+            c = body[i++];
+            switch (c) {
+            case '"': case '\\': case '/': out += c; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                uint32_t cp;
+                if (!readHex4(cp)) return false;
+                if (cp >= 0xD800 && cp < 0xDC00) {
+                    uint32_t low;
+                    if (body.substr(i, 2) != "\\u") return false;
+                    i += 2;
+                    if (!readHex4(low) || low < 0xDC00 || low >= 0xE000) return false;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                } else if (cp >= 0xDC00 && cp < 0xE000) {
+                    return false;
+                }
+                if (cp < 0x80) {
+                    out += (char)cp;
+                } else if (cp < 0x800) {
+                    out += (char)(0xC0 | cp >> 6);
+                    out += (char)(0x80 | (cp & 0x3F));
+                } else if (cp < 0x10000) {
+                    out += (char)(0xE0 | cp >> 12);
+                    out += (char)(0x80 | (cp >> 6 & 0x3F));
+                    out += (char)(0x80 | (cp & 0x3F));
+                } else {
+                    out += (char)(0xF0 | cp >> 18);
+                    out += (char)(0x80 | (cp >> 12 & 0x3F));
+                    out += (char)(0x80 | (cp >> 6 & 0x3F));
+                    out += (char)(0x80 | (cp & 0x3F));
+                }
+                break;
+            }
+            default: return false;
+            }
+        }
+        if (i >= body.size()) return false;
+        i++;
+        return true;
+    };
+
+    skipSpace();
+    if (i >= body.size() || body[i++] != '{') return false;
+    skipSpace();
+    if (i < body.size() && body[i] == '}') {
+        i++;
+    } else {
+        for (;;) {
+            string key, value;
+            skipSpace();
+            if (!readString(key)) return false;
+            skipSpace();
+            if (i >= body.size() || body[i++] != ':') return false;
+            skipSpace();
+            if (i < body.size() && body[i] == '"') {
+                if (!readString(value)) return false;
+            } else {
+                size_t start = i;
+                while (i < body.size() && (isalnum((unsigned char)body[i]) || body[i] == '-' ||
+                                           body[i] == '+' || body[i] == '.'))
+                    i++;
+                if (i == start) return false;
+                value.assign(body.data() + start, i - start);
+            }
+            fields[move(key)] = move(value);
+            skipSpace();
+            if (i < body.size() && body[i] == ',') {
+                i++;
+                continue;
+            }
+            if (i < body.size() && body[i] == '}') {
+                i++;
+                break;
+            }
+            return false;
+        }
+    }
+    skipSpace();
+    return i == body.size();
+}
+
+// Value of name in a query string ("a=1&b=2"), or "" if absent. Values
+// are the dates, months and numbers the API takes, so no %-decoding.
+static string_view queryParam(string_view query, string_view name) {
+    while (!query.empty()) {
+        size_t amp = query.find('&');
+        string_view pair = query.substr(0, amp);
+        if (pair.size() > name.size() && pair.substr(0, name.size()) == name && pair[name.size()] == '=')
+            return pair.substr(name.size() + 1);
+        if (amp == string_view::npos) break;
+        query.remove_prefix(amp + 1);
+    }
+    return string_view();
+}
+
+static bool equalsIgnoreCase(string_view a, string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++)
+        if (tolower((unsigned char)a[i]) != tolower((unsigned char)b[i])) return false;
+    return true;
+}
+
+struct HttpRequest {
+    string_view method;
+    string_view path;
+    string_view query;
+    string_view body;
+    string_view authorization;
+    bool keepAlive = true;
+};
+
+class HttpServer {
+    struct Connection {
+        string in;                  // received, not yet answered
+        string out;                 // responses not yet sent
+        size_t sent = 0;
+        bool closing = false;       // answer nothing more; close once `out` drains
+        bool peerClosed = false;    // answer what arrived, then close
+        uint32_t interest = 0;      // current epoll event mask
+        uint64_t waitFor = 0;       // WAL sequence `out` past heldAt waits on; 0 if none
+        size_t heldAt = 0;          // first byte of `out` answering a write not yet durable
+        bool checking = false;      // a login or registration is out on a credential worker
+        uint64_t serial = 0;        // tells a reused fd's connection from the one before
+    };
+
+    // A login or registration handed to a credential worker: hashing the
+    // password takes ~100 ms, which the event loop must not spend. Later
+    // requests on the connection wait for its answer.
+    struct CredentialCheck {
+        int fd = -1;
+        uint64_t serial = 0;
+        bool registering = false;
+        bool keepAlive = true;
+        string username, password, currency;
+        int status = 0;             // filled in by the worker
+        string body;
+        uint64_t logged = 0;
+    };
+
+    static constexpr size_t kMaxHeaderBytes = 64 << 10;
+    static constexpr size_t kMaxBodyBytes = 1 << 20;
+    static constexpr size_t kMaxPendingOut = 256 << 10;   // answer more once this is sent
+    static constexpr size_t kMaxPageRows = 1000;
+    static constexpr int kDeferred = 0;     // route: answered by a credential worker
+
+    FinanceTracker& tracker;
+    string page;
+    int listenFd = -1;
+    int epollFd = -1;
+    int wakeFd = -1;
+    uint16_t boundPort = 0;
+    atomic<bool> stopping{false};
+    vector<unique_ptr<Connection>> connections;     // indexed by fd
+    vector<int> parked;                             // connections waiting on the WAL
+    uint64_t accepted = 0;
+
+    vector<thread> checkers;                        // credential workers
+    mutex checkLock;
+    condition_variable checkQueued;
+    deque<CredentialCheck> checksQueued;
+    vector<CredentialCheck> checksDone;             // picked up by the loop on wakeFd
+    bool checkersStopping = false;
+
+public:
+    HttpServer(FinanceTracker& t) : tracker(t), page(HTMLGUIGenerator(t).servedPage()) {}
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    ~HttpServer() {
+        {
+            lock_guard<mutex> l(checkLock);
+            checkersStopping = true;
+        }
+        checkQueued.notify_all();
+        for (auto& t : checkers) t.join();
+        tracker.onDurable(nullptr);
+        for (size_t fd = 0; fd < connections.size(); fd++)
+            if (connections[fd]) ::close((int)fd);
+        if (listenFd >= 0) ::close(listenFd);
+        if (wakeFd >= 0) ::close(wakeFd);
+        if (epollFd >= 0) ::close(epollFd);
+    }
+
+    // Listens on 127.0.0.1:port (0 picks a free port; see port()).
+    bool listen(uint16_t port) {
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0) return false;
+        int one = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        socklen_t len = sizeof addr;
+        if (bind(listenFd, (sockaddr*)&addr, sizeof addr) != 0 || ::listen(listenFd, SOMAXCONN) != 0 ||
+            getsockname(listenFd, (sockaddr*)&addr, &len) != 0)
+            return false;
+        boundPort = ntohs(addr.sin_port);
+
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epollFd < 0 || wakeFd < 0) return false;
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = listenFd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev) != 0) return false;
+        ev.data.fd = wakeFd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev) != 0) return false;
+        // Writes are answered once the WAL flusher reports them durable,
+        // so the loop never blocks on an fsync.
+        tracker.onDurable([this] {
+            uint64_t one = 1;
+            if (::write(wakeFd, &one, sizeof one) < 0) {}
+        });
+        for (size_t i = max(1u, thread::hardware_concurrency()); i-- > 0;)
+            checkers.emplace_back([this] { checkCredentials(); });
+        return true;
+    }
+
+    uint16_t port() const { return boundPort; }
+
+    // Serves until stop() is called (from any thread).
+    void run() {
+        epoll_event events[256];
+        while (!stopping) {
+            int n = epoll_wait(epollFd, events, 256, -1);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            for (int k = 0; k < n; k++) {
+                int fd = events[k].data.fd;
+                if (fd == listenFd) {
+                    acceptAll();
+                } else if (fd == wakeFd) {
+                    uint64_t count;
+                    while (::read(wakeFd, &count, sizeof count) > 0) {}
+                    releaseParked();
+                    answerChecked();
+                } else if ((size_t)fd < connections.size() && connections[fd]) {
+                    uint32_t e = events[k].events;
+                    if (e & (EPOLLERR | EPOLLHUP)) closeConnection(fd);
+                    else if (e & EPOLLOUT) flush(fd);
+                    else if (e & EPOLLIN) receive(fd);
+                }
+            }
+        }
+    }
+
+    void stop() {
+        stopping = true;
+        uint64_t one = 1;
+        if (::write(wakeFd, &one, sizeof one) < 0) {}
+    }
+
+private:
+    void acceptAll() {
+        for (;;) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+            if ((size_t)fd >= connections.size()) connections.resize(fd + 1);
+            connections[fd].reset(new Connection());
+            connections[fd]->serial = ++accepted;
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            connections[fd]->interest = EPOLLIN;
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) closeConnection(fd);
+        }
+    }
+
+    void closeConnection(int fd) {
+        if (connections[fd]->waitFor) {
+            auto at = find(parked.begin(), parked.end(), fd);
+            if (at != parked.end()) parked.erase(at);
+        }
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        connections[fd].reset();
+    }
+
+    void receive(int fd) {
+        Connection& c = *connections[fd];
+        char buf[64 << 10];
+        // Anything past one maximal request is left in the socket until
+        // the requests already buffered have been answered.
+        while (c.in.size() <= kMaxHeaderBytes + kMaxBodyBytes) {
+            ssize_t n = ::read(fd, buf, sizeof buf);
+            if (n > 0) {
+                c.in.append(buf, (size_t)n);
+                if ((size_t)n < sizeof buf) break;
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            c.peerClosed = true;
+            break;
+        }
+        flush(fd);
+    }
+
+    // Answers complete requests from the input buffer, in order, until it
+    // runs out or kMaxPendingOut bytes of responses are waiting.
+    void answer(int fd, Connection& c) {
+        size_t pos = 0;
+        while (c.out.size() < kMaxPendingOut) {
+            size_t headerEnd = c.in.find("\r\n\r\n", pos);
+            if (headerEnd == string::npos) {
+                if (c.in.size() - pos > kMaxHeaderBytes) fail(c, 431, "headers too large");
+                break;
+            }
+            HttpRequest request;
+            size_t contentLength = 0;
+            if (!parseHead(string_view(c.in).substr(pos, headerEnd - pos), request, contentLength)) {
+                fail(c, 400, "malformed request");
+                break;
+            }
+            if (contentLength > kMaxBodyBytes) {
+                fail(c, 413, "body too large");
+                break;
+            }
+            size_t bodyStart = headerEnd + 4;
+            if (c.in.size() - bodyStart < contentLength) break;
+            request.body = string_view(c.in).substr(bodyStart, contentLength);
+            handle(request, c, fd);
+            pos = bodyStart + contentLength;
+            if (!request.keepAlive) {
+                c.closing = true;
+                break;
+            }
+            if (c.checking) break;
+        }
+        c.in.erase(0, pos);
+    }
+
+    void fail(Connection& c, int status, const char* reason) {
+        string body = "{\"error\":";
+        appendJsonString(body, reason);
+        body += '}';
+        appendResponse(c.out, status, "application/json", body, false);
+        c.closing = true;
+        c.in.clear();
+    }
+
+    static bool parseHead(string_view head, HttpRequest& request, size_t& contentLength) {
+        size_t lineEnd = head.find("\r\n");
+        string_view line = head.substr(0, lineEnd);
+        size_t sp1 = line.find(' ');
+        size_t sp2 = line.find(' ', sp1 + 1);
+        if (sp1 == string_view::npos || sp2 == string_view::npos) return false;
+        request.method = line.substr(0, sp1);
+        string_view target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+        string_view version = line.substr(sp2 + 1);
+        if (version.substr(0, 5) != "HTTP/") return false;
+        request.keepAlive = version != "HTTP/1.0";
+        size_t q = target.find('?');
+        request.path = target.substr(0, q);
+        if (q != string_view::npos) request.query = target.substr(q + 1);
+
+        while (lineEnd != string_view::npos) {
+            size_t start = lineEnd + 2;
+            lineEnd = head.find("\r\n", start);
+            string_view header = head.substr(start, lineEnd == string_view::npos ? string_view::npos
+                                                                                : lineEnd - start);
+            size_t colon = header.find(':');
+            if (colon == string_view::npos) return false;
+            string_view name = header.substr(0, colon);
+            string_view value = header.substr(colon + 1);
+            while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+            while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+            if (equalsIgnoreCase(name, "content-length")) {
+                auto r = from_chars(value.data(), value.data() + value.size(), contentLength);
+                if (r.ec != errc() || r.ptr != value.data() + value.size()) return false;
+            } else if (equalsIgnoreCase(name, "transfer-encoding")) {
+                return false;
+            } else if (equalsIgnoreCase(name, "connection")) {
+                if (equalsIgnoreCase(value, "close")) request.keepAlive = false;
+                else if (equalsIgnoreCase(value, "keep-alive")) request.keepAlive = true;
+            } else if (equalsIgnoreCase(name, "authorization")) {
+                request.authorization = value;
+            }
+        }
+        return true;
+    }
+
+    // Sends pending responses, answering further buffered requests each
+    // time the output drains. A write's response and everything after it
+    // is held back, with the connection parked, until the write is durable;
+    // nothing more is answered while a credential check is out.
+    void flush(int fd) {
+        Connection& c = *connections[fd];
+        for (;;) {
+            if (c.sent == (c.waitFor ? c.heldAt : c.out.size())) {
+                c.out.erase(0, c.sent);
+                if (c.waitFor) c.heldAt -= c.sent;
+                c.sent = 0;
+                if (!c.closing && !c.checking) answer(fd, c);
+                if (c.waitFor && c.heldAt == 0) {
+                    bool failed;
+                    if (tracker.durableSeq(failed) >= c.waitFor) {
+                        c.waitFor = 0;
+                    } else if (failed) {
+                        // Never acknowledge a write the log lost.
+                        closeConnection(fd);
+                        return;
+                    } else {
+                        watch(fd, c, 0);
+                        parked.push_back(fd);
+                        return;
+                    }
+                }
+                if (c.out.empty()) break;
+            }
+            size_t end = c.waitFor ? c.heldAt : c.out.size();
+            ssize_t n = ::send(fd, c.out.data() + c.sent, end - c.sent, MSG_NOSIGNAL);
+            if (n > 0) {
+                c.sent += (size_t)n;
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                // Stop reading until the client takes its responses; this
+                // bounds what a pipelining client can queue up.
+                watch(fd, c, EPOLLOUT);
+                return;
+            } else {
+                closeConnection(fd);
+                return;
+            }
+        }
+        if (c.checking) watch(fd, c, 0);         // answerChecked carries on
+        else if (c.closing || c.peerClosed) closeConnection(fd);
+        else watch(fd, c, EPOLLIN);
+    }
+
+    // Sends the held responses of every parked connection whose write has
+    // become durable; after a WAL failure, closes them unanswered.
+    void releaseParked() {
+        if (parked.empty()) return;
+        bool failed;
+        uint64_t durable = tracker.durableSeq(failed);
+        vector<int> ready;
+        for (size_t k = 0; k < parked.size();) {
+            if (connections[parked[k]]->waitFor <= durable || failed) {
+                ready.push_back(parked[k]);
+                parked[k] = parked.back();
+                parked.pop_back();
+            } else {
+                k++;
+            }
+        }
+        for (int fd : ready) {
+            Connection& c = *connections[fd];
+            if (c.waitFor > durable) {
+                closeConnection(fd);
+                continue;
+            }
+            c.waitFor = 0;
+            flush(fd);
+        }
+    }
+
+    // Credential worker: runs queued logins and registrations and hands
+    // each answer back to the loop through wakeFd.
+    void checkCredentials() {
+        for (;;) {
+            CredentialCheck check;
+            {
+                unique_lock<mutex> l(checkLock);
+                checkQueued.wait(l, [&] { return checkersStopping || !checksQueued.empty(); });
+                if (checkersStopping) return;
+                check = move(checksQueued.front());
+                checksQueued.pop_front();
+            }
+            if (check.registering) {
+                if (tracker.registerUser(check.username, check.password, check.currency, &check.logged)) {
+                    check.status = 200;
+                    check.body = "{\"ok\":true}";
+                } else if (tracker.readOnly()) {
+                    check.status = errorBody(check.body, 503, "storage failed; writes are refused");
+                } else {
+                    check.status = errorBody(check.body, 409, "username taken or currency unknown");
+                }
+            } else {
+                SessionId session = tracker.loginUser(check.username, check.password);
+                if (session) {
+                    check.status = 200;
+                    check.body = "{\"session\":\"" + session.toHex() + "\"}";
+                } else {
+                    check.status = errorBody(check.body, 401, "invalid credentials");
+                }
+            }
+            {
+                lock_guard<mutex> l(checkLock);
+                checksDone.push_back(move(check));
+            }
+            uint64_t one = 1;
+            if (::write(wakeFd, &one, sizeof one) < 0) {}
+        }
+    }
+
+    // Appends the answers of finished credential checks and lets their
+    // connections carry on. Answers for connections closed since are
+    // dropped.
+    void answerChecked() {
+        vector<CredentialCheck> done;
+        {
+            lock_guard<mutex> l(checkLock);
+            done.swap(checksDone);
+        }
+        for (CredentialCheck& check : done) {
+            if ((size_t)check.fd >= connections.size() || !connections[check.fd] ||
+                connections[check.fd]->serial != check.serial)
+                continue;
+            Connection& c = *connections[check.fd];
+            bool parkedOrSending = c.waitFor != 0;      // releaseParked or EPOLLOUT flushes it
+            hold(c, check.logged);
+            appendResponse(c.out, check.status, "application/json", check.body, check.keepAlive);
+            c.checking = false;
+            if (!parkedOrSending) flush(check.fd);
+        }
+    }
+
+    void watch(int fd, Connection& c, uint32_t events) {
+        if (c.interest == events) return;
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev);
+        c.interest = events;
+    }
+
+    static void appendResponse(string& out, int status, string_view type, string_view body,
+                               bool keepAlive) {
+        const char* reason = "OK";
+        switch (status) {
+        case 400: reason = "Bad Request"; break;
+        case 401: reason = "Unauthorized"; break;
+        case 404: reason = "Not Found"; break;
+        case 405: reason = "Method Not Allowed"; break;
+        case 409: reason = "Conflict"; break;
+        case 413: reason = "Payload Too Large"; break;
+        case 431: reason = "Request Header Fields Too Large"; break;
+        case 503: reason = "Service Unavailable"; break;
+        }
+        out += "HTTP/1.1 ";
+        appendJsonInt(out, status);
+        out += ' ';
+        out += reason;
+        out += "\r\nContent-Type: ";
+        out.append(type.data(), type.size());
+        out += "\r\nContent-Length: ";
+        appendJsonInt(out, (int64_t)body.size());
+        out += keepAlive ? "\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+        out.append(body.data(), body.size());
+    }
+
+    static void appendAlerts(string& out, const vector<SpendingAlert>& alerts) {
+        out += '[';
+        for (size_t i = 0; i < alerts.size(); i++) {
+            if (i) out += ',';
+            appendJson(out, alerts[i]);
+        }
+        out += ']';
+    }
+
+    static bool parseRowNumber(string_view text, uint64_t& n) {
+        auto r = from_chars(text.data(), text.data() + text.size(), n);
+        return !text.empty() && r.ec == errc() && r.ptr == text.data() + text.size();
+    }
+
+    static SessionId sessionOf(const HttpRequest& request) {
+        string_view auth = request.authorization;
+        if (auth.substr(0, 7) != "Bearer ") return SessionId{};
+        return SessionId::fromHex(auth.substr(7));
+    }
+
+    // Routes one request and appends its response, or queues it for a
+    // credential worker.
+    void handle(const HttpRequest& request, Connection& c, int fd) {
+        string body;
+        uint64_t logged = 0;
+        CredentialCheck check;
+        int status = route(request, body, logged, check);
+        if (status == kDeferred) {
+            check.fd = fd;
+            check.serial = c.serial;
+            check.keepAlive = request.keepAlive;
+            c.checking = true;
+            {
+                lock_guard<mutex> l(checkLock);
+                checksQueued.push_back(move(check));
+            }
+            checkQueued.notify_one();
+            return;
+        }
+        string& out = c.out;
+        hold(c, logged);
+        if (status == 200 && request.path == "/")
+            appendResponse(out, 200, "text/html; charset=utf-8", page, request.keepAlive);
+        else
+            appendResponse(out, status, "application/json", body, request.keepAlive);
+    }
+
+    // Holds back the response about to be appended to `out`, and all
+    // after it, until WAL sequence `logged` (if any) is durable.
+    static void hold(Connection& c, uint64_t logged) {
+        if (!logged) return;
+        if (!c.waitFor) c.heldAt = c.out.size();
+        c.waitFor = max(c.waitFor, logged);
+    }
+
+    static int errorBody(string& body, int status, const char* reason) {
+        body = "{\"error\":";
+        appendJsonString(body, reason);
+        body += '}';
+        return status;
+    }
+
+    // A write sets `logged` to its WAL sequence number; the response must
+    // not be sent before that is durable. Logins and registrations fill in
+    // `check` and return kDeferred.
+    int route(const HttpRequest& request, string& body, uint64_t& logged, CredentialCheck& check) {
+        auto error = [&](int status, const char* reason) { return errorBody(body, status, reason); };
+        // A refused write after a WAL failure is the server's fault, not
+        // the request's.
+        auto refused = [&](int status, const char* reason) {
+            return tracker.readOnly() ? error(503, "storage failed; writes are refused") : error(status, reason);
+        };
+        bool get = request.method == "GET", post = request.method == "POST";
+        string_view path = request.path;
+
+        if (path == "/") return get ? 200 : error(405, "method not allowed");
+        if (path == "/api/register" || path == "/api/login") {
+            if (!post) return error(405, "method not allowed");
+            unordered_map<string, string> fields;
+            if (!parseJsonFields(request.body, fields) || fields["username"].empty() ||
+                fields["password"].empty())
+                return error(400, "username and password are required");
+            check.registering = path == "/api/register";
+            check.username = move(fields["username"]);
+            check.password = move(fields["password"]);
+            check.currency = fields.count("currency") ? move(fields["currency"]) : "USD";
+            return kDeferred;
+        }
+
+        SessionId session = sessionOf(request);
+        User* user = session ? tracker.getSessionUser(session) : nullptr;
+        if (path.substr(0, 5) != "/api/") return error(404, "not found");
+        if (!user) return error(401, "missing or expired session");
+
+        if (path == "/api/logout") {
+            if (!post) return error(405, "method not allowed");
+            tracker.logoutUser(session);
+            body = "{\"ok\":true}";
+            return 200;
+        }
+        if (path == "/api/transactions" && post) {
+            unordered_map<string, string> fields;
+            int64_t cents;
+            if (!parseJsonFields(request.body, fields)) return error(400, "body must be a JSON object");
+            if (!parseCents(fields["amount"].data(), fields["amount"].size(), cents))
+                return error(400, "amount must be a decimal number");
+            const string& type = fields["type"];
+            if (fields["category"].empty() || (type != "Income" && type != "Expense"))
+                return error(400, "category and type (Income or Expense) are required");
+            uint64_t seen = user->lastSpendingAlert();
+            if (!tracker.addTransaction(session, fields["date"], Money(cents, user->getCurrency()),
+                                        fields["category"], fields["description"], type, &logged))
+                return refused(400, "date must be a valid YYYY-MM-DD");
+            body = "{\"ok\":true,\"alerts\":";
+            appendAlerts(body, user->spendingAlerts(seen));
+            body += '}';
+            return 200;
+        }
+        if ((path == "/api/transactions/edit" || path == "/api/transactions/delete" ||
+             path == "/api/undo") && post) {
+            unordered_map<string, string> fields;
+            uint64_t row = 0;
+            if (!parseJsonFields(request.body, fields)) return error(400, "body must be a JSON object");
+            if (path != "/api/undo" && !parseRowNumber(fields["row"], row))
+                return error(400, "row must be a row number from the listing");
+            if (path == "/api/undo") {
+                if (!tracker.undoLastChange(session, &logged)) return refused(409, "nothing to undo");
+            } else if (path == "/api/transactions/delete") {
+                if (!tracker.deleteTransaction(session, row, &logged))
+                    return refused(409, "row is sealed, deleted or unknown");
+            } else {
+                int64_t cents;
+                if (!parseCents(fields["amount"].data(), fields["amount"].size(), cents))
+                    return error(400, "amount must be a decimal number");
+                const string& type = fields["type"];
+                if (fields["category"].empty() || (type != "Income" && type != "Expense"))
+                    return error(400, "category and type (Income or Expense) are required");
+                if (packDate(fields["date"]) == kInvalidDay) return error(400, "date must be a valid YYYY-MM-DD");
+                if (!tracker.editTransaction(session, row, fields["date"], Money(cents, user->getCurrency()),
+                                             fields["category"], fields["description"], type, &logged))
+                    return refused(409, "row is sealed, deleted or unknown");
+            }
+            body = "{\"ok\":true,\"version\":";
+            appendJsonInt(body, (int64_t)user->currentVersion());
+            body += '}';
+            return 200;
+        }
+        if (!get) return error(405, "method not allowed");
+        if (path == "/api/version") {
+            body = "{\"version\":";
+            appendJsonInt(body, (int64_t)user->currentVersion());
+            body += '}';
+            return 200;
+        }
+        if (path == "/api/transactions") {
+            PageRequest page;
+            page.order = queryParam(request.query, "order") == "amount" ? RowOrder::Amount : RowOrder::Date;
+            page.descending = queryParam(request.query, "desc") == "1";
+            string_view limit = queryParam(request.query, "limit"), offset = queryParam(request.query, "offset");
+            if (!limit.empty()) from_chars(limit.data(), limit.data() + limit.size(), page.limit);
+            if (!offset.empty()) from_chars(offset.data(), offset.data() + offset.size(), page.offset);
+            page.limit = min(page.limit, kMaxPageRows);
+            vector<TransactionRow> rows;
+            PageResult result;
+            tracker.listTransactionPage(session, page, rows, result);
+            body = "{\"total\":";
+            appendJsonInt(body, (int64_t)result.total);
+            body += result.more ? ",\"more\":true,\"transactions\":[" : ",\"more\":false,\"transactions\":[";
+            for (size_t i = 0; i < rows.size(); i++) {
+                if (i) body += ',';
+                appendJson(body, rows[i]);
+            }
+            body += "]}";
+            return 200;
+        }
+        if (path == "/api/forecast") {
+            SpendingForecast f;
+            if (!tracker.forecast(session, string(queryParam(request.query, "date")), f))
+                return error(400, "date must be a valid YYYY-MM-DD");
+            appendJson(body, f);
+            return 200;
+        }
+        if (path == "/api/alerts") {
+            uint64_t after = 0;
+            string_view since = queryParam(request.query, "after");
+            from_chars(since.data(), since.data() + since.size(), after);
+            vector<SpendingAlert> alerts;
+            tracker.spendingAlerts(session, alerts, after);
+            body = "{\"alerts\":";
+            appendAlerts(body, alerts);
+            body += '}';
+            return 200;
+        }
+
+        string month(queryParam(request.query, "month"));
+        bool analytics = path == "/api/summary" || path == "/api/categories" || path == "/api/recommendations";
+        if (!analytics) return error(404, "not found");
+        if (monthKeyOf(month) < 0) return error(400, "month must be YYYY-MM");
+        string_view version = queryParam(request.query, "version");
+        if (!version.empty() && path != "/api/recommendations") {
+            // As of an earlier version: ?version=N from an edit's response.
+            uint64_t n;
+            bool held = parseRowNumber(version, n);
+            if (path == "/api/summary") {
+                MonthSummary summary;
+                held = held && tracker.summarizeMonthAt(session, n, month, summary);
+                if (held) appendJson(body, summary);
+            } else {
+                CategoryBreakdown breakdown;
+                held = held && tracker.categoryBreakdownAt(session, n, month, breakdown);
+                if (held) appendJson(body, breakdown);
+            }
+            return held ? 200 : error(404, "version not held");
+        }
+        if (path == "/api/summary") {
+            MonthSummary summary;
+            tracker.summarizeMonth(session, month, summary);
+            appendJson(body, summary);
+        } else if (path == "/api/categories") {
+            CategoryBreakdown breakdown;
+            tracker.categoryBreakdown(session, month, breakdown);
+            appendJson(body, breakdown);
+        } else {
+            Recommendations recs;
+            tracker.recommend(session, month, recs);
+            appendJson(body, recs);
+        }
+        return 200;
+    }
+};
+
+#endif
+
+// Prints an import report: throughput and the first rejected rows.
+void printImportStats(const ImportStats& stats) {
+    cout << "rows accepted: " << stats.rowsAccepted << "\n"
+         << "rows rejected: " << stats.rowsRejected << "\n"
+         << "bytes:         " << stats.bytes << "\n"
+         << "seconds:       " << fixed << setprecision(3) << stats.seconds << "\n"
+         << "rows/sec:      " << fixed << setprecision(0) << stats.rowsPerSecond() << "\n"
+         << "MB/sec:        " << fixed << setprecision(1)
+         << (stats.seconds > 0 ? stats.bytes / 1e6 / stats.seconds : 0) << "\n";
+    for (size_t i = 0; i < stats.diagnostics.size() && i < 10; i++)
+        cout << "  line " << stats.diagnostics[i].line << ": " << stats.diagnostics[i].reason << "\n";
+    if (!stats.ok) cout << "❌ import failed\n";
+}
+
+// Prints the month's org-wide figures and the category totals for it.
+void printOrgReport(const OrgReport& report) {
+    const CategoryDictionary& dict = CategoryDictionary::instance();
+    Money zero(0, report.currency);
+    cout << "Org report for " << report.monthKey / 100 << "-" << setw(2) << setfill('0')
+         << report.monthKey % 100 << setfill(' ') << " (" << zero.currencyName() << ", "
+         << report.users << " users)\n"
+         << "  Total Income:  " << Money(report.income, report.currency).toString() << "\n"
+         << "  Total Expense: " << Money(report.expense, report.currency).toString() << "\n";
+    auto month = report.expenseByMonth.find(report.monthKey);
+    if (month != report.expenseByMonth.end()) {
+        for (uint32_t id : dict.sortedByName(month->second))
+            cout << "  " << setw(12) << dict.name(id) << ": "
+                 << Money(month->second[id], report.currency).toString() << "\n";
+    }
+    cout << "  Savings rate:  <0%: " << report.savingsRateBuckets[0];
+    for (int k = 0; k < 10; k++)
+        cout << ", " << k * 10 << "%+: " << report.savingsRateBuckets[1 + k];
+    cout << ", no income: " << report.usersWithoutIncome << "\n";
+    for (auto& o : report.topOverspenders)
+        cout << "  overspent " << setw(12) << Money(o.overspend, report.currency).toString()
+             << "  " << o.username << "\n";
+}
+
+// --batch <data-dir> <out-dir> [threads]
+int runBatch(const string& dir, const string& out, size_t threads) {
+    FinanceTracker tracker;
+    if (!tracker.openStorage(dir)) {
+        cerr << "cannot open storage in " << dir << "\n";
+        return 1;
+    }
+    HTMLGUIGenerator generator(tracker);
+    BatchStats stats = generator.writeAccountPages(out, threads);
+    cout << "pages:         " << stats.pages << "\n"
+         << "bytes:         " << stats.bytes << "\n"
+         << "seconds:       " << fixed << setprecision(3) << stats.seconds << "\n"
+         << "pages/sec:     " << fixed << setprecision(0) << stats.pagesPerSecond() << "\n"
+         << "MB/sec:        " << fixed << setprecision(1)
+         << (stats.seconds > 0 ? stats.bytes / 1e6 / stats.seconds : 0) << "\n";
+    if (!stats.ok) cout << "❌ some pages could not be written\n";
+    return stats.ok ? 0 : 1;
+}
+
+// --serve [port] [data-dir]
+int runServe(uint16_t port, const string& dir) {
+#ifdef PFT_HTTP_SERVER
+    FinanceTracker tracker;
+    if (!dir.empty() && !tracker.openStorage(dir)) {
+        cerr << "cannot open storage in " << dir << "\n";
+        return 1;
+    }
+    HttpServer server(tracker);
+    if (!server.listen(port)) {
+        cerr << "cannot listen on 127.0.0.1:" << port << "\n";
+        return 1;
+    }
+    cout << "serving http://127.0.0.1:" << server.port() << "/ (Ctrl-C to stop)" << endl;
+    server.run();
+    return 0;
+#else
+    (void)port;
+    (void)dir;
+    cerr << "--serve needs epoll (Linux)\n";
+    return 1;
+#endif
+}
+
+// --import <data-dir> <user> <password> <file.csv>
+int runImport(const string& dir, const string& user, const string& password, const string& csv) {
+    FinanceTracker tracker;
+    if (!tracker.openStorage(dir)) {
+        cerr << "cannot open storage in " << dir << "\n";
+        return 1;
+    }
+    tracker.registerUser(user, password);
+    SessionId session = tracker.loginUser(user, password);
+    if (!session) {
+        cerr << "login failed for " << user << "\n";
+        return 1;
+    }
+    ImportStats stats = tracker.importCsv(session, csv);
+    printImportStats(stats);
+    return stats.ok ? 0 : 1;
+}
+
+// --selfcheck: every SIMD aggregation kernel against the scalar one on
+// random columns, ragged ranges and month filters, then kernel throughput.
+int runSelfCheck() {
+    const size_t rows = 1000003;
+    const uint32_t categoryCount = 40;
+    mt19937_64 rng(7);
+    vector<int32_t> monthKeys(rows);
+    vector<int64_t> amounts(rows);
+    vector<uint32_t> categories(rows);
+    vector<uint64_t> incomeBits((rows + 63) / 64, 0);
+    int32_t base = daysFromCivil(2022, 1, 1);
+    for (size_t i = 0; i < rows; i++) {
+        int64_t cents = (int64_t)(rng() % 2000000) - 100000;
+        if (rng() % 1000 == 0) cents = (int64_t)(rng() >> 12) * (rng() & 1 ? 1 : -1);
+        monthKeys[i] = monthKeyOfDay(base + (int32_t)(rng() % 730));
+        amounts[i] = cents;
+        categories[i] = (uint32_t)(rng() % categoryCount);
+        if (rng() % 4 == 0) incomeBits[i >> 6] |= uint64_t(1) << (i & 63);
+    }
+    RowColumns cols{monthKeys.data(), amounts.data(), categories.data(), incomeBits.data()};
+    const auto& kernels = availableSumKernels();
+    SumKernel reference = kernels.back().second;
+
+    size_t failures = 0, cases = 0;
+    for (size_t t = 0; t < 2000; t++) {
+        size_t begin = rng() % rows, end = begin + rng() % min<size_t>(rows - begin + 1, 5000);
+        if (t % 10 == 0) begin = 0, end = rows;
+        int32_t key = t % 3 == 0 ? -1 : t % 3 == 1 ? monthKeys[rng() % rows] : 190001;
+        bool histogram = t % 2 == 0;
+
+        MonthSums want;
+        vector<int64_t> wantCells(categoryCount, 0);
+        reference(cols, begin, end, key, want, histogram ? wantCells.data() : nullptr);
+        for (auto& k : kernels) {
+            MonthSums got;
+            vector<int64_t> gotCells(categoryCount, 0);
+            k.second(cols, begin, end, key, got, histogram ? gotCells.data() : nullptr);
+            cases++;
+            if (got.income != want.income || got.expense != want.expense || gotCells != wantCells) {
+                if (failures++ < 10)
+                    cout << "❌ " << k.first << " rows [" << begin << ", " << end << ") month "
+                         << key << ": " << got.income << "/" << got.expense << " vs "
+                         << want.income << "/" << want.expense << "\n";
+            }
+        }
+    }
+    cout << "aggregation kernels: " << cases - failures << "/" << cases << " cases match scalar\n";
+
+    cout << "kernel      filter     GB/s\n";
+    int32_t key = monthKeys[0];
+    double bytes = rows * (sizeof(int32_t) + sizeof(int64_t)) + rows / 8.0;
+    for (auto& k : kernels) {
+        for (int filtered = 0; filtered < 2; filtered++) {
+            const int reps = 20;
+            MonthSums sums;
+            auto start = chrono::steady_clock::now();
+            for (int r = 0; r < reps; r++)
+                k.second(cols, 0, rows, filtered ? key : -1, sums, nullptr);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << setw(8) << k.first << "  " << setw(8) << (filtered ? "month" : "none") << "  "
+                 << setw(7) << fixed << setprecision(2) << bytes * reps / seconds / 1e9 << "\n";
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// ==================== BENCHMARKS ====================
+
+// Login latency as the directory grows from 1 to 1M users.
+void runLoginBenchmark() {
+    cout << "users        ns/login\n";
+    mt19937_64 rng(42);
+    for (size_t n = 1; n <= 1000000; n *= 10) {
+        FinanceTracker tracker;
+        tracker.setPasswordIterations(1);      // the directory, not key stretching
+        vector<pair<string, string>> accounts;
+        accounts.reserve(n);
+        for (size_t i = 0; i < n; i++)
+            accounts.push_back({"user" + to_string(i), "pw" + to_string(i)});
+        tracker.registerUsers(accounts);
+
+        const size_t logins = 200000;
+        vector<size_t> picks(logins);
+        for (auto& p : picks) p = rng() % n;
+
+        size_t ok = 0;
+        auto start = chrono::steady_clock::now();
+        for (size_t p : picks)
+            ok += bool(tracker.loginUser(accounts[p].first, accounts[p].second));
+        auto elapsed = chrono::steady_clock::now() - start;
+
+        double ns = chrono::duration<double, nano>(elapsed).count() / logins;
+        cout << setw(8) << n << "  " << setw(12) << fixed << setprecision(1) << ns
+             << (ok == logins ? "" : "  (login failures!)") << "\n";
+    }
+}
+
+// Restart time: snapshot of `rows` transactions plus a WAL tail.
+void runRestartBenchmark(size_t rows) {
+    string dir = (filesystem::temp_directory_path() / "pft_restart_bench").string();
+    string crashDir = dir + "_crash";
+    filesystem::remove_all(dir);
+    filesystem::remove_all(crashDir);
+    const size_t userCount = 1000, tail = 10000, late = 50;
+    const char* categories[] = {"Food", "Rent", "Travel", "Salary", "Utilities", "Fun"};
+    auto listing = [](FinanceTracker& tracker) {
+        string out;
+        SessionId session = tracker.loginUser("user0", "pw");
+        vector<TransactionRow> list;
+        tracker.listTransactions(session, list);
+        for (const TransactionRow& row : list) appendJson(out, row);
+        return out;
+    };
+    string walName, expected;
+    {
+        FinanceTracker tracker;
+        tracker.setPasswordIterations(1);
+        tracker.openStorage(dir, UINT64_MAX);
+        vector<pair<string, string>> accounts;
+        for (size_t i = 0; i < userCount; i++) accounts.push_back({"user" + to_string(i), "pw"});
+        tracker.registerUsers(accounts);
+
+        vector<User*> users;
+        for (auto& a : accounts) users.push_back(tracker.findUser(a.first));
+        vector<uint32_t> ids;
+        for (auto c : categories) ids.push_back(CategoryDictionary::instance().intern(c));
+        int32_t base = daysFromCivil(2015, 1, 1);
+        for (size_t i = 0; i < rows; i++) {
+            users[i % userCount]->appendRow(base + (int32_t)(i / userCount % 3650),
+                                            (int64_t)(i % 50000), ids[i % ids.size()],
+                                            "txn", i % ids.size() == 3);
+        }
+        auto start = chrono::steady_clock::now();
+        tracker.checkpoint();
+        cout << "checkpoint of " << rows << " rows: "
+             << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s\n";
+
+        SessionId session = tracker.loginUser("user0", "pw");
+        for (size_t i = 0; i < tail; i++)
+            tracker.addTransaction(session, "2025-01-15", 12.5, "Food", "tail", "Expense");
+
+        // Back-dated rows, so sealing user0's history renumbers the open
+        // rows after them; then a delete and an edit by the new numbers.
+        // Hard links keep the pre-seal snapshot and WAL the way a crash
+        // between the WAL rotation and the snapshot rename leaves them.
+        for (size_t i = 0; i < late; i++)
+            tracker.addTransaction(session, "2016-06-15", 5.0, "Fun", "late " + to_string(i), "Expense");
+        for (auto& entry : filesystem::directory_iterator(dir))
+            if (entry.path().filename().string().rfind("wal-", 0) == 0) walName = entry.path().filename().string();
+        filesystem::create_hard_link(dir + "/snapshot.bin", dir + "/crash-snapshot");
+        filesystem::create_hard_link(dir + "/" + walName, dir + "/crash-wal");
+        tracker.sealHistory("user0", "2020-01", dir + "/user0-sealed.bin");
+        vector<TransactionRow> list;
+        tracker.listTransactions(session, list);
+        size_t open = 0;
+        while (open < list.size() && list[open].day < daysFromCivil(2020, 1, 1)) open++;
+        if (open + 200 < list.size()) {
+            tracker.deleteTransaction(session, list[open + 100].row);
+            tracker.editTransaction(session, list[open + 200].row, "2025-01-16",
+                                    Money::fromMajor(99.0, Money::kUSD), "Rent", "edited", "Expense");
+        }
+        expected = listing(tracker);
+    }
+
+    bool ok;
+    {
+        auto start = chrono::steady_clock::now();
+        FinanceTracker restarted;
+        ok = restarted.openStorage(dir);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        size_t loaded = 0;
+        for (auto& name : restarted.getAllUsernames())
+            loaded += restarted.findUser(name)->getTransactionCount();
+        ok = ok && loaded == rows + tail + late - 1 && listing(restarted) == expected &&
+             restarted.findUser("user0")->verifySealed().empty();
+        cout << "restart: " << seconds << " s, " << loaded << " rows" << (ok ? "" : "  (MISMATCH!)")
+             << "\n";
+    }
+
+    // The crash: the old snapshot and its WAL, the new WAL and the sealed file.
+    filesystem::create_directories(crashDir);
+    filesystem::copy_file(dir + "/crash-snapshot", crashDir + "/snapshot.bin");
+    filesystem::copy_file(dir + "/crash-wal", crashDir + "/" + walName);
+    for (auto& entry : filesystem::directory_iterator(dir)) {
+        string name = entry.path().filename().string();
+        if (name.rfind("wal-", 0) == 0) filesystem::copy_file(entry.path(), crashDir + "/" + name);
+    }
+    {
+        FinanceTracker recovered;
+        bool same = recovered.openStorage(crashDir) && listing(recovered) == expected;
+        cout << "crash before snapshot rename: " << (same ? "recovered" : "MISMATCH!") << "\n";
+    }
+    filesystem::remove_all(dir);
+    filesystem::remove_all(crashDir);
+}
+
+// Org-wide report scaling from 1 thread to one per core. Row counts are
+// skewed (a few users hold most rows) and history before 2024 is sealed,
+// so work stealing has uneven tasks to balance.
+void runOrgBenchmark(size_t userCount, size_t rows) {
+    string dir = (filesystem::temp_directory_path() / "pft_org_bench").string();
+    filesystem::remove_all(dir);
+    filesystem::create_directories(dir);
+    const char* categories[] = {"Food", "Rent", "Travel", "Salary", "Utilities", "Fun"};
+    FinanceTracker tracker;
+    tracker.setPasswordIterations(1);
+    vector<pair<string, string>> accounts;
+    for (size_t i = 0; i < userCount; i++) accounts.push_back({"user" + to_string(i), "pw"});
+    tracker.registerUsers(accounts);
+    vector<User*> users;
+    for (auto& a : accounts) users.push_back(tracker.findUser(a.first));
+    vector<uint32_t> ids;
+    for (auto c : categories) ids.push_back(CategoryDictionary::instance().intern(c));
+
+    mt19937_64 rng(11);
+    int32_t base = daysFromCivil(2019, 1, 1);
+    for (size_t i = 0; i < rows; i++) {
+        // Squaring a uniform draw puts most rows on low user indices.
+        double u = (rng() >> 11) * (1.0 / 9007199254740992.0);
+        size_t user = min(userCount - 1, (size_t)(u * u * userCount));
+        uint32_t category = ids[rng() % ids.size()];
+        users[user]->appendRow(base + (int32_t)(rng() % 2190), (int64_t)(rng() % 50000),
+                               category, "txn", category == ids[3]);
+    }
+    for (size_t i = 0; i < userCount; i++)
+        tracker.sealHistory(accounts[i].first, "2024-01", dir + "/user" + to_string(i) + ".sealed");
+
+    OrgReport expected;
+    cout << "threads   seconds   speedup\n";
+    double single = 0;
+    vector<size_t> threadCounts;
+    size_t hardware = max(1u, thread::hardware_concurrency());
+    for (size_t t = 1; t < hardware; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(hardware);
+    for (size_t threads : threadCounts) {
+        tracker.setAnalyticsThreads(threads);
+        double best = 1e9;
+        OrgReport report;
+        for (int rep = 0; rep < 3; rep++) {
+            auto start = chrono::steady_clock::now();
+            report = tracker.buildOrgReport("2024-06");
+            best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        }
+        if (threads == 1) {
+            single = best;
+            expected = report;
+        }
+        bool same = report.expenseByMonth == expected.expenseByMonth &&
+                    report.income == expected.income && report.expense == expected.expense &&
+                    equal(begin(report.savingsRateBuckets), end(report.savingsRateBuckets),
+                          begin(expected.savingsRateBuckets));
+        cout << setw(7) << threads << "  " << setw(8) << fixed << setprecision(4) << best << "  "
+             << setw(8) << setprecision(2) << single / best << (same ? "" : "  (MISMATCH!)") << "\n";
+    }
+    printOrgReport(expected);
+    filesystem::remove_all(dir);
+}
+
+#ifdef PFT_HTTP_SERVER
+// Blocking loopback connection for --bench-serve: writes batches of
+// requests and reads the responses back one at a time.
+class HttpTestClient {
+    int fd = -1;
+    string buffer;
+public:
+    HttpTestClient() {}
+    HttpTestClient(const HttpTestClient&) = delete;
+    HttpTestClient& operator=(const HttpTestClient&) = delete;
+    ~HttpTestClient() {
+        if (fd >= 0) ::close(fd);
+    }
+
+    bool connect(uint16_t port) {
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+        return fd >= 0 && ::connect(fd, (sockaddr*)&addr, sizeof addr) == 0;
+    }
+
+    bool send(const string& requests) {
+        for (size_t done = 0; done < requests.size();) {
+            ssize_t n = ::send(fd, requests.data() + done, requests.size() - done, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            done += (size_t)n;
+        }
+        return true;
+    }
+
+    bool receive(int& status, string& body) {
+        for (;;) {
+            size_t end = buffer.find("\r\n\r\n");
+            size_t length = buffer.find("Content-Length: ");
+            if (end != string::npos && length != string::npos && buffer.size() > 12) {
+                size_t bodyBytes = strtoull(buffer.c_str() + length + 16, nullptr, 10);
+                if (buffer.size() >= end + 4 + bodyBytes) {
+                    status = atoi(buffer.c_str() + 9);
+                    body.assign(buffer, end + 4, bodyBytes);
+                    buffer.erase(0, end + 4 + bodyBytes);
+                    return true;
+                }
+            }
+            char chunk[64 << 10];
+            ssize_t n = ::recv(fd, chunk, sizeof chunk, 0);
+            if (n <= 0) return false;
+            buffer.append(chunk, (size_t)n);
+        }
+    }
+};
+
+static string httpRequest(const char* method, const string& target, const string& session,
+                          const string& body = "") {
+    string r = string(method) + " " + target + " HTTP/1.1\r\nHost: 127.0.0.1\r\n";
+    if (!session.empty()) r += "Authorization: Bearer " + session + "\r\n";
+    if (!body.empty()) r += "Content-Type: application/json\r\nContent-Length: " + to_string(body.size()) + "\r\n";
+    return r + "\r\n" + body;
+}
+
+// Requests/sec against an in-process server over loopback, one request at
+// a time and pipelined across connections; with a data dir every write
+// is logged and answered once durable.
+void benchServe(size_t requests, const string& dir) {
+    FinanceTracker tracker;
+    if (!dir.empty() && !tracker.openStorage(dir)) {
+        cerr << "cannot open storage in " << dir << "\n";
+        return;
+    }
+    HttpServer server(tracker);
+    if (!server.listen(0)) {
+        cerr << "cannot listen on loopback\n";
+        return;
+    }
+    thread loop([&] { server.run(); });
+
+    HttpTestClient setup;
+    int status = 0;
+    string body;
+    bool ok = setup.connect(server.port()) &&
+              setup.send(httpRequest("POST", "/api/register", "", "{\"username\":\"bench\",\"password\":\"pw\"}") +
+                         httpRequest("POST", "/api/login", "", "{\"username\":\"bench\",\"password\":\"pw\"}")) &&
+              setup.receive(status, body) && setup.receive(status, body) && status == 200;
+    size_t at = body.find("\"session\":\"");
+    string session = ok && at != string::npos ? body.substr(at + 11, 32) : "";
+
+    // Runs `count` copies of request over `connections` connections with
+    // `depth` requests in flight on each; returns requests/sec.
+    auto drive = [&](const string& request, size_t count, size_t connections, size_t depth) {
+        atomic<size_t> failures{0};
+        auto start = chrono::steady_clock::now();
+        vector<thread> clients;
+        for (size_t c = 0; c < connections; c++) {
+            clients.emplace_back([&, c] {
+                HttpTestClient client;
+                if (!client.connect(server.port())) {
+                    failures++;
+                    return;
+                }
+                size_t mine = count / connections + (c < count % connections);
+                string batch;
+                for (size_t k = 0; k < depth; k++) batch += request;
+                int code;
+                string reply;
+                for (size_t done = 0; done < mine;) {
+                    size_t n = min(depth, mine - done);
+                    if (!client.send(n == depth ? batch : batch.substr(0, request.size() * n))) {
+                        failures++;
+                        return;
+                    }
+                    for (size_t k = 0; k < n; k++)
+                        if (!client.receive(code, reply) || code != 200) failures++;
+                    done += n;
+                }
+            });
+        }
+        for (auto& t : clients) t.join();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (failures) cout << "  (" << failures << " failed requests!)\n";
+        return count / seconds;
+    };
+
+    if (ok) {
+        mt19937 rng(5);
+        const char* categories[] = {"Food", "Rent", "Travel", "Salary", "Utilities", "Fun"};
+        string adds;
+        for (int i = 0; i < 1000; i++) {
+            char json[160];
+            snprintf(json, sizeof json,
+                     "{\"date\":\"2024-%02d-%02d\",\"amount\":\"%u.%02u\",\"category\":\"%s\","
+                     "\"description\":\"bench\",\"type\":\"%s\"}",
+                     1 + i % 12, 1 + i % 28, (unsigned)(rng() % 5000), (unsigned)(rng() % 100),
+                     categories[i % 6], i % 6 == 3 ? "Income" : "Expense");
+            adds += httpRequest("POST", "/api/transactions", session, json);
+        }
+        auto start = chrono::steady_clock::now();
+        ok = setup.send(adds);
+        for (int i = 0; ok && i < 1000; i++) ok = setup.receive(status, body) && status == 200;
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "POST /api/transactions, pipelined:   " << fixed << setprecision(0) << 1000 / seconds
+             << " req/s\n";
+
+        string summary = httpRequest("GET", "/api/summary?month=2024-03", session);
+        string categoriesReq = httpRequest("GET", "/api/categories?month=2024-03", session);
+        cout << "GET summary, 1 conn, 1 in flight:    " << drive(summary, requests / 10, 1, 1) << " req/s\n";
+        cout << "GET summary, 4 conns, 1 in flight:   " << drive(summary, requests / 10, 4, 1) << " req/s\n";
+        cout << "GET summary, 4 conns, 32 pipelined:  " << drive(summary, requests, 4, 32) << " req/s\n";
+        cout << "GET categories, 4 conns, 32 pipelined: " << drive(categoriesReq, requests, 4, 32)
+             << " req/s\n";
+
+        string add = httpRequest("POST", "/api/transactions", session,
+                                 "{\"date\":\"2024-03-10\",\"amount\":\"12.50\",\"category\":\"Food\","
+                                 "\"description\":\"bench\",\"type\":\"Expense\"}");
+        cout << "POST, 4 conns, 1 in flight:          " << drive(add, requests / 100, 4, 1) << " req/s\n";
+        double writes = 0;
+        thread writer([&] { writes = drive(add, requests / 100, 4, 1); });
+        double reads = drive(summary, requests / 10, 1, 1);
+        writer.join();
+        cout << "GET summary, 1 conn, during POSTs:   " << reads << " req/s (POSTs: " << writes
+             << " req/s)\n";
+
+        // Logins hash the password (100,000 PBKDF2 rounds) on credential
+        // workers; reads must not queue behind them.
+        string login = httpRequest("POST", "/api/login", "", "{\"username\":\"bench\",\"password\":\"pw\"}");
+        double logins = 0;
+        thread loginClients([&] { logins = drive(login, 64, 8, 1); });
+        reads = drive(summary, requests / 10, 1, 1);
+        loginClients.join();
+        cout << "GET summary, 1 conn, during logins:  " << reads << " req/s (logins, 8 conns: "
+             << setprecision(1) << logins << setprecision(0) << " req/s)\n";
+    }
+    if (!ok) cerr << "server setup requests failed\n";
+    server.stop();
+    loop.join();
+}
+
+// --bench-serve [requests]: benchServe in memory, then with a data dir.
+void runServeBenchmark(size_t requests) {
+    cout << "in memory:\n";
+    benchServe(requests, "");
+    string dir = (filesystem::temp_directory_path() / "pft_serve_bench").string();
+    filesystem::remove_all(dir);
+    cout << "with a data dir (" << dir << "):\n";
+    benchServe(requests, dir);
+    filesystem::remove_all(dir);
+}
+#endif
+
+// --bench-forecast [users] [rows]: forecastAll over users with five years
+// of history, as of February 2025: the first run fits every model, the
+// second reuses them, and the third (as of March, after a row for every
+// user) folds in the month that closed.
+void runForecastBenchmark(size_t userCount, size_t rows) {
+    const char* categories[] = {"Food", "Rent", "Travel", "Salary", "Utilities", "Fun"};
+    FinanceTracker tracker;
+    tracker.setPasswordIterations(1);
+    vector<pair<string, string>> accounts;
+    for (size_t i = 0; i < userCount; i++) accounts.push_back({"user" + to_string(i), "pw"});
+    tracker.registerUsers(accounts);
+    vector<User*> users;
+    for (auto& a : accounts) users.push_back(tracker.findUser(a.first));
+    vector<uint32_t> ids;
+    for (auto c : categories) ids.push_back(CategoryDictionary::instance().intern(c));
+
+    mt19937_64 rng(23);
+    int32_t base = daysFromCivil(2020, 3, 1), span = daysFromCivil(2025, 3, 1) - base;
+    for (size_t i = 0; i < rows; i++) {
+        uint32_t category = ids[rng() % ids.size()];
+        users[i % userCount]->appendRow(base + (int32_t)(rng() % span), (int64_t)(rng() % 50000),
+                                        category, "txn", category == ids[3]);
+    }
+
+    auto timed = [&](const char* label, const string& asOf) {
+        auto start = chrono::steady_clock::now();
+        vector<AccountForecast> results = tracker.forecastAll(asOf);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << setw(28) << left << label << right << fixed << setprecision(3) << seconds << " s  ("
+             << setprecision(0) << results.size() / seconds << " users/s)\n";
+        return results;
+    };
+    cout << "users: " << userCount << ", rows: " << rows << ", threads: "
+         << thread::hardware_concurrency() << "\n";
+    timed("first run (fit):", "2025-02-10");
+    timed("cached models:", "2025-02-20");
+    for (size_t i = 0; i < userCount; i++) {
+        uint32_t category = ids[rng() % ids.size()];
+        users[i]->appendRow(daysFromCivil(2025, 3, 2), (int64_t)(rng() % 50000), category, "txn",
+                            category == ids[3]);
+    }
+    vector<AccountForecast> results = timed("next month (one fold):", "2025-03-05");
+    cout << renderForecast(results[0].forecast);
+}
+
+// One writer importing batches, appending, editing, deleting and undoing
+// while `readers` threads query the same user's read views. Each reader
+// checks that every view it gets agrees with itself (listed rows against
+// the month totals) and is never older than the last one it saw. Build
+// with -fsanitize=thread to run it under ThreadSanitizer.
+int runStress(double seconds, size_t readers) {
+    const char* categories[] = {"Food", "Rent", "Travel", "Salary", "Utilities", "Fun"};
+    FinanceTracker tracker;
+    tracker.setPasswordIterations(1);
+    tracker.registerUser("stress", "pw");
+    User* user = tracker.findUser("stress");
+    vector<uint32_t> ids;
+    for (auto c : categories) ids.push_back(CategoryDictionary::instance().intern(c));
+    int32_t base = daysFromCivil(2024, 1, 1), span = 366;
+
+    atomic<bool> stop(false), failed(false);
+    atomic<uint64_t> writes(0);
+    thread writer([&] {
+        mt19937_64 rng(25);
+        while (!stop.load(memory_order_relaxed)) {
+            uint64_t n = writes.load(memory_order_relaxed);
+            uint32_t category = ids[rng() % ids.size()];
+            int32_t day = base + (int32_t)(rng() % span);
+            int64_t cents = (int64_t)(rng() % 50000);
+            bool income = category == ids[3];
+            if (n % 64 == 0) {
+                ImportBatch batch;
+                for (int i = 0; i < 256; i++) {
+                    uint32_t c = ids[rng() % ids.size()];
+                    batch.add(base + (int32_t)(rng() % span), (int64_t)(rng() % 50000), c,
+                              c == ids[3], "batch row", 9);
+                }
+                user->appendBatch(batch);
+            } else if (n % 16 == 1) {
+                size_t rows = user->getTransactionCount();
+                if (rows) user->deleteRow(rng() % rows, [] {});
+            } else if (n % 16 == 2) {
+                size_t rows = user->getTransactionCount();
+                if (rows) user->editRow(rng() % rows, day, cents, category, "edited", income, [] {});
+            } else if (n % 16 == 3) {
+                user->undo([](uint64_t, uint64_t) {});
+            } else {
+                user->appendRow(day, cents, category, "card payment", income);
+            }
+            writes.fetch_add(1, memory_order_relaxed);
+        }
+    });
+
+    vector<uint64_t> reads(readers, 0);
+    vector<double> worst(readers, 0);
+    vector<thread> pool;
+    AdviceProgram program;
+    for (size_t r = 0; r < readers; r++) {
+        pool.emplace_back([&, r] {
+            uint64_t lastWrites = 0;
+            vector<TransactionRow> rows;
+            vector<Recommendations> advice;
+            while (!stop.load(memory_order_relaxed)) {
+                auto start = chrono::steady_clock::now();
+                shared_ptr<const LedgerVersion> v = user->view();
+                if (v->writes < lastWrites) failed = true;
+                lastWrites = v->writes;
+                if (reads[r] % 32 == 0) {
+                    // Full check: the listing must add up to the month totals.
+                    rows.clear();
+                    v->listRows(*v->log, rows);
+                    if (rows.size() != v->transactionCount()) failed = true;
+                    map<int32_t, pair<int64_t, int64_t>> byMonth;
+                    for (const TransactionRow& row : rows) {
+                        pair<int64_t, int64_t>& m = byMonth[monthKeyOfDay(row.day)];
+                        (row.income ? m.first : m.second) += row.amount.minorUnits();
+                    }
+                    for (int32_t key : v->monthKeys()) {
+                        MonthSummary s = v->summarizeMonth(key);
+                        pair<int64_t, int64_t> m = byMonth[key];
+                        if (s.income.minorUnits() != m.first || s.expense.minorUnits() != m.second)
+                            failed = true;
+                    }
+                    // ...and so must the rows in a day range.
+                    int32_t from = base + (int32_t)(reads[r] / 32 % span), to = from + 45;
+                    DayTotals expected;
+                    for (const TransactionRow& row : rows) {
+                        if (row.day >= from && row.day <= to)
+                            (row.income ? expected.income : expected.expense) += row.amount.minorUnits();
+                    }
+                    DayTotals range = v->sumRange(from, to);
+                    if (range.income != expected.income || range.expense != expected.expense) failed = true;
+                } else {
+                    // The other lock-free queries, in turn.
+                    int32_t day = base + (int32_t)(reads[r] % span);
+                    int64_t income, expense;
+                    PageRequest page;
+                    PageResult result;
+                    switch (reads[r] % 8) {
+                    case 0: user->getRangeTotals(day, day + 30, income, expense); break;
+                    case 1: user->spendingAlerts(); break;
+                    case 2: user->forecast(day); break;
+                    case 3: user->recommend(monthKeyOfDay(day), program); break;
+                    case 4:
+                        advice.clear();
+                        user->refreshAdvice(program, advice);
+                        break;
+                    case 5:
+                        rows.clear();
+                        page.offset = (size_t)(reads[r] % 1000);
+                        page.order = reads[r] % 16 < 8 ? RowOrder::Date : RowOrder::Amount;
+                        user->pageRows(page, rows, result);
+                        // Nothing written meanwhile: the page counted v's rows.
+                        if (user->view()->writes == v->writes && result.total != v->transactionCount())
+                            failed = true;
+                        break;
+                    case 6: user->currentVersion(); break;
+                    default: v->categoryBreakdown(monthKeyOfDay(day)); break;
+                    }
+                    user->getTransactionCount();
+                }
+                worst[r] = max(worst[r], chrono::duration<double>(chrono::steady_clock::now() - start).count());
+                reads[r]++;
+            }
+        });
+    }
+
+    this_thread::sleep_for(chrono::duration<double>(seconds));
+    stop = true;
+    writer.join();
+    for (thread& t : pool) t.join();
+
+    uint64_t totalReads = 0;
+    double maxLatency = 0;
+    for (size_t r = 0; r < readers; r++) {
+        totalReads += reads[r];
+        maxLatency = max(maxLatency, worst[r]);
+    }
+    cout << "readers: " << readers << ", rows at end: " << user->getTransactionCount() << "\n"
+         << "writes/s: " << fixed << setprecision(0) << writes.load() / seconds
+         << ", reads/s: " << totalReads / seconds << ", max read latency: " << setprecision(3)
+         << maxLatency * 1e3 << " ms\n";
+    vector<string> drift = user->verifyRollup();
+    if (!drift.empty()) failed = true;
+    cout << (failed ? "FAIL\n" : "OK\n");
+    return failed ? 1 : 0;
+}
+
+// Bulk import throughput on a synthetic bank export.
+void runImportBenchmark(size_t rows) {
+    string path = (filesystem::temp_directory_path() / "pft_import_bench.csv").string();
+    {
+        const char* categories[] = {"Food", "Rent", "Travel", "Salary", "Utilities", "Fun"};
+        string out = "date,amount,category,description,type\n";
+        FILE* f = fopen(path.c_str(), "wb");
+        char line[128];
+        for (size_t i = 0; i < rows; i++) {
+            int n = snprintf(line, sizeof line, "20%02d-%02d-%02d,%zu.%02zu,%s,card payment %zu,%s\n",
+                             (int)(15 + i % 10), (int)(1 + i % 12), (int)(1 + i % 28), i % 5000,
+                             i % 100, categories[i % 6], i % 1000, i % 6 == 3 ? "Income" : "Expense");
+            out.append(line, n);
+            if (out.size() > (1 << 20)) {
+                fwrite(out.data(), 1, out.size(), f);
+                out.clear();
+            }
+        }
+        fwrite(out.data(), 1, out.size(), f);
+        fclose(f);
+    }
+
+    // Same file with the Spending Monitor off and on, alternating; the best
+    // of three runs each is compared.
+    double best[2] = {0, 0};
+    for (int run = 0; run < 6; run++) {
+        int monitored = run % 2;
+        SpendingMonitor::options().enabled = monitored != 0;
+        FinanceTracker tracker;
+        tracker.setPasswordIterations(1);
+        tracker.registerUser("bench", "pw");
+        SessionId session = tracker.loginUser("bench", "pw");
+        ImportStats stats = tracker.importCsv(session, path);
+        best[monitored] = max(best[monitored], stats.rowsPerSecond());
+        if (run >= 4) {
+            cout << (monitored ? "--- spending monitor on ---\n" : "--- spending monitor off ---\n");
+            printImportStats(stats);
+        }
+        if (run == 5) {
+            vector<SpendingAlert> alerts;
+            tracker.spendingAlerts(session, alerts);
+            cout << "alerts held:   " << alerts.size() << "\n";
+        }
+    }
+    SpendingMonitor::options().enabled = true;
+    if (best[1] > 0)
+        cout << "monitor overhead (best of 3): " << fixed << setprecision(1)
+             << (best[0] / best[1] - 1) * 100 << "%\n";
+    filesystem::remove(path);
+}
+
+// ==================== MAIN FUNCTION ====================
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--bench-login") {
+        runLoginBenchmark();
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "--serve") {
+        return runServe(argc > 2 ? (uint16_t)stoul(argv[2]) : 8080, argc > 3 ? argv[3] : "");
+    }
+#ifdef PFT_HTTP_SERVER
+    if (argc > 1 && string(argv[1]) == "--bench-serve") {
+        runServeBenchmark(argc > 2 ? stoul(argv[2]) : 200000);
+        return 0;
+    }
+#endif
+    if (argc > 3 && string(argv[1]) == "--batch") {
+        return runBatch(argv[2], argv[3], argc > 4 ? stoul(argv[4]) : thread::hardware_concurrency());
+    }
+    if (argc > 5 && string(argv[1]) == "--import") {
+        return runImport(argv[2], argv[3], argv[4], argv[5]);
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-import") {
+        runImportBenchmark(argc > 2 ? stoul(argv[2]) : 10000000);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-org") {
+        runOrgBenchmark(argc > 2 ? stoul(argv[2]) : 10000, argc > 3 ? stoul(argv[3]) : 10000000);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-forecast") {
+        runForecastBenchmark(argc > 2 ? stoul(argv[2]) : 100000, argc > 3 ? stoul(argv[3]) : 6000000);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "--stress") {
+        return runStress(argc > 2 ? stod(argv[2]) : 5, argc > 3 ? stoul(argv[3]) : 4);
+    }
+    if (argc > 1 && string(argv[1]) == "--selfcheck") {
+        return runSelfCheck();
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-restart") {
+        runRestartBenchmark(argc > 2 ? stoul(argv[2]) : 10000000);
+        return 0;
+    }
+
+    cout << "=============================================================\n";
+    cout << "    🚀 AI-Powered Finance Tracker - OOP Assignment  🚀\n";
+    cout << "=============================================================\n\n";
+
+    FinanceTracker tracker;
+    HTMLGUIGenerator guiGen(tracker);
+    guiGen.generateHTML();
+
+    cout << "\n🎯 OOP FEATURES DEMONSTRATED:\n";
+    cout << "   ✓ Inheritance: Transaction → Income/Expense\n";
+    cout << "   ✓ Encapsulation: Private user data with public interfaces\n";
+    cout << "   ✓ Polymorphism: Virtual getType() method\n";
+    cout << "   ✓ Abstraction: Simple public methods hiding complex logic\n\n";
+
+    cout << "🚀 ADVANCED FEATURES:\n";
+    cout << "   ✓ AI-Powered financial recommendations\n";
+    cout << "   ✓ Real-time analytics and insights\n";
+    cout << "   ✓ Interactive HTML5 interface\n";
+    cout << "   ✓ Secure user authentication\n";
+    cout << "   ✓ Category-based spending analysis\n\n";
+
+    cout << "🌐 LAUNCHING WEB INTERFACE...\n";
+
+    // Open the HTML file in default browser
+#ifdef _WIN32
+    system("start finance_tracker.html");
+#elif __APPLE__
+    system("open finance_tracker.html");
+#else
+    system("xdg-open finance_tracker.html");
+#endif
+
+    cout << "\n✨ FINANCE TRACKER READY!\n";
+    cout << "📁 Interface: finance_tracker.html\n";
+    cout << "\n💡 Assignment Features:\n";
+    cout << "   • Complete OOP implementation\n";
+    cout << "   • Inheritance hierarchy\n";
+    cout << "   • Polymorphic behavior\n";
+    cout << "   • Encapsulated data\n";
+    cout << "   • Abstract base class\n";
+    cout << "   • AI-based business logic\n\n";
+
+    cout << "Press Enter to exit...\n";
+    cin.get();
+
+    return 0;
+}